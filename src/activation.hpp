@@ -0,0 +1,77 @@
+#ifndef ACTIVATION_HPP
+#define ACTIVATION_HPP
+
+#include <vmath.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+enum class Activation { IDENTITY, RELU, SIGMOID, TANH, GELU, SILU };
+
+inline const char* activation_name(Activation a) {
+    switch (a) {
+    case Activation::IDENTITY: return "identity";
+    case Activation::RELU:     return "relu";
+    case Activation::SIGMOID:  return "sigmoid";
+    case Activation::TANH:     return "tanh";
+    case Activation::GELU:     return "gelu";
+    case Activation::SILU:     return "silu";
+    }
+    return "?";
+}
+
+template<typename T>
+inline T activate(T x, Activation act) {
+    switch (act) {
+    case Activation::IDENTITY: return x;
+    case Activation::RELU:     return x > (T)0 ? x : (T)0;
+    case Activation::SIGMOID:  return (T)((T)1 / ((T)1 + std::exp(-x)));
+    case Activation::TANH:     return (T)std::tanh(x);
+    case Activation::GELU:     return (T)((T)0.5 * x * ((T)1 + std::erf(x * (T)0.70710678118654752)));
+    case Activation::SILU:     return (T)(x / ((T)1 + std::exp(-x)));
+    }
+    return x;
+}
+
+template<MathAccuracy A>
+void activate_vec(float* x, size_t n, Activation act) {
+    switch (act) {
+    case Activation::SIGMOID: vsigmoid<A>(x, x, n); return;
+    case Activation::TANH:    vtanh<A>(x, x, n);    return;
+    case Activation::GELU:    vgelu<A>(x, x, n);    return;
+    case Activation::SILU:    vsilu<A>(x, x, n);    return;
+    default:                  return;
+    }
+}
+
+template<typename T>
+void activate_inplace(T* x, size_t n, Activation act, MathAccuracy acc = MathAccuracy::PRECISE) {
+    /**
+     * @brief Apply an activation to n contiguous values
+     *
+     * The switch is hoisted out of the loop so each case is a plain loop the
+     * compiler can vectorize. For float the transcendental activations run on
+     * the vmath.hpp kernels at the requested accuracy instead of libm.
+    */
+    if constexpr (std::is_same_v<T, float>) {
+        if (act != Activation::IDENTITY && act != Activation::RELU) {
+            if (acc == MathAccuracy::FAST) activate_vec<MathAccuracy::FAST>(x, n, act);
+            else activate_vec<MathAccuracy::PRECISE>(x, n, act);
+            return;
+        }
+    }
+
+    switch (act) {
+    case Activation::IDENTITY:
+        return;
+    case Activation::RELU:
+        for (size_t i = 0; i < n; ++i) x[i] = x[i] > (T)0 ? x[i] : (T)0;
+        return;
+    default:
+        for (size_t i = 0; i < n; ++i) x[i] = activate(x[i], act);
+        return;
+    }
+}
+
+#endif // ACTIVATION_HPP
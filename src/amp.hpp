@@ -0,0 +1,160 @@
+#ifndef AMP_HPP
+#define AMP_HPP
+
+#include <autograd.hpp>
+#include <half.hpp>
+#include <optim.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+/*
+ * Mixed-precision training: weights and activations live in a 16-bit type P
+ * (NTensor<bf16> / NTensor<fp16>, Tape<P>), matmuls accumulate in fp32, and
+ * the optimizer keeps fp32 master weights (Optimizer<P, float>). A step is
+ *
+ *     tape.backward(loss, (P)scaler.scale());    // scaled seed keeps small grads representable
+ *     amp_step(opt, tape, scaler);               // check + unscale + update, or skip
+ *
+ * Conversions ride on passes that already happen: the gradient check is the
+ * norm reduction, unscaling is the optimizer's grad_scale, and the P weights
+ * are rewritten from the master copy inside the update kernel.
+ */
+typedef struct LossScaleConfig {
+    double init_scale = 32768.0;    // largest power of two below the fp16 max (65504)
+    double growth_factor = 2.0;
+    double backoff_factor = 0.5;
+    size_t growth_interval = 2000;  // finite steps in a row before the scale grows
+    double min_scale = 1.0;
+    double max_scale = 16777216.0;
+} LossScaleConfig;
+
+typedef struct GradStats {
+    bool finite = true;
+    double sum_sq = 0.0;            // of the unscaled gradients, across all parameters
+
+    double norm() const { return std::sqrt(sum_sq); }
+} GradStats;
+
+class DynamicLossScaler {
+public:
+    explicit DynamicLossScaler(LossScaleConfig cfg = {})
+        : cfg_(cfg), scale_(cfg.init_scale)
+    {
+        /**
+         * @brief Loss scale that halves on overflow and doubles after a run of clean steps
+        */
+    }
+
+    double scale() const { return scale_; }
+
+    bool update(bool finite) {
+        /**
+         * @brief Feed back whether this step's gradients were finite
+         *
+         * @return (bool) true if the step should be applied
+        */
+        if (!finite) {
+            scale_ = std::max(cfg_.min_scale, scale_ * cfg_.backoff_factor);
+            good_steps_ = 0;
+            ++skipped_;
+            return false;
+        }
+
+        if (++good_steps_ >= cfg_.growth_interval) {
+            scale_ = std::min(cfg_.max_scale, scale_ * cfg_.growth_factor);
+            good_steps_ = 0;
+        }
+        return true;
+    }
+
+    size_t skipped() const { return skipped_; }
+
+private:
+    LossScaleConfig cfg_;
+    double scale_;
+    size_t good_steps_ = 0;
+    size_t skipped_ = 0;
+};
+
+template<typename G>
+GradStats grad_stats(const std::vector<const G*>& grads, const std::vector<size_t>& sizes,
+                     double inv_scale, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Sum of squares of the unscaled gradients, and whether all are finite, in one read
+     *
+     * Overflow detection is folded into the norm reduction: any inf/NaN
+     * makes its square (and so the sum) non-finite. Run it after the
+     * data-parallel all_reduce; a non-finite gradient on one rank reaches
+     * every rank through the SUM, so all ranks skip the same steps.
+     *
+     * @param (std::vector<const G*>) grads: nullptr entries are skipped
+     * @param (double) inv_scale: 1 / loss scale
+    */
+    struct Chunk { size_t param, lo, hi; };
+    std::vector<Chunk> chunks;
+    for (size_t p = 0; p < grads.size(); ++p) {
+        if (!grads[p]) continue;
+        for (size_t lo = 0; lo < sizes[p]; lo += OPTIM_CHUNK) {
+            chunks.push_back(Chunk{p, lo, std::min(lo + OPTIM_CHUNK, sizes[p])});
+        }
+    }
+
+    std::mutex mutex;
+    double total = 0.0;
+
+    auto body = [&](size_t lo, size_t hi) {
+        double local = 0.0;
+        for (size_t c = lo; c < hi; ++c) {
+            const G* g = grads[chunks[c].param];
+            for (size_t i = chunks[c].lo; i < chunks[c].hi; ++i) {
+                double x = (double)(float)g[i];
+                local += x * x;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        total += local;
+    };
+
+    if (pool) pool->parallel_for(0, chunks.size(), 1, body);
+    else body(0, chunks.size());
+
+    GradStats s;
+    s.sum_sq = total * inv_scale * inv_scale;
+    s.finite = std::isfinite(s.sum_sq);
+    return s;
+}
+
+template<typename P, typename M>
+bool amp_step(Optimizer<P, M>& opt, Tape<P>& tape, DynamicLossScaler& scaler,
+              double clip_norm = 0.0, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Unscale, check, optionally clip, and apply one optimizer step
+     *
+     * @param (double) clip_norm: rescale gradients whose global norm exceeds this (0 = off)
+     *
+     * @return (bool) false if the step was skipped because of inf/NaN gradients
+    */
+    std::vector<const P*> grads(opt.size());
+    std::vector<size_t> sizes(opt.size());
+    for (size_t i = 0; i < opt.size(); ++i) {
+        grads[i] = tape.grad(opt.param(i));
+        sizes[i] = opt.param(i).size();
+    }
+
+    const double inv_scale = 1.0 / scaler.scale();
+    GradStats s = grad_stats(grads, sizes, inv_scale, pool);
+
+    if (!scaler.update(s.finite)) return false;
+
+    double grad_scale = inv_scale;
+    if (clip_norm > 0.0 && s.norm() > clip_norm) grad_scale *= clip_norm / s.norm();
+
+    opt.step(grads, (M)grad_scale);
+    return true;
+}
+
+#endif // AMP_HPP
@@ -0,0 +1,118 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+class Arena {
+public:
+    static constexpr size_t ALIGN = 64;
+
+    explicit Arena(size_t block_bytes = 1 << 20)
+        : block_bytes_(block_bytes)
+    {
+        /**
+         * @brief Bump allocator for short-lived, per-iteration allocations
+         *
+         * Memory is carved out of large blocks and never freed one object at a
+         * time; reset() rewinds to the first block in O(1) and keeps every
+         * block, so a loop that allocates the same amount each iteration stops
+         * touching the heap after its first pass. Only trivially destructible
+         * types may live here since reset() runs no destructors.
+         *
+         * @param (size_t) block_bytes: size of each block; larger requests get a block of their own
+        */
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align = ALIGN) {
+        /**
+         * @brief Reserve `bytes` bytes aligned to `align` (a power of two <= ALIGN)
+        */
+        while (block_ < blocks_.size()) {
+            size_t off = (offset_ + align - 1) & ~(align - 1);
+            if (off + bytes <= blocks_[block_].bytes) {
+                offset_ = off + bytes;
+                used_ += bytes;
+                peak_ = std::max(peak_, used_);
+                return blocks_[block_].data.get() + off;
+            }
+            ++block_;
+            offset_ = 0;
+        }
+
+        size_t size = std::max(block_bytes_, bytes);
+        blocks_.push_back(Block{
+            std::unique_ptr<std::byte[], Free>(static_cast<std::byte*>(::operator new(size, std::align_val_t(ALIGN)))),
+            size
+        });
+        block_ = blocks_.size() - 1;
+        offset_ = bytes;
+        used_ += bytes;
+        peak_ = std::max(peak_, used_);
+
+        return blocks_[block_].data.get();
+    }
+
+    template<typename U>
+    U* alloc_array(size_t n) {
+        static_assert(std::is_trivially_destructible_v<U>, "Arena: reset() runs no destructors");
+        return static_cast<U*>(allocate(n * sizeof(U), std::max(alignof(U), (size_t)16)));
+    }
+
+    template<typename U>
+    U* alloc_zeroed(size_t n) {
+        U* p = alloc_array<U>(n);
+        std::memset(static_cast<void*>(p), 0, n * sizeof(U));
+        return p;
+    }
+
+    template<typename U, typename... Args>
+    U* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<U>, "Arena: reset() runs no destructors");
+        return new (allocate(sizeof(U), alignof(U))) U{std::forward<Args>(args)...};
+    }
+
+    void reset() {
+        block_ = 0;
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    size_t used() const { return used_; }
+    size_t block_bytes() const { return block_bytes_; }
+    size_t peak() const { return peak_; }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& b : blocks_) total += b.bytes;
+        return total;
+    }
+
+private:
+    struct Free {
+        void operator()(std::byte* p) const { ::operator delete(p, std::align_val_t(ALIGN)); }
+    };
+
+    struct Block {
+        std::unique_ptr<std::byte[], Free> data;
+        size_t bytes;
+    };
+
+    size_t block_bytes_;
+    std::vector<Block> blocks_;
+
+    size_t block_ = 0;
+    size_t offset_ = 0;
+    size_t used_ = 0;
+    size_t peak_ = 0;
+};
+
+#endif // ARENA_HPP
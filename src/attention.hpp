@@ -0,0 +1,304 @@
+#ifndef ATTENTION_HPP
+#define ATTENTION_HPP
+
+#include <gemm.hpp>
+#include <half.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+#include <vmath.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Fused scaled-dot-product attention, O = softmax(Q K^T * scale) V, without
+ * materialising the [Nq x Nk] score matrix.
+ *
+ * Queries are taken ATTN_BLOCK_Q rows at a time and keys / values streamed
+ * through in ATTN_BLOCK_KV-row tiles. Each tile is packed into GEMM panels and
+ * both products (Q K^T, then P V) run on the packed GEMM micro-kernel; the
+ * block's scores live in an ATTN_BLOCK_Q x ATTN_BLOCK_KV scratch that stays
+ * in L2, and an online softmax keeps a running row max m, denominator l and
+ * unnormalised output:
+ *
+ *     m' = max(m, max_j s_j),  c = exp(m - m'),  l' = c l + sum_j exp(s_j - m')
+ *     acc' = c acc + sum_j exp(s_j - m') v_j,    O = acc / l  after the last tile
+ *
+ * so memory is O(N * D) and each K/V tile is read once per query block. Tasks
+ * are (batch, head, query block) triples on the thread pool. Arithmetic is in
+ * accum_t<T>, so bf16 / fp16 inputs accumulate in float.
+ *
+ * AttentionTile is the per-block state on its own, for callers whose keys and
+ * values are not one contiguous matrix (e.g. a paged KV cache): feed it any
+ * sequence of K/V row ranges in position order, then store().
+ */
+constexpr size_t ATTN_BLOCK_Q = 8 * GEMM_MICRO_M;
+constexpr size_t ATTN_BLOCK_KV = 64;
+
+typedef struct AttentionParams {
+    bool causal = false;    // query i (aligned to the end of the keys) sees keys 0 .. Nk - Nq + i
+    double scale = 0.0;     // 0 = 1 / sqrt(D)
+} AttentionParams;
+
+template<typename T>
+class AttentionTile {
+public:
+    using Acc = accum_t<T>;
+
+    AttentionTile(size_t D, size_t Dv) { resize(D, Dv); }
+
+    void resize(size_t D, size_t Dv) {
+        /**
+         * @brief Size the scratch for head dims D / Dv; capacity is kept, so reuse does not reallocate
+        */
+        D_ = D;
+        Dv_ = Dv;
+        q_.resize(ATTN_BLOCK_Q * D);
+        kp_.resize(D * ATTN_BLOCK_KV);
+        s_.resize(ATTN_BLOCK_Q * ATTN_BLOCK_KV);
+        p_.resize(ATTN_BLOCK_Q * ATTN_BLOCK_KV);
+        vp_.resize(panels(Dv) * ATTN_BLOCK_KV * GEMM_PANEL_N);
+        m_.resize(ATTN_BLOCK_Q);
+        l_.resize(ATTN_BLOCK_Q);
+        acc_.resize(panels(Dv) * ATTN_BLOCK_Q * GEMM_PANEL_N);
+    }
+
+    static AttentionTile& local(size_t D, size_t Dv) {
+        /**
+         * @brief The calling thread's tile, resized to D / Dv
+         *
+         * Pool tasks reuse it instead of allocating the scratch per task. A tile is
+         * only live between begin() and store(), which never wait on the pool, so a
+         * task that ThreadPool::wait() runs on this thread cannot find it in use.
+        */
+        thread_local AttentionTile t(0, 0);
+        t.resize(D, Dv);
+        return t;
+    }
+
+    void begin(const T* q, size_t ldq, size_t rows, Acc scale, bool causal = false, size_t q_pos = 0) {
+        /**
+         * @brief Start a block of up to ATTN_BLOCK_Q query rows
+         *
+         * @param (size_t) q_pos: key position of the first row's own token; with causal
+         *     set, row i only attends to keys at positions <= q_pos + i
+        */
+        if (rows > ATTN_BLOCK_Q) throw std::runtime_error("AttentionTile: more than ATTN_BLOCK_Q rows");
+
+        rows_ = rows;
+        causal_ = causal;
+        q_pos_ = q_pos;
+
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t d = 0; d < D_; ++d) q_[i * D_ + d] = (Acc)q[i * ldq + d] * scale;
+
+        std::fill(m_.begin(), m_.end(), -std::numeric_limits<Acc>::infinity());
+        std::fill(l_.begin(), l_.end(), (Acc)0);
+        std::fill(acc_.begin(), acc_.end(), (Acc)0);
+    }
+
+    void attend(const T* k, size_t ldk, const T* v, size_t ldv, size_t n, size_t kv_pos) {
+        /**
+         * @brief Fold n consecutive keys / values (positions kv_pos ...) into the block
+        */
+        for (size_t j0 = 0; j0 < n; j0 += ATTN_BLOCK_KV) {
+            const size_t pos = kv_pos + j0;
+            if (causal_ && pos > q_pos_ + rows_ - 1) return;
+
+            const size_t w = std::min(ATTN_BLOCK_KV, n - j0);
+            tile(k + j0 * ldk, ldk, v + j0 * ldv, ldv, w, pos);
+        }
+    }
+
+    void store(T* o, size_t ldo) const {
+        /**
+         * @brief O = acc / l; rows that saw no key are written as zeros
+        */
+        for (size_t i = 0; i < rows_; ++i) {
+            const Acc inv = l_[i] > (Acc)0 ? (Acc)1 / l_[i] : (Acc)0;
+            T* out = o + i * ldo;
+            for (size_t d = 0; d < Dv_; ++d) out[d] = (T)(acc_[at(d / GEMM_PANEL_N, i) + d % GEMM_PANEL_N] * inv);
+        }
+    }
+
+private:
+    static size_t panels(size_t n) { return (n + GEMM_PANEL_N - 1) / GEMM_PANEL_N; }
+
+    // offset of row i in panel pn of a [panels][ATTN_BLOCK_Q][GEMM_PANEL_N] buffer (s_, acc_)
+    static size_t at(size_t pn, size_t i) { return (pn * ATTN_BLOCK_Q + i) * GEMM_PANEL_N; }
+
+    // C (panel-major, see at()) [+]= A[rows_ x K] * panel, via the packed GEMM micro-kernel
+    void micro(const Acc* a, size_t lda, const Acc* panel, size_t K, Acc* c, bool accumulate) const {
+        size_t i = 0;
+        for (; i + GEMM_MICRO_M <= rows_; i += GEMM_MICRO_M) {
+            gemm_packed_micro<Acc, GEMM_MICRO_M>(a + i * lda, lda, panel, K, c + i * GEMM_PANEL_N, accumulate);
+        }
+        for (; i < rows_; ++i) {
+            gemm_packed_micro<Acc, 1>(a + i * lda, lda, panel, K, c + i * GEMM_PANEL_N, accumulate);
+        }
+    }
+
+    // p[j] = exp(p[j] - mx) for j < n, returning the sum; vectorised (vmath.hpp) for float
+    static Acc exp_sum(Acc* p, size_t n, Acc mx) {
+        if constexpr (std::is_same_v<Acc, float>) {
+            return vexp_sum(p, p, n, mx);
+        } else {
+            Acc sum = (Acc)0;
+            for (size_t j = 0; j < n; ++j) {
+                p[j] = std::exp(p[j] - mx);
+                sum += p[j];
+            }
+            return sum;
+        }
+    }
+
+    void tile(const T* k, size_t ldk, const T* v, size_t ldv, size_t w, size_t pos) {
+        const size_t kpn = panels(w), vpn = panels(Dv_);
+
+        // K^T and V packed into GEMM panels, zero padded past w / Dv
+        std::fill(kp_.begin(), kp_.begin() + kpn * D_ * GEMM_PANEL_N, (Acc)0);
+        for (size_t j = 0; j < w; ++j) {
+            Acc* dst = kp_.data() + (j / GEMM_PANEL_N) * D_ * GEMM_PANEL_N + j % GEMM_PANEL_N;
+            for (size_t d = 0; d < D_; ++d) dst[d * GEMM_PANEL_N] = (Acc)k[j * ldk + d];
+        }
+        for (size_t pn = 0; pn < vpn; ++pn) {
+            const size_t d0 = pn * GEMM_PANEL_N, dn = std::min(GEMM_PANEL_N, Dv_ - d0);
+            Acc* dst = vp_.data() + pn * w * GEMM_PANEL_N;
+            for (size_t j = 0; j < w; ++j) {
+                for (size_t d = 0; d < dn; ++d) dst[j * GEMM_PANEL_N + d] = (Acc)v[j * ldv + d0 + d];
+                for (size_t d = dn; d < GEMM_PANEL_N; ++d) dst[j * GEMM_PANEL_N + d] = (Acc)0;
+            }
+        }
+
+        // S = (Q * scale) K^T
+        for (size_t pn = 0; pn < kpn; ++pn) {
+            micro(q_.data(), D_, kp_.data() + pn * D_ * GEMM_PANEL_N, D_, s_.data() + at(pn, 0), false);
+        }
+
+        // online softmax: P = exp(S - m'), rescale the running output by exp(m - m')
+        for (size_t i = 0; i < rows_; ++i) {
+            Acc* p = p_.data() + i * ATTN_BLOCK_KV;
+
+            // keys this row may see in the tile
+            size_t lim = w;
+            if (causal_) {
+                const size_t last = q_pos_ + i;
+                lim = last < pos ? 0 : std::min(w, last - pos + 1);
+            }
+            std::fill(p + lim, p + w, (Acc)0);
+            if (lim == 0) continue;
+
+            Acc mx = m_[i];
+            for (size_t j = 0; j < lim; ++j) {
+                p[j] = s_[at(j / GEMM_PANEL_N, i) + j % GEMM_PANEL_N];
+                mx = std::max(mx, p[j]);
+            }
+
+            const Acc c = std::exp(m_[i] - mx);
+            const Acc sum = exp_sum(p, lim, mx);
+            m_[i] = mx;
+            l_[i] = l_[i] * c + sum;
+
+            if (c != (Acc)1) {
+                for (size_t pn = 0; pn < vpn; ++pn) {
+                    Acc* a = acc_.data() + at(pn, i);
+                    for (size_t d = 0; d < GEMM_PANEL_N; ++d) a[d] *= c;
+                }
+            }
+        }
+
+        // acc += P V
+        for (size_t pn = 0; pn < vpn; ++pn) {
+            micro(p_.data(), ATTN_BLOCK_KV, vp_.data() + pn * w * GEMM_PANEL_N, w, acc_.data() + at(pn, 0), true);
+        }
+    }
+
+    size_t D_ = 0, Dv_ = 0;
+    size_t rows_ = 0;
+    bool causal_ = false;
+    size_t q_pos_ = 0;
+
+    std::vector<Acc> q_;    // [ATTN_BLOCK_Q x D], pre-scaled
+    std::vector<Acc> kp_;   // K^T tile, GEMM panels of [D x GEMM_PANEL_N]
+    std::vector<Acc> s_;    // scores, panel-major (at())
+    std::vector<Acc> p_;    // [ATTN_BLOCK_Q x ATTN_BLOCK_KV] probabilities, row-major
+    std::vector<Acc> vp_;   // V tile, GEMM panels of [w x GEMM_PANEL_N]
+    std::vector<Acc> m_, l_;
+    std::vector<Acc> acc_;  // unnormalised output, panel-major (at())
+};
+
+template<typename T = float>
+void attention(const T* Q, const T* K, const T* V, T* O,
+               size_t B, size_t H, size_t Hkv, size_t Nq, size_t Nk, size_t D, size_t Dv,
+               AttentionParams p = {}, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Raw-pointer attention over contiguous [B, H, N, D] tensors
+     *
+     * @param (size_t) Hkv: key / value heads; H must be a multiple of it and query
+     *     head h reads kv head h / (H / Hkv) (grouped-query attention, Hkv = H for plain MHA)
+    */
+    if (Hkv == 0 || H % Hkv != 0) {
+        throw std::runtime_error("attention: " + std::to_string(H) + " query heads do not group over " +
+                                 std::to_string(Hkv) + " kv heads");
+    }
+    if (p.causal && Nq > Nk) throw std::runtime_error("attention: causal needs Nq <= Nk");
+
+    using Acc = accum_t<T>;
+    const Acc scale = (Acc)(p.scale > 0.0 ? p.scale : 1.0 / std::sqrt((double)D));
+    const size_t qb = (Nq + ATTN_BLOCK_Q - 1) / ATTN_BLOCK_Q, group = H / Hkv;
+
+    auto body = [&](size_t lo, size_t hi) {
+        AttentionTile<T>& t = AttentionTile<T>::local(D, Dv);
+
+        for (size_t task = lo; task < hi; ++task) {
+            const size_t bh = task / qb, i0 = (task % qb) * ATTN_BLOCK_Q;
+            const size_t b = bh / H, kvh = b * Hkv + (bh % H) / group;
+            const size_t rows = std::min(ATTN_BLOCK_Q, Nq - i0);
+
+            const T* k = K + kvh * Nk * D;
+            const T* v = V + kvh * Nk * Dv;
+
+            t.begin(Q + (bh * Nq + i0) * D, D, rows, scale, p.causal, Nk - Nq + i0);
+            t.attend(k, D, v, Dv, Nk, 0);
+            t.store(O + (bh * Nq + i0) * Dv, Dv);
+        }
+    };
+
+    if (pool) pool->parallel_for(0, B * H * qb, 1, body);
+    else body(0, B * H * qb);
+}
+
+template<typename T = float>
+NTensor<T> attention(NTensor<T>& Q, NTensor<T>& K, NTensor<T>& V, AttentionParams p = {},
+                     ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief O = softmax(Q K^T * scale) V
+     *
+     * @param (NTensor<T>) Q: [B x H x Nq x D]
+     * @param (NTensor<T>) K: [B x Hkv x Nk x D]
+     * @param (NTensor<T>) V: [B x Hkv x Nk x Dv]
+     *
+     * @return (NTensor<T>) [B x H x Nq x Dv]
+    */
+    if (Q.ndim() != 4 || K.ndim() != 4 || V.ndim() != 4) {
+        throw std::runtime_error("attention: expected [B x H x N x D] tensors");
+    }
+
+    const size_t* q = Q.shape();
+    const size_t* k = K.shape();
+    const size_t* v = V.shape();
+    if (k[0] != q[0] || v[0] != q[0] || v[1] != k[1] || v[2] != k[2] || k[3] != q[3]) {
+        throw std::runtime_error("attention: Q / K / V shapes do not match");
+    }
+
+    NTensor<T> O({q[0], q[1], q[2], v[3]}, (T)0, Q.config());
+    attention(Q.data(), K.data(), V.data(), O.data(), q[0], q[1], k[1], q[2], k[2], q[3], v[3], p, pool);
+    return O;
+}
+
+#endif // ATTENTION_HPP
@@ -0,0 +1,462 @@
+#ifndef AUTOGRAD_HPP
+#define AUTOGRAD_HPP
+
+#include <arena.hpp>
+#include <gemm.hpp>
+#include <norm.hpp>
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Reverse-mode automatic differentiation over 2D row-major values.
+ *
+ * Every op records a node on a Tape; node values, gradient buffers and the
+ * nodes themselves come from the tape's Arena, so a training step allocates
+ * nothing once the arena has grown to fit it and Tape::reset() drops the
+ * whole graph in O(1). Parameters and inputs are referenced in place, never
+ * copied onto the tape; a 1D tensor of n values is treated as [1 x n].
+ *
+ *     Tape<float> tape;
+ *     auto x = tape.input(X);  auto w = tape.param(W);  auto b = tape.param(bias);
+ *     auto loss = mean(matmul(x, w) + b);
+ *     tape.backward(loss);     // tape.grad(W) / w.grad() now hold dloss/dW
+ *     ...
+ *     tape.reset();            // next iteration
+ */
+namespace _autograd {
+
+enum class Op { LEAF, MATMUL, ADD, SUB, SUM, MEAN, SCALE, CHECKPOINT, SOFTMAX_XENT };
+
+template<typename T>
+struct Node {
+    Op op;
+    size_t rows, cols;
+    T* value;
+    T* grad;          // nullptr until backward(), and for nodes that need no gradient
+    Node* a;
+    Node* b;
+    T scalar;
+    size_t segment;   // CHECKPOINT: index into the tape's segment functions
+    T* saved;         // SOFTMAX_XENT: d(loss)/d(logits), produced by the fused forward
+    bool requires_grad;
+    Node* prev;       // recording order, newest first; reversed topological order by construction
+};
+
+} // namespace _autograd
+
+template<typename T>
+class Tape;
+
+template<typename T = float>
+class Var {
+public:
+    Var() = default;
+    Var(Tape<T>* tape, _autograd::Node<T>* node) : tape_(tape), node_(node) {}
+
+    T* value() const { return node_->value; }
+    T* grad() const { return node_->grad; }
+    size_t rows() const { return node_->rows; }
+    size_t cols() const { return node_->cols; }
+    size_t size() const { return node_->rows * node_->cols; }
+    bool requires_grad() const { return node_->requires_grad; }
+    T item() const { return node_->value[0]; }
+
+    Tape<T>* tape() const { return tape_; }
+    _autograd::Node<T>* node() const { return node_; }
+
+private:
+    Tape<T>* tape_ = nullptr;
+    _autograd::Node<T>* node_ = nullptr;
+};
+
+template<typename T = float>
+class Tape {
+public:
+    using Node = _autograd::Node<T>;
+    using Op = _autograd::Op;
+    using Segment = std::function<Var<T>(Tape<T>&, Var<T>)>;
+
+    explicit Tape(ThreadPool* pool = &ThreadPool::global(), size_t arena_block_bytes = 1 << 20)
+        : arena_(arena_block_bytes), pool_(pool)
+    {
+        /**
+         * @brief Recording context for one forward/backward pass
+         *
+         * @param (ThreadPool*) pool: pool for matmul forward/backward GEMMs, nullptr = calling thread
+         * @param (size_t) arena_block_bytes: block size of the backing arena
+        */
+    }
+
+    Tape(const Tape&) = delete;
+    Tape& operator=(const Tape&) = delete;
+
+    Var<T> param(NTensor<T>& t) {
+        /**
+         * @brief Trainable leaf; the tensor is read in place and must outlive the pass
+         *
+         * Recording the same tensor twice returns the existing leaf, so every
+         * use of a parameter accumulates into one gradient buffer.
+        */
+        if (Node* n = find_param(t.data())) return Var<T>(this, n);
+        return leaf(t.data(), t, true);
+    }
+
+    Var<T> input(NTensor<T>& t) {
+        /**
+         * @brief Constant leaf (no gradient); the tensor is read in place
+        */
+        return leaf(t.data(), t, false);
+    }
+
+    Var<T> input(const T* data, size_t rows, size_t cols, bool requires_grad = false) {
+        return Var<T>(this, record(Op::LEAF, rows, cols, const_cast<T*>(data), nullptr, nullptr, (T)0, requires_grad));
+    }
+
+    Var<T> matmul(Var<T> a, Var<T> b) {
+        if (a.cols() != b.rows()) {
+            throw std::runtime_error("autograd matmul: [" + std::to_string(a.rows()) + " x " + std::to_string(a.cols()) +
+                                     "] * [" + std::to_string(b.rows()) + " x " + std::to_string(b.cols()) + "]");
+        }
+
+        Node* n = record(Op::MATMUL, a.rows(), b.cols(), nullptr, a.node(), b.node(), (T)0,
+                         a.requires_grad() || b.requires_grad());
+
+        GemmArgs<T> g;
+        g.M = a.rows(); g.N = b.cols(); g.K = a.cols();
+        g.A = a.value(); g.lda = a.cols();
+        g.B = b.value(); g.ldb = b.cols();
+        g.C = n->value;  g.ldc = b.cols();
+        run(g);
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> add(Var<T> a, Var<T> b) {
+        /**
+         * @brief a + b; b may also be a single row [1 x cols] broadcast over a's rows (bias)
+        */
+        if (a.cols() != b.cols() || (a.rows() != b.rows() && b.rows() != 1)) {
+            throw std::runtime_error("autograd add: shapes differ and rhs is not a broadcastable row");
+        }
+
+        Node* n = record(Op::ADD, a.rows(), a.cols(), nullptr, a.node(), b.node(), (T)0,
+                         a.requires_grad() || b.requires_grad());
+
+        const size_t C = a.cols(), bstride = b.rows() == 1 ? 0 : C;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            const T* x = a.value() + i * C;
+            const T* y = b.value() + i * bstride;
+            T* out = n->value + i * C;
+            for (size_t j = 0; j < C; ++j) out[j] = x[j] + y[j];
+        }
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> sub(Var<T> a, Var<T> b) {
+        if (a.rows() != b.rows() || a.cols() != b.cols()) {
+            throw std::runtime_error("autograd sub: shapes differ");
+        }
+
+        Node* n = record(Op::SUB, a.rows(), a.cols(), nullptr, a.node(), b.node(), (T)0,
+                         a.requires_grad() || b.requires_grad());
+
+        for (size_t i = 0; i < n->rows * n->cols; ++i) n->value[i] = a.value()[i] - b.value()[i];
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> scale(Var<T> a, T s) {
+        Node* n = record(Op::SCALE, a.rows(), a.cols(), nullptr, a.node(), nullptr, s, a.requires_grad());
+
+        for (size_t i = 0; i < n->rows * n->cols; ++i) n->value[i] = a.value()[i] * s;
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> sum(Var<T> a) {
+        Node* n = record(Op::SUM, 1, 1, nullptr, a.node(), nullptr, (T)0, a.requires_grad());
+
+        accum_t<T> acc = 0;
+        for (size_t i = 0; i < a.size(); ++i) acc += (accum_t<T>)a.value()[i];
+        n->value[0] = (T)acc;
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> mean(Var<T> a) {
+        Node* n = record(Op::MEAN, 1, 1, nullptr, a.node(), nullptr, (T)0, a.requires_grad());
+
+        accum_t<T> acc = 0;
+        for (size_t i = 0; i < a.size(); ++i) acc += (accum_t<T>)a.value()[i];
+        n->value[0] = (T)(acc / (accum_t<T>)a.size());
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> softmax_cross_entropy(Var<T> logits, const size_t* labels) {
+        /**
+         * @brief Mean cross-entropy of row-wise softmax(logits) against class labels, [1 x 1]
+         *
+         * Runs the fused kernel from norm.hpp once: the gradient with respect
+         * to the logits comes out of the forward pass and is kept on the tape,
+         * so backward is a single scaled add.
+         *
+         * @param (const size_t*) labels: logits.rows() class indices, read during this call only
+        */
+        Node* n = record(Op::SOFTMAX_XENT, 1, 1, nullptr, logits.node(), nullptr, (T)0, logits.requires_grad());
+
+        T* d = logits.requires_grad() ? arena_.alloc_array<T>(logits.size()) : nullptr;
+        n->value[0] = (T)::softmax_cross_entropy(logits.value(), labels, logits.rows(), logits.cols(), d, 0.0, pool_);
+        n->saved = d;
+
+        return Var<T>(this, n);
+    }
+
+    Var<T> checkpoint(Segment fn, Var<T> x) {
+        /**
+         * @brief Run fn(tape, x) without keeping its intermediate activations
+         *
+         * The segment is recorded on a scratch tape whose memory is recycled as
+         * soon as its output has been copied here; backward() runs it again
+         * from x to rebuild the activations it needs. Only the output (and x,
+         * which the caller already holds) stays alive between forward and
+         * backward. fn must be deterministic and may record params, which are
+         * mirrored onto this tape so grad(W) sees their gradients.
+         *
+         * @param (Segment) fn: sub-graph builder, called once now and once per backward()
+         * @param (Var<T>) x: segment input recorded on this tape
+         *
+         * @return (Var<T>) segment output recorded on this tape
+        */
+        Tape<T>& sub = scratch();
+        sub.reset();
+
+        Var<T> xi = sub.input(x.value(), x.rows(), x.cols(), x.requires_grad());
+        Var<T> y = fn(sub, xi);
+
+        for (Node* n = sub.head_; n; n = n->prev) {
+            if (n->op == Op::LEAF && n->requires_grad && n != xi.node() && !find_param(n->value)) {
+                record(Op::LEAF, n->rows, n->cols, n->value, nullptr, nullptr, (T)0, true);
+            }
+        }
+
+        Node* out = record(Op::CHECKPOINT, y.rows(), y.cols(), nullptr, x.node(), nullptr, (T)0, y.requires_grad());
+        std::copy(y.value(), y.value() + y.size(), out->value);
+        out->segment = segments_.size();
+        segments_.push_back(std::move(fn));
+
+        sub.reset();
+        return Var<T>(this, out);
+    }
+
+    void backward(Var<T> loss, T seed = (T)1) {
+        /**
+         * @brief Fill the gradient of every recorded node that needs one with d(loss)/d(node)
+         *
+         * Gradient buffers are taken from the arena (zeroed) on each call and
+         * stay valid until reset(). Each backward kernel accumulates straight
+         * into its inputs' buffers: matmul runs two GEMMs with the transpose
+         * flags and beta = 1, add/sub update both operands in a single pass.
+         *
+         * @param (Var<T>) loss: scalar [1 x 1] node recorded on this tape
+         * @param (T) seed: d(loss)/d(loss); the loss scale when training in mixed precision
+        */
+        if (loss.tape() != this || loss.size() != 1) {
+            throw std::runtime_error("autograd backward: loss must be a [1 x 1] node of this tape");
+        }
+
+        backward_from(loss.node(), &seed);
+    }
+
+    T* grad(NTensor<T>& t) {
+        /**
+         * @brief Gradient of the param() leaf over t, nullptr if t was not recorded as a param
+         *
+         * Only trainable leaves are searched: an input() over the same buffer
+         * (e.g. a weight also fed in as data) never shadows the parameter.
+        */
+        Node* n = find_param(t.data());
+        return n ? n->grad : nullptr;
+    }
+
+    void reset() {
+        /**
+         * @brief Forget the recorded graph and recycle all of its memory in O(1)
+        */
+        arena_.reset();
+        head_ = nullptr;
+        nodes_ = 0;
+        segments_.clear();
+    }
+
+    size_t nodes() const { return nodes_; }
+    Arena& arena() { return arena_; }
+
+private:
+    Arena arena_;
+    ThreadPool* pool_;
+
+    Node* head_ = nullptr;
+    size_t nodes_ = 0;
+
+    std::vector<Segment> segments_;
+    std::unique_ptr<Tape<T>> scratch_;
+
+    Tape<T>& scratch() {
+        if (!scratch_) scratch_ = std::make_unique<Tape<T>>(pool_, arena_.block_bytes());
+        return *scratch_;
+    }
+
+    Node* find_param(const T* value) {
+        for (Node* n = head_; n; n = n->prev) {
+            if (n->op == Op::LEAF && n->requires_grad && n->value == value) return n;
+        }
+        return nullptr;
+    }
+
+    void backward_from(Node* root, const T* seed) {
+        for (Node* n = head_; n; n = n->prev) {
+            n->grad = n->requires_grad ? arena_.alloc_zeroed<T>(n->rows * n->cols) : nullptr;
+        }
+
+        if (!root->requires_grad) return;
+        std::copy(seed, seed + root->rows * root->cols, root->grad);
+
+        // nodes recorded after the root cannot contribute to it
+        for (Node* n = root; n; n = n->prev) {
+            if (n->requires_grad && n->op != Op::LEAF) backward_node(n);
+        }
+    }
+
+    Var<T> leaf(T* data, NTensor<T>& t, bool requires_grad) {
+        if (t.ndim() > 2) {
+            throw std::runtime_error("autograd: only 1D/2D tensors can be recorded");
+        }
+        size_t rows = t.ndim() == 2 ? t.shape()[0] : 1;
+        size_t cols = t.ndim() == 2 ? t.shape()[1] : t.shape()[0];
+
+        return Var<T>(this, record(Op::LEAF, rows, cols, data, nullptr, nullptr, (T)0, requires_grad));
+    }
+
+    Node* record(Op op, size_t rows, size_t cols, T* value, Node* a, Node* b, T scalar, bool requires_grad) {
+        if (!value) value = arena_.alloc_array<T>(rows * cols);
+
+        Node* n = arena_.make<Node>(op, rows, cols, value, (T*)nullptr, a, b, scalar, (size_t)0, (T*)nullptr,
+                                    requires_grad, head_);
+        head_ = n;
+        ++nodes_;
+
+        return n;
+    }
+
+    void run(const GemmArgs<T>& g) {
+        if (pool_) gemm_parallel(g, *pool_);
+        else gemm(g);
+    }
+
+    void backward_node(Node* n) {
+        Node* a = n->a;
+        Node* b = n->b;
+        const T* g = n->grad;
+        const size_t size = n->rows * n->cols;
+
+        switch (n->op) {
+        case Op::MATMUL: {
+            // C = A * B:  dA += dC * B^T,  dB += A^T * dC
+            if (a->requires_grad) {
+                GemmArgs<T> ga;
+                ga.trans_b = true;
+                ga.M = a->rows; ga.N = a->cols; ga.K = n->cols;
+                ga.A = g;        ga.lda = n->cols;
+                ga.B = b->value; ga.ldb = b->cols;
+                ga.beta = (T)1;
+                ga.C = a->grad;  ga.ldc = a->cols;
+                run(ga);
+            }
+            if (b->requires_grad) {
+                GemmArgs<T> gb;
+                gb.trans_a = true;
+                gb.M = b->rows; gb.N = b->cols; gb.K = n->rows;
+                gb.A = a->value; gb.lda = a->cols;
+                gb.B = g;        gb.ldb = n->cols;
+                gb.beta = (T)1;
+                gb.C = b->grad;  gb.ldc = b->cols;
+                run(gb);
+            }
+            return;
+        }
+        case Op::ADD: {
+            const size_t C = n->cols, bstride = b->rows == 1 ? 0 : C;
+            T* ga = a->grad;
+            T* gb = b->grad;
+
+            for (size_t i = 0; i < n->rows; ++i) {
+                const T* gi = g + i * C;
+                if (ga) for (size_t j = 0; j < C; ++j) ga[i * C + j] += gi[j];
+                if (gb) for (size_t j = 0; j < C; ++j) gb[i * bstride + j] += gi[j];
+            }
+            return;
+        }
+        case Op::SUB: {
+            if (a->grad) for (size_t i = 0; i < size; ++i) a->grad[i] += g[i];
+            if (b->grad) for (size_t i = 0; i < size; ++i) b->grad[i] -= g[i];
+            return;
+        }
+        case Op::SCALE: {
+            for (size_t i = 0; i < size; ++i) a->grad[i] += n->scalar * g[i];
+            return;
+        }
+        case Op::SUM:
+        case Op::MEAN: {
+            T d = n->op == Op::SUM ? g[0] : g[0] / (T)(a->rows * a->cols);
+            for (size_t i = 0; i < a->rows * a->cols; ++i) a->grad[i] += d;
+            return;
+        }
+        case Op::SOFTMAX_XENT: {
+            const size_t m = a->rows * a->cols;
+            for (size_t i = 0; i < m; ++i) a->grad[i] += g[0] * n->saved[i];
+            return;
+        }
+        case Op::CHECKPOINT: {
+            // recompute the segment from its saved input, then push n->grad through it
+            Tape<T>& sub = scratch();
+            sub.reset();
+
+            Var<T> xi = sub.input(a->value, a->rows, a->cols, a->requires_grad);
+            Var<T> y = segments_[n->segment](sub, xi);
+            sub.backward_from(y.node(), g);
+
+            for (Node* s = sub.head_; s; s = s->prev) {
+                if (s->op != Op::LEAF || !s->requires_grad) continue;
+
+                T* dst = s == xi.node() ? a->grad : find_param(s->value)->grad;
+                for (size_t i = 0; i < s->rows * s->cols; ++i) dst[i] += s->grad[i];
+            }
+
+            sub.reset();
+            return;
+        }
+        case Op::LEAF:
+            return;
+        }
+    }
+};
+
+template<typename T> Var<T> matmul(Var<T> a, Var<T> b) { return a.tape()->matmul(a, b); }
+template<typename T> Var<T> sum(Var<T> a) { return a.tape()->sum(a); }
+template<typename T> Var<T> mean(Var<T> a) { return a.tape()->mean(a); }
+template<typename T> Var<T> softmax_cross_entropy(Var<T> logits, const size_t* labels) {
+    return logits.tape()->softmax_cross_entropy(logits, labels);
+}
+template<typename T> Var<T> operator+(Var<T> a, Var<T> b) { return a.tape()->add(a, b); }
+template<typename T> Var<T> operator-(Var<T> a, Var<T> b) { return a.tape()->sub(a, b); }
+template<typename T> Var<T> operator*(Var<T> a, std::type_identity_t<T> s) { return a.tape()->scale(a, s); }
+template<typename T> Var<T> operator*(std::type_identity_t<T> s, Var<T> a) { return a.tape()->scale(a, s); }
+
+#endif // AUTOGRAD_HPP
@@ -0,0 +1,220 @@
+#ifndef BATCHER_HPP
+#define BATCHER_HPP
+
+#include <gemm.hpp>
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef struct BatcherConfig {
+    size_t window_us = 200;       // how long the first request of a batch may wait for company
+    size_t max_batch_rows = 512;  // flush early once this many A rows are stacked
+    TaskOptions task = {.priority = Priority::CRITICAL};
+} BatcherConfig;
+
+typedef struct BatcherStats {
+    size_t requests = 0;
+    size_t batches = 0;
+    size_t rows = 0;
+
+    double mean_batch_requests() const {
+        return batches ? (double)requests / (double)batches : 0.0;
+    }
+} BatcherStats;
+
+template<typename T = float>
+class MatmulBatcher {
+public:
+    explicit MatmulBatcher(BatcherConfig cfg = {}, ThreadPool& pool = ThreadPool::global())
+        : cfg_(cfg), pool_(pool)
+    {
+        /**
+         * @brief Front end that coalesces concurrent A * B requests sharing the same B
+         *
+         * Requests against one B are stacked row-wise into a single
+         * [sum(M_i) x K] operand, multiplied in one GEMM on the pool, and the
+         * [M_i x N] slices of the product are handed back through futures.
+         *
+         * @param (BatcherConfig) cfg: batching window / size and the pool task options
+         * @param (ThreadPool) pool: pool the stacked GEMMs run on
+        */
+        dispatcher_ = std::thread([this] { dispatch_loop(); });
+    }
+
+    MatmulBatcher(const MatmulBatcher&) = delete;
+    MatmulBatcher& operator=(const MatmulBatcher&) = delete;
+
+    ~MatmulBatcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        dispatcher_.join();
+
+        // flushes issued by the dispatcher reference this object
+        for (std::future<void>& f : inflight_) pool_.wait(f);
+    }
+
+    std::future<NTensor<T>> submit(NTensor<T>& A, NTensor<T>& B) {
+        /**
+         * @brief Queue A * B; A is copied into the batch, B must outlive the returned future
+         *
+         * @param (NTensor<T>) A: [M x K]
+         * @param (NTensor<T>) B: [K x N] shared operand, batches are keyed on its storage
+         *
+         * @return (std::future<NTensor<T>>) [M x N] product
+        */
+        if (A.ndim() != 2 || B.ndim() != 2 || A.shape()[1] != B.shape()[0]) {
+            throw std::runtime_error("MatmulBatcher: expected [M x K] * [K x N] operands");
+        }
+
+        std::promise<NTensor<T>> promise;
+        std::future<NTensor<T>> fut = promise.get_future();
+
+        bool wake = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::shared_ptr<Batch>& batch = pending_[B.data()];
+            if (!batch) {
+                batch = std::make_shared<Batch>();
+                batch->B = &B;
+                batch->opened = Clock::now();
+                wake = true; // dispatcher has to learn the new window's due time
+            }
+
+            batch->stacked.insert(batch->stacked.end(), A.data(), A.data() + A.size());
+            batch->requests.push_back(Request{A.shape()[0], std::move(promise)});
+            batch->rows += A.shape()[0];
+
+            wake = wake || batch->rows >= cfg_.max_batch_rows;
+        }
+
+        if (wake) cv_.notify_one();
+
+        return fut;
+    }
+
+    NTensor<T> matmul(NTensor<T>& A, NTensor<T>& B) {
+        std::future<NTensor<T>> fut = submit(A, B);
+        return fut.get();
+    }
+
+    BatcherStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Request {
+        size_t rows;
+        std::promise<NTensor<T>> promise;
+    };
+
+    struct Batch {
+        NTensor<T>* B = nullptr;
+        std::vector<T> stacked;
+        std::vector<Request> requests;
+        size_t rows = 0;
+        Clock::time_point opened;
+    };
+
+    BatcherConfig cfg_;
+    ThreadPool& pool_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread dispatcher_;
+    std::map<T*, std::shared_ptr<Batch>> pending_;
+    std::vector<std::future<void>> inflight_;
+    BatcherStats stats_;
+    bool stop_ = false;
+
+    void dispatch_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const Clock::duration window = std::chrono::microseconds(cfg_.window_us);
+
+        for (;;) {
+            Clock::time_point now = Clock::now();
+            Clock::time_point next_due = Clock::time_point::max();
+
+            for (auto it = pending_.begin(); it != pending_.end();) {
+                std::shared_ptr<Batch> batch = it->second;
+                Clock::time_point due = batch->opened + window;
+
+                if (stop_ || due <= now || batch->rows >= cfg_.max_batch_rows) {
+                    it = pending_.erase(it);
+
+                    stats_.batches++;
+                    stats_.requests += batch->requests.size();
+                    stats_.rows += batch->rows;
+
+                    inflight_.push_back(pool_.submit([this, batch] { flush(*batch); }, cfg_.task));
+                } else {
+                    next_due = std::min(next_due, due);
+                    ++it;
+                }
+            }
+
+            // reap finished flushes so inflight_ doesn't grow without bound
+            std::erase_if(inflight_, [](std::future<void>& f) {
+                return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            });
+
+            if (stop_) return;
+
+            if (next_due == Clock::time_point::max()) {
+                cv_.wait(lock);
+            } else {
+                cv_.wait_until(lock, next_due);
+            }
+        }
+    }
+
+    void flush(Batch& batch) {
+        size_t K = batch.B->shape()[0];
+        size_t N = batch.B->shape()[1];
+
+        try {
+            std::vector<T> out(batch.rows * N);
+
+            GemmArgs<T> g;
+            g.M = batch.rows; g.N = N; g.K = K;
+            g.A = batch.stacked.data(); g.lda = K;
+            g.B = batch.B->data(); g.ldb = N;
+            g.C = out.data(); g.ldc = N;
+
+            if (batch.rows >= GEMM_TILE_M) {
+                gemm_parallel(g, pool_, cfg_.task);
+            } else {
+                gemm(g);
+            }
+
+            // scatter the product rows back to each caller
+            const T* src = out.data();
+            for (Request& r : batch.requests) {
+                NTensor<T> C({r.rows, N}, (T)0, batch.B->config());
+                std::copy(src, src + r.rows * N, C.data());
+                src += r.rows * N;
+
+                r.promise.set_value(std::move(C));
+            }
+        } catch (...) {
+            for (Request& r : batch.requests) {
+                try {
+                    r.promise.set_exception(std::current_exception());
+                } catch (const std::future_error&) {
+                    // already satisfied before the failure
+                }
+            }
+        }
+    }
+};
+
+#endif // BATCHER_HPP
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <gemm.hpp>
+#include <log.hpp>
+#include <prune.hpp>
+#include <vmath.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef struct BenchConfig {
+    size_t n = 1 << 16;     // elements per pass, small enough to stay in L2
+    size_t reps = 200;
+    size_t batch = 32;      // sparse: rows of X
+    size_t dim = 1024;      // sparse: layer is [dim x dim]
+} BenchConfig;
+
+// cycles (TSC ticks) where the CPU has a time-stamp counter, nanoseconds otherwise
+static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+template<typename F>
+static double per_tick(const BenchConfig& cfg, F&& pass) {
+    pass();  // warm up caches and page in the buffers
+
+    uint64_t best = UINT64_MAX;
+    for (size_t r = 0; r < cfg.reps; ++r) {
+        uint64_t t0 = ticks();
+        pass();
+        best = std::min(best, ticks() - t0);
+    }
+    return (double)cfg.n / (double)best;
+}
+
+static void bench_vmath(const BenchConfig& cfg) {
+    /**
+     * @brief Elements per cycle of each vmath.hpp function, both tiers, against scalar libm
+    */
+    std::vector<float> x(cfg.n), y(cfg.n);
+    for (size_t i = 0; i < cfg.n; ++i) x[i] = -8.0f + 16.0f * (float)i / (float)cfg.n;
+    std::vector<float> xp(cfg.n);
+    for (size_t i = 0; i < cfg.n; ++i) xp[i] = 1e-3f + 100.0f * (float)i / (float)cfg.n;
+
+    struct Row {
+        const char* name;
+        const std::vector<float>& in;
+        void (*fast)(const float*, float*, size_t);
+        void (*precise)(const float*, float*, size_t);
+        float (*libm)(float);
+    };
+
+    const Row rows[] = {
+        {"exp",     x,  vexp<MathAccuracy::FAST>,     vexp<MathAccuracy::PRECISE>,     [](float v) { return std::exp(v); }},
+        {"log",     xp, vlog<MathAccuracy::FAST>,     vlog<MathAccuracy::PRECISE>,     [](float v) { return std::log(v); }},
+        {"tanh",    x,  vtanh<MathAccuracy::FAST>,    vtanh<MathAccuracy::PRECISE>,    [](float v) { return std::tanh(v); }},
+        {"sigmoid", x,  vsigmoid<MathAccuracy::FAST>, vsigmoid<MathAccuracy::PRECISE>, [](float v) { return 1.0f / (1.0f + std::exp(-v)); }},
+        {"silu",    x,  vsilu<MathAccuracy::FAST>,    vsilu<MathAccuracy::PRECISE>,    [](float v) { return v / (1.0f + std::exp(-v)); }},
+        {"erf",     x,  verf<MathAccuracy::FAST>,     verf<MathAccuracy::PRECISE>,     [](float v) { return std::erf(v); }},
+        {"gelu",    x,  vgelu<MathAccuracy::FAST>,    vgelu<MathAccuracy::PRECISE>,    [](float v) { return 0.5f * v * (1.0f + std::erf(v * 0.70710678f)); }},
+    };
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "elem/cycle";
+#else
+    const char* unit = "elem/ns";
+#endif
+    std::printf("%-8s %12s %12s %12s   (%s, n = %zu)\n", "", "libm", "precise", "fast", unit, cfg.n);
+
+    for (const Row& r : rows) {
+        const float* in = r.in.data();
+        float* out = y.data();
+
+        double libm = per_tick(cfg, [&] { for (size_t i = 0; i < cfg.n; ++i) out[i] = r.libm(in[i]); });
+        double precise = per_tick(cfg, [&] { r.precise(in, out, cfg.n); });
+        double fast = per_tick(cfg, [&] { r.fast(in, out, cfg.n); });
+
+        std::printf("%-8s %12.3f %12.3f %12.3f\n", r.name, libm, precise, fast);
+    }
+}
+
+static void bench_sparse(const BenchConfig& cfg) {
+    /**
+     * @brief Latency of one [batch x dim] * [dim x dim] layer, dense against each pruned format
+    */
+    const size_t M = cfg.batch, K = cfg.dim, N = cfg.dim;
+    ThreadPool& pool = ThreadPool::global();
+
+    std::mt19937 rng(0);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    NTensor<float> X({M, K}, 0.0f, NTensorConfig{48});
+    NTensor<float> W({K, N}, 0.0f, NTensorConfig{48});
+    for (size_t i = 0; i < X.size(); ++i) X.data()[i] = dist(rng);
+    for (size_t i = 0; i < W.size(); ++i) W.data()[i] = dist(rng);
+    std::vector<float> Y(M * N);
+
+    // best wall time of one call, microseconds
+    auto latency = [&](auto&& call) {
+        call();
+        double best = 1e300;
+        for (size_t r = 0; r < cfg.reps; ++r) {
+            auto t0 = std::chrono::steady_clock::now();
+            call();
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        return best;
+    };
+
+    const double dense_mm = latency([&] { tiled_matmul(X, W, pool); });
+    const PackedB<float> packed = PackedB<float>::pack(W.data(), N, K, N);
+    const double dense = latency([&] { gemm_packed(X.data(), K, M, packed, Y.data(), N, (const float*)nullptr, Activation::IDENTITY, &pool); });
+
+    std::printf("%-22s %10s %10s %10s   (batch = %zu, dim = %zu)\n", "", "density", "us", "speedup", M, K);
+    std::printf("%-22s %10.3f %10.1f %10.2f\n", "dense tiled_matmul", 1.0, dense_mm, dense / dense_mm);
+    std::printf("%-22s %10.3f %10.1f %10.2f\n", "dense gemm_packed", 1.0, dense, 1.0);
+
+    auto row = [&](const std::string& name, NTensor<float>& pruned, const auto& sparse) {
+        double nnz = 0;
+        for (size_t i = 0; i < pruned.size(); ++i) nnz += pruned.data()[i] != 0.0f;
+        const double us = latency([&] { sparse_matmul(X.data(), K, M, sparse, Y.data(), N, (const float*)nullptr, Activation::IDENTITY, &pool); });
+        std::printf("%-22s %10.3f %10.1f %10.2f\n", name.c_str(), nnz / (double)pruned.size(), us, dense / us);
+    };
+
+    for (double s : {0.5, 0.8, 0.9, 0.95}) {
+        NTensor<float> Wp = W;
+        SparseCSR<float> csr = prune_csr(Wp, s);
+        row("csr " + std::to_string((int)std::lround(s * 100)) + "%", Wp, csr);
+    }
+    {
+        NTensor<float> Wp = W;
+        SparseNM<float> nm = prune_nm(Wp, 2, 4);
+        row("2:4", Wp, nm);
+    }
+    for (double s : {0.5, 0.75, 0.9}) {
+        NTensor<float> Wp = W;
+        BlockSparse<float> blocks = prune_blocks(Wp, s, 4);
+        row("block 4x16 " + std::to_string((int)std::lround(s * 100)) + "%", Wp, blocks);
+    }
+}
+
+static void usage() {
+    _log::log_fatal(
+        "Usage: intel-ml-bench vmath [--n N] [--reps N]\n"
+        "       intel-ml-bench sparse [--batch N] [--dim N] [--reps N]"
+    );
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) usage();
+
+    std::string what = argv[1];
+    BenchConfig cfg;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) usage();
+
+        const char* val = argv[++i];
+        if      (arg == "--n")    cfg.n = std::strtoull(val, nullptr, 10);
+        else if (arg == "--reps") cfg.reps = std::strtoull(val, nullptr, 10);
+        else if (arg == "--batch") cfg.batch = std::strtoull(val, nullptr, 10);
+        else if (arg == "--dim")  cfg.dim = std::strtoull(val, nullptr, 10);
+        else usage();
+    }
+
+    if (cfg.n == 0 || cfg.reps == 0 || cfg.batch == 0 || cfg.dim == 0) usage();
+
+    if (what == "vmath") bench_vmath(cfg);
+    else if (what == "sparse") bench_sparse(cfg);
+    else usage();
+
+    return 0;
+}
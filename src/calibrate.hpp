@@ -0,0 +1,306 @@
+#ifndef CALIBRATE_HPP
+#define CALIBRATE_HPP
+
+#include <nn/sequential.hpp>
+#include <quantize.hpp>
+#include <relayout.hpp>
+#include <serialize.hpp>
+#include <vmath.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Post-training quantization calibration.
+ *
+ * calibrate() runs sample batches through a Sequential and watches the input
+ * of every DENSE / CONV2D layer with a RangeObserver:
+ *
+ *   pass 1   per-channel min / max and the per-tensor |x| maximum
+ *   pass 2   a histogram of |x| over [0, max] (PERCENTILE and ENTROPY only)
+ *
+ * and picks each input's clipping threshold from them:
+ *
+ *   MINMAX      the largest |x| seen
+ *   PERCENTILE  the given percentile of |x|
+ *   ENTROPY     the threshold whose 128-level quantization of the histogram
+ *               has the smallest KL divergence from the unclipped histogram
+ *
+ * save_quantized() writes the calibrated model as a weights file ready for
+ * the int8 path (nn::QuantizedDense::from_blobs): per layer "<name>.weight"
+ * int8 with a per-output-channel "<name>.weight_scale", float "<name>.bias",
+ * "<name>.input_scale", the observed "<name>.input_min" / "<name>.input_max"
+ * per channel, and "<name>.activation"; affine layers keep float
+ * "<name>.scale" / "<name>.offset".
+ */
+enum class CalibMethod { MINMAX, PERCENTILE, ENTROPY };
+
+typedef struct CalibConfig {
+    CalibMethod method = CalibMethod::ENTROPY;
+    double percentile = 99.99;
+    size_t bins = 2048;                 // histogram resolution over [0, max |x|]
+    bool per_channel_weights = true;    // false: one scale for a whole weight tensor
+} CalibConfig;
+
+typedef struct LayerCalibration {
+    std::string name;
+    float input_amax = 0.0f;            // clipping threshold
+    float input_scale = 1.0f;           // int8_scale(input_amax)
+    std::vector<float> channel_min, channel_max;
+} LayerCalibration;
+
+namespace _calibrate {
+
+// fn(channel, pointer, count, stride) over every channel run of a 2-D [rows x C] or 4-D activation
+template<typename F>
+void for_channels(NTensor<float>& x, F&& fn) {
+    if (x.ndim() == 2) {
+        const size_t R = x.shape()[0], C = x.shape()[1];
+        for (size_t k = 0; k < C; ++k) fn(k, x.data() + k, R, C);
+        return;
+    }
+
+    auto [N, C, H, W] = nchw_dims(x);
+    ActView<float> v = ActView<float>::of(x.data(), N, C, H, W, x.layout());
+    for (size_t n = 0; n < N; ++n)
+        for (size_t k = 0; k < C; ++k) fn(k, v.chan(n, k), H * W, v.b);
+}
+
+inline size_t channels(NTensor<float>& x) {
+    return x.ndim() == 2 ? x.shape()[1] : nchw_dims(x)[1];
+}
+
+inline float entropy_threshold(const std::vector<uint64_t>& hist, float width) {
+    /*
+     * For each candidate i, P is hist[0, i) with everything beyond folded
+     * into its last bin; Q is hist[0, i) merged into 128 levels and spread
+     * back over the bins that were non-zero. The best i minimises KL(P || Q).
+     */
+    const size_t levels = (size_t)QINT8_MAX + 1, bins = hist.size();
+    if (bins <= levels) return width * (float)bins;
+
+    double total = 0.0;
+    for (uint64_t h : hist) total += (double)h;
+    if (total == 0.0) return 0.0f;
+
+    std::vector<double> P(bins), Q(bins);
+    double best = std::numeric_limits<double>::infinity();
+    size_t best_i = bins;
+
+    double tail = 0.0;
+    for (size_t i = levels; i < bins; ++i) tail += (double)hist[i];
+
+    for (size_t i = levels; i <= bins; ++i) {
+        for (size_t k = 0; k < i; ++k) P[k] = (double)hist[k];
+        P[i - 1] += tail;
+
+        for (size_t j = 0; j < levels; ++j) {
+            const size_t b0 = j * i / levels, b1 = (j + 1) * i / levels;
+            double sum = 0.0;
+            size_t nonzero = 0;
+            for (size_t k = b0; k < b1; ++k) {
+                sum += (double)hist[k];
+                nonzero += hist[k] != 0;
+            }
+            for (size_t k = b0; k < b1; ++k) Q[k] = hist[k] && nonzero ? sum / (double)nonzero : 0.0;
+        }
+
+        double ps = 0.0, qs = 0.0;
+        for (size_t k = 0; k < i; ++k) ps += P[k], qs += Q[k];
+
+        double kl = 0.0;
+        for (size_t k = 0; k < i && qs > 0.0; ++k) {
+            if (P[k] == 0.0) continue;
+            const double p = P[k] / ps, q = Q[k] > 0.0 ? Q[k] / qs : 1e-12;
+            kl += p * std::log(p / q);
+        }
+        if (qs > 0.0 && kl < best) best = kl, best_i = i;
+
+        if (i < bins) tail -= (double)hist[i];
+    }
+
+    return ((float)best_i + 0.5f) * width;
+}
+
+} // namespace _calibrate
+
+class RangeObserver {
+public:
+    void observe(NTensor<float>& x) {
+        /**
+         * @brief Pass 1: fold x into the per-channel min / max and per-tensor |x| maximum
+        */
+        const size_t C = _calibrate::channels(x);
+        if (min_.empty()) {
+            min_.assign(C, std::numeric_limits<float>::infinity());
+            max_.assign(C, -std::numeric_limits<float>::infinity());
+        }
+        if (C != min_.size()) throw std::runtime_error("RangeObserver: channel count changed between batches");
+
+        amax_ = std::max(amax_, vreduce_absmax(x.data(), x.size()));
+        _calibrate::for_channels(x, [&](size_t k, const float* p, size_t n, size_t stride) {
+            float lo = min_[k], hi = max_[k];
+            for (size_t i = 0; i < n; ++i) {
+                lo = std::min(lo, p[i * stride]);
+                hi = std::max(hi, p[i * stride]);
+            }
+            min_[k] = lo;
+            max_[k] = hi;
+        });
+    }
+
+    void observe_histogram(NTensor<float>& x, size_t bins) {
+        /**
+         * @brief Pass 2: histogram |x| over [0, max |x| of pass 1]
+         *
+         * Exact zeros (e.g. everything ReLU clamped) quantize without error and
+         * are left out; counted, their spike in bin 0 drags the ENTROPY
+         * threshold far too low.
+        */
+        if (hist_.empty()) hist_.assign(bins, 0);
+
+        const float width = bin_width();
+        const float inv = width > 0.0f ? 1.0f / width : 0.0f;
+        _calibrate::for_channels(x, [&](size_t, const float* p, size_t n, size_t stride) {
+            for (size_t i = 0; i < n; ++i) {
+                const float a = std::fabs(p[i * stride]);
+                if (a == 0.0f) continue;
+                ++hist_[std::min((size_t)(a * inv), hist_.size() - 1)];
+            }
+        });
+    }
+
+    float threshold(const CalibConfig& cfg) const {
+        /**
+         * @brief Clipping threshold for cfg.method (see the top of this file)
+        */
+        if (cfg.method == CalibMethod::MINMAX || hist_.empty() || amax_ == 0.0f) return amax_;
+
+        if (cfg.method == CalibMethod::PERCENTILE) {
+            uint64_t total = 0;
+            for (uint64_t h : hist_) total += h;
+
+            const double want = cfg.percentile / 100.0 * (double)total;
+            uint64_t seen = 0;
+            for (size_t b = 0; b < hist_.size(); ++b) {
+                seen += hist_[b];
+                if ((double)seen >= want) return std::min(amax_, (float)(b + 1) * bin_width());
+            }
+            return amax_;
+        }
+
+        return std::min(amax_, _calibrate::entropy_threshold(hist_, bin_width()));
+    }
+
+    float amax() const { return amax_; }
+    const std::vector<float>& channel_min() const { return min_; }
+    const std::vector<float>& channel_max() const { return max_; }
+
+private:
+    float bin_width() const { return hist_.empty() ? 0.0f : amax_ / (float)hist_.size(); }
+
+    std::vector<float> min_, max_;
+    float amax_ = 0.0f;
+    std::vector<uint64_t> hist_;
+};
+
+inline std::vector<LayerCalibration> calibrate(nn::Sequential<float>& model, std::vector<NTensor<float>>& samples,
+                                               CalibConfig cfg = {}, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Observe every DENSE / CONV2D input over the sample batches and pick its scale
+     *
+     * @param (std::vector<NTensor<float>>) samples: calibration batches, as passed to model.forward()
+     *
+     * @return (std::vector<LayerCalibration>) one entry per model layer; non-GEMM layers keep defaults
+    */
+    using Op = nn::Sequential<float>::Op;
+    if (samples.empty()) throw std::runtime_error("calibrate: no sample batches");
+
+    auto& layers = model.layers();
+    std::vector<RangeObserver> obs(layers.size());
+    auto gemm_layer = [&](size_t i) { return layers[i].op == Op::DENSE || layers[i].op == Op::CONV2D; };
+
+    for (NTensor<float>& x : samples) {
+        model.forward(x, pool, [&](size_t i, NTensor<float>& in) { if (gemm_layer(i)) obs[i].observe(in); });
+    }
+    if (cfg.method != CalibMethod::MINMAX) {
+        for (NTensor<float>& x : samples) {
+            model.forward(x, pool, [&](size_t i, NTensor<float>& in) {
+                if (gemm_layer(i)) obs[i].observe_histogram(in, cfg.bins);
+            });
+        }
+    }
+
+    std::vector<LayerCalibration> out(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        out[i].name = layers[i].name;
+        if (!gemm_layer(i)) continue;
+
+        out[i].input_amax = obs[i].threshold(cfg);
+        out[i].input_scale = int8_scale(out[i].input_amax);
+        out[i].channel_min = obs[i].channel_min();
+        out[i].channel_max = obs[i].channel_max();
+    }
+    return out;
+}
+
+inline void save_quantized(const std::string& path, nn::Sequential<float>& model,
+                           const std::vector<LayerCalibration>& calib, CalibConfig cfg = {}) {
+    /**
+     * @brief Write the calibrated model as a mixed int8 / float weights file (see the top of this file)
+    */
+    using Op = nn::Sequential<float>::Op;
+    auto& layers = model.layers();
+    if (calib.size() != layers.size()) throw std::runtime_error("save_quantized: calibration does not match the model");
+
+    std::map<std::string, TensorBlob> blobs;
+    auto put_floats = [&](const std::string& key, const std::vector<float>& v) {
+        blobs[key] = TensorBlob::of<float>({v.size()}, v.data());
+    };
+
+    for (size_t i = 0; i < layers.size(); ++i) {
+        auto& l = layers[i];
+        const int32_t act = (int32_t)l.act;
+        blobs[l.name + ".activation"] = TensorBlob::of<int32_t>({1}, &act);
+
+        if (l.op == Op::AFFINE) {
+            put_floats(l.name + ".scale", l.w);
+            put_floats(l.name + ".offset", l.b);
+        }
+        if (l.op != Op::DENSE && l.op != Op::CONV2D) continue;
+
+        // per output channel: column k of a Dense [in x out], filter k of a conv [K x C/g x R x S]
+        const size_t K = l.outputs(), n = l.w.size();
+        auto index = [&](size_t k, size_t j) { return l.op == Op::DENSE ? j * K + k : k * (n / K) + j; };
+
+        std::vector<float> scale(K, 0.0f);
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < n / K; ++j) scale[k] = std::max(scale[k], std::fabs(l.w[index(k, j)]));
+        if (!cfg.per_channel_weights) std::fill(scale.begin(), scale.end(), *std::max_element(scale.begin(), scale.end()));
+        for (float& s : scale) s = int8_scale(s);
+
+        std::vector<int8_t> q(n);
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t j = 0; j < n / K; ++j) {
+                const size_t e = index(k, j);
+                quantize_int8(&l.w[e], &q[e], 1, scale[k]);
+            }
+        }
+
+        blobs[l.name + ".weight"] = TensorBlob::of<int8_t>(l.shape, q.data());
+        put_floats(l.name + ".weight_scale", scale);
+        put_floats(l.name + ".bias", l.b);
+        put_floats(l.name + ".input_scale", {calib[i].input_scale});
+        put_floats(l.name + ".input_min", calib[i].channel_min);
+        put_floats(l.name + ".input_max", calib[i].channel_max);
+    }
+
+    save_blobs(path, blobs);
+}
+
+#endif // CALIBRATE_HPP
@@ -0,0 +1,91 @@
+#ifndef CANCEL_HPP
+#define CANCEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+class OperationCancelled : public std::runtime_error {
+public:
+    explicit OperationCancelled(const std::string& what)
+        : std::runtime_error(what)
+    {}
+};
+
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /*
+     * A default-constructed token is never cancelled and costs a null check
+     * per poll. Copies share state, so cancelling any copy cancels them all.
+     */
+    CancellationToken() = default;
+
+    static CancellationToken make() {
+        CancellationToken tok;
+        tok.state_ = std::make_shared<State>();
+        return tok;
+    }
+
+    template<typename Rep, typename Period>
+    static CancellationToken with_budget(std::chrono::duration<Rep, Period> budget) {
+        /**
+         * @brief Create a token that trips by itself once `budget` has elapsed
+         *
+         * @param (std::chrono::duration) budget: wall time allowed from now
+        */
+        CancellationToken tok = make();
+        tok.state_->deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(budget);
+        return tok;
+    }
+
+    void cancel() const {
+        if (state_) state_->cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    bool cancelled() const {
+        if (!state_) return false;
+        if (state_->cancelled.load(std::memory_order_relaxed)) return true;
+
+        if (state_->deadline != Clock::time_point::max() && Clock::now() >= state_->deadline) {
+            state_->cancelled.store(true, std::memory_order_relaxed);
+            state_->expired.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    void throw_if_cancelled() const {
+        /**
+         * @brief Poll point for long-running ops; throws OperationCancelled once tripped
+         *
+         * Ops call this at tile and recursion boundaries so unwinding releases
+         * their temporaries through the usual destructors.
+        */
+        if (!cancelled()) return;
+
+        if (state_->expired.load(std::memory_order_relaxed)) {
+            throw OperationCancelled("operation exceeded its time budget");
+        }
+        throw OperationCancelled("operation cancelled");
+    }
+
+    bool expired() const {
+        return state_ && state_->expired.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> expired{false};
+        Clock::time_point deadline = Clock::time_point::max();
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+#endif // CANCEL_HPP
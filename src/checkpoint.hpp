@@ -0,0 +1,250 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <autograd.hpp>
+#include <log.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/*
+ * Automatic gradient checkpointing for a chain of layers y = f_n(...f_1(x)).
+ *
+ * Memory model (bytes of tape arena, values + gradients):
+ *     kept layer i          2 * a_i for the whole step
+ *     checkpointed segment  2 * out for the whole step, plus 2 * sum(a_i)
+ *                           transiently while it is recomputed in backward
+ *     peak = sum(kept) + max(transient)
+ * where a_i is everything layer i records (measured by a profiling pass).
+ * The planner packs layers into checkpointed segments minimising the peak,
+ * then stops checkpointing the layers with the most compute per byte while
+ * the peak still fits the budget, so no work is recomputed needlessly.
+ */
+typedef struct CheckpointPlan {
+    std::vector<long> segment;  // per layer: -1 = activations kept, otherwise checkpoint segment id
+    size_t peak_bytes = 0;      // modelled peak with this plan
+    size_t full_bytes = 0;      // modelled peak without checkpointing
+    size_t recomputed = 0;      // layers run twice per step
+    bool fits = false;
+} CheckpointPlan;
+
+typedef struct LayerCost {
+    size_t bytes = 0;           // arena bytes recorded by the layer
+    size_t out_bytes = 0;       // size of its output
+    double seconds = 0.0;       // forward time
+} LayerCost;
+
+template<typename T = float>
+class CheckpointedSequence {
+public:
+    using Layer = typename Tape<T>::Segment;
+
+    void add(Layer layer) {
+        layers_.push_back(std::move(layer));
+        plan_rows_ = 0;
+    }
+
+    std::vector<LayerCost> profile(Var<T> x, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @brief Measure each layer's recorded bytes, output size and forward time
+         *
+         * Layers are run one at a time on a scratch tape, so profiling itself
+         * needs only one layer's worth of memory.
+         *
+         * @param (Var<T>) x: a representative input (the batch size matters)
+        */
+        std::vector<LayerCost> costs(layers_.size());
+        std::vector<T> cur(x.value(), x.value() + x.size());
+        size_t rows = x.rows(), cols = x.cols();
+
+        Tape<T> tape(pool);
+        for (size_t i = 0; i < layers_.size(); ++i) {
+            tape.reset();
+            Var<T> xi = tape.input(cur.data(), rows, cols, true);
+            size_t before = tape.arena().used();
+
+            auto t0 = std::chrono::steady_clock::now();
+            Var<T> y = layers_[i](tape, xi);
+            costs[i].seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            costs[i].bytes = tape.arena().used() - before;
+            costs[i].out_bytes = y.size() * sizeof(T);
+
+            cur.assign(y.value(), y.value() + y.size());
+            rows = y.rows();
+            cols = y.cols();
+        }
+
+        return costs;
+    }
+
+    static CheckpointPlan plan(const std::vector<LayerCost>& costs, size_t budget_bytes) {
+        /**
+         * @brief Choose which layers to checkpoint so the modelled peak fits budget_bytes
+         *
+         * @return (CheckpointPlan) fits = false when even the tightest plan is over budget
+        */
+        const size_t n = costs.size();
+        CheckpointPlan best;
+        best.segment.assign(n, -1);
+
+        for (const LayerCost& c : costs) best.full_bytes += 2 * c.bytes;
+        best.peak_bytes = best.full_bytes;
+        if (best.full_bytes <= budget_bytes || n == 0) {
+            best.fits = true;
+            return best;
+        }
+
+        // every contiguous window is a candidate bound on one segment's transient memory
+        std::vector<size_t> caps;
+        for (size_t l = 0; l < n; ++l) {
+            size_t w = 0;
+            for (size_t r = l; r < n; ++r) {
+                w += 2 * costs[r].bytes;
+                caps.push_back(w);
+            }
+        }
+        std::sort(caps.begin(), caps.end());
+        caps.erase(std::unique(caps.begin(), caps.end()), caps.end());
+
+        for (size_t cap : caps) {
+            std::vector<long> seg(n);
+            long id = 0;
+            size_t w = 0;
+            for (size_t i = 0; i < n; ++i) {
+                if (w > 0 && w + 2 * costs[i].bytes > cap) {
+                    ++id;
+                    w = 0;
+                }
+                seg[i] = id;
+                w += 2 * costs[i].bytes;
+            }
+
+            size_t peak = peak_bytes(costs, seg);
+            if (peak < best.peak_bytes) {
+                best.segment = seg;
+                best.peak_bytes = peak;
+            }
+        }
+
+        if (best.peak_bytes > budget_bytes) {
+            finish(best, budget_bytes);
+            return best;
+        }
+
+        // keep the layers that are most expensive to recompute per byte they hold
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return costs[a].seconds * (double)(costs[b].bytes + 1) > costs[b].seconds * (double)(costs[a].bytes + 1);
+        });
+
+        for (size_t i : order) {
+            long prev = best.segment[i];
+            best.segment[i] = -1;
+
+            size_t peak = peak_bytes(costs, best.segment);
+            if (peak <= budget_bytes) best.peak_bytes = peak;
+            else best.segment[i] = prev;
+        }
+
+        finish(best, budget_bytes);
+        return best;
+    }
+
+    Var<T> forward(Tape<T>& tape, Var<T> x, size_t budget_bytes) {
+        /**
+         * @brief Run the chain on tape, checkpointing per a plan for this input's batch size
+         *
+         * The first call for a given number of rows profiles the layers and
+         * plans; later calls with the same rows reuse the plan.
+         *
+         * @param (size_t) budget_bytes: target peak of activation + gradient bytes on the tape
+        */
+        if (plan_rows_ != x.rows() || plan_budget_ != budget_bytes) {
+            plan_ = plan(profile(x), budget_bytes);
+            plan_rows_ = x.rows();
+            plan_budget_ = budget_bytes;
+
+            if (!plan_.fits) {
+                _log::log_message(_log::WARN, "checkpoint: best plan needs %zu bytes, budget is %zu",
+                                  plan_.peak_bytes, budget_bytes);
+            }
+        }
+
+        return run(tape, x, plan_);
+    }
+
+    Var<T> run(Tape<T>& tape, Var<T> x, const CheckpointPlan& p) {
+        Var<T> y = x;
+        for (size_t l = 0; l < layers_.size();) {
+            if (p.segment[l] < 0) {
+                y = layers_[l](tape, y);
+                ++l;
+                continue;
+            }
+
+            size_t r = l + 1;
+            while (r < layers_.size() && p.segment[r] == p.segment[l]) ++r;
+
+            y = tape.checkpoint([this, l, r](Tape<T>& t, Var<T> v) {
+                for (size_t i = l; i < r; ++i) v = layers_[i](t, v);
+                return v;
+            }, y);
+            l = r;
+        }
+
+        return y;
+    }
+
+    const CheckpointPlan& current_plan() const { return plan_; }
+    size_t size() const { return layers_.size(); }
+
+private:
+    std::vector<Layer> layers_;
+
+    CheckpointPlan plan_;
+    size_t plan_rows_ = 0;
+    size_t plan_budget_ = 0;
+
+    static size_t peak_bytes(const std::vector<LayerCost>& costs, const std::vector<long>& seg) {
+        size_t kept = 0, transient = 0;
+
+        for (size_t l = 0; l < seg.size();) {
+            if (seg[l] < 0) {
+                kept += 2 * costs[l].bytes;
+                ++l;
+                continue;
+            }
+
+            size_t r = l, w = 0;
+            while (r < seg.size() && seg[r] == seg[l]) w += 2 * costs[r++].bytes;
+
+            kept += 2 * costs[r - 1].out_bytes;
+            transient = std::max(transient, w);
+            l = r;
+        }
+
+        return kept + transient;
+    }
+
+    static void finish(CheckpointPlan& p, size_t budget_bytes) {
+        // renumber so each contiguous checkpointed run has its own id
+        long prev_src = -2, prev_id = -1;
+        for (size_t i = 0; i < p.segment.size(); ++i) {
+            long src = p.segment[i];
+            if (src < 0) {
+                prev_src = -2;
+                continue;
+            }
+            p.segment[i] = (src == prev_src) ? prev_id : ++prev_id;
+            prev_src = src;
+            p.recomputed += 1;
+        }
+
+        p.fits = p.peak_bytes <= budget_bytes;
+    }
+};
+
+#endif // CHECKPOINT_HPP
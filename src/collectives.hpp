@@ -0,0 +1,375 @@
+#ifndef COLLECTIVES_HPP
+#define COLLECTIVES_HPP
+
+#include <distributed.hpp>
+#include <transport.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Collectives over a Transport.
+ *
+ * Every rank must call the same collectives in the same order with the same
+ * element counts. Buffers are split into chunks of CollectiveOptions::chunk
+ * elements. A rank forwards chunk i with isend while it receives and reduces
+ * chunk i+1, so transfer and reduction overlap.
+ *
+ * Ring variants move 2 (W-1)/W of the buffer per rank regardless of world size
+ * (bandwidth-optimal); tree variants take log2(W) hops (latency-optimal for
+ * small buffers).
+ */
+enum class ReduceOp { SUM, AVG, MAX, MIN };
+enum class AllReduceAlgo { RING, TREE };
+
+typedef struct CollectiveOptions {
+    ReduceOp op = ReduceOp::SUM;
+    AllReduceAlgo algo = AllReduceAlgo::RING;
+    size_t chunk = 1 << 16; // elements per pipelined message
+} CollectiveOptions;
+
+namespace _collectives {
+
+template<typename T>
+void combine(T* dst, const T* src, size_t n, ReduceOp op) {
+    switch (op) {
+    case ReduceOp::SUM:
+    case ReduceOp::AVG:
+        for (size_t i = 0; i < n; ++i) dst[i] += src[i];
+        break;
+    case ReduceOp::MAX:
+        for (size_t i = 0; i < n; ++i) dst[i] = std::max(dst[i], src[i]);
+        break;
+    case ReduceOp::MIN:
+        for (size_t i = 0; i < n; ++i) dst[i] = std::min(dst[i], src[i]);
+        break;
+    }
+}
+
+template<typename T>
+void finish(T* buf, size_t n, size_t world, ReduceOp op) {
+    if (op != ReduceOp::AVG) return;
+    const T inv = (T)1 / (T)world;
+    for (size_t i = 0; i < n; ++i) buf[i] *= inv;
+}
+
+inline std::vector<size_t> even_counts(size_t n, size_t world) {
+    std::vector<size_t> counts(world);
+    for (size_t r = 0; r < world; ++r) {
+        auto [lo, hi] = block_range(n, world, r);
+        counts[r] = hi - lo;
+    }
+    return counts;
+}
+
+inline std::vector<size_t> offsets(const std::vector<size_t>& counts, size_t world) {
+    if (counts.size() != world) {
+        throw std::runtime_error("collectives: need one segment count per rank");
+    }
+
+    std::vector<size_t> offs(world + 1, 0);
+    for (size_t r = 0; r < world; ++r) offs[r + 1] = offs[r] + counts[r];
+    return offs;
+}
+
+// send `send_n` elements to `dst` while receiving `recv_n` from `src`, chunk by
+// chunk; received chunks are reduced into `recv` if asked, else copied
+template<typename T>
+void ring_step(Transport& tr, size_t dst, size_t src, const T* send, size_t send_n, T* recv, size_t recv_n,
+               const CollectiveOptions& opts, bool reduce, std::vector<T>& scratch) {
+    size_t chunk = std::max<size_t>(opts.chunk, 1);
+    std::vector<std::future<void>> sends;
+
+    for (size_t off = 0; off < send_n; off += chunk) {
+        size_t len = std::min(chunk, send_n - off);
+        sends.push_back(tr.isend(dst, send + off, len * sizeof(T)));
+    }
+
+    scratch.resize(std::min(chunk, recv_n));
+    for (size_t off = 0; off < recv_n; off += chunk) {
+        size_t len = std::min(chunk, recv_n - off);
+        if (reduce) {
+            tr.recv(src, scratch.data(), len * sizeof(T));
+            combine(recv + off, scratch.data(), len, opts.op);
+        } else {
+            tr.recv(src, recv + off, len * sizeof(T));
+        }
+    }
+
+    for (std::future<void>& f : sends) f.get();
+}
+
+} // namespace _collectives
+
+template<typename T>
+void reduce_scatter_v(T* buf, const std::vector<size_t>& counts, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Ring reduce-scatter over explicit segments: afterwards rank r holds the
+     *        reduced counts[r] elements that follow counts[0..r)
+     *
+     * Other segments of buf are left holding partial sums.
+     *
+     * @param (T*) buf: sum(counts) elements, reduced in place
+     * @param (std::vector<size_t>) counts: segment length per rank
+     * @param (Transport) tr: job transport
+     * @param (CollectiveOptions) opts: reduction op and chunk size
+    */
+    const size_t W = tr.size(), r = tr.rank();
+    std::vector<size_t> offs = _collectives::offsets(counts, W);
+
+    if (W > 1) {
+        const size_t next = (r + 1) % W, prev = (r + W - 1) % W;
+        std::vector<T> scratch;
+
+        // in step s, send the segment accumulated so far and fold in the one from prev;
+        // after W-1 steps segment r has visited every rank
+        for (size_t s = 0; s + 1 < W; ++s) {
+            size_t send_seg = (r + W - s - 1) % W;
+            size_t recv_seg = (r + W - s - 2) % W;
+
+            _collectives::ring_step(tr, next, prev, buf + offs[send_seg], counts[send_seg],
+                                    buf + offs[recv_seg], counts[recv_seg], opts, true, scratch);
+        }
+    }
+
+    _collectives::finish(buf + offs[r], counts[r], W, opts.op);
+}
+
+template<typename T>
+void reduce_scatter(T* buf, size_t n, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Ring reduce-scatter: afterwards rank r holds the reduced block_range(n, W, r)
+    */
+    reduce_scatter_v(buf, _collectives::even_counts(n, tr.size()), tr, opts);
+}
+
+template<typename T>
+void all_gather_v(T* buf, const std::vector<size_t>& counts, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Ring all-gather over explicit segments: rank r contributes the counts[r]
+     *        elements that follow counts[0..r), every rank ends with all of buf
+    */
+    const size_t W = tr.size(), r = tr.rank();
+    if (W == 1) return;
+
+    std::vector<size_t> offs = _collectives::offsets(counts, W);
+    const size_t next = (r + 1) % W, prev = (r + W - 1) % W;
+    std::vector<T> scratch;
+
+    for (size_t s = 0; s + 1 < W; ++s) {
+        size_t send_seg = (r + W - s) % W;
+        size_t recv_seg = (r + W - s - 1) % W;
+
+        _collectives::ring_step(tr, next, prev, buf + offs[send_seg], counts[send_seg],
+                                buf + offs[recv_seg], counts[recv_seg], opts, false, scratch);
+    }
+}
+
+template<typename T>
+void all_gather(T* buf, size_t n, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Ring all-gather: rank r contributes block_range(n, W, r), every rank ends with all of buf
+    */
+    all_gather_v(buf, _collectives::even_counts(n, tr.size()), tr, opts);
+}
+
+template<typename T>
+void broadcast(T* buf, size_t n, size_t root, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Pipelined chain broadcast from root
+     *
+     * Ranks form a chain starting at root; each rank forwards chunk i to its
+     * successor before receiving chunk i+1, so for large buffers the cost
+     * approaches a single transfer regardless of world size.
+    */
+    const size_t W = tr.size(), r = tr.rank();
+    if (W == 1) return;
+
+    const size_t pos = (r + W - root) % W;
+    const size_t prev = (r + W - 1) % W, next = (r + 1) % W;
+    const size_t chunk = std::max<size_t>(opts.chunk, 1);
+
+    std::vector<std::future<void>> sends;
+    for (size_t off = 0; off < n; off += chunk) {
+        size_t len = std::min(chunk, n - off);
+        if (pos != 0) tr.recv(prev, buf + off, len * sizeof(T));
+        if (pos + 1 < W) sends.push_back(tr.isend(next, buf + off, len * sizeof(T)));
+    }
+
+    for (std::future<void>& f : sends) f.get();
+}
+
+template<typename T>
+void all_reduce(T* buf, size_t n, Transport& tr, const CollectiveOptions& opts = {}) {
+    /**
+     * @brief Reduce buf across every rank, leaving the result on all of them
+     *
+     * RING = reduce-scatter + all-gather. TREE = binomial-tree reduce to rank 0
+     * followed by the mirrored tree broadcast, pipelined chunk by chunk.
+     *
+     * @param (T*) buf: n elements, reduced in place
+     * @param (Transport) tr: job transport
+     * @param (CollectiveOptions) opts: op, algorithm and chunk size
+    */
+    const size_t W = tr.size(), r = tr.rank();
+    if (W == 1) {
+        _collectives::finish(buf, n, W, opts.op);
+        return;
+    }
+
+    if (opts.algo == AllReduceAlgo::RING) {
+        reduce_scatter(buf, n, tr, opts);
+        all_gather(buf, n, tr, opts);
+        return;
+    }
+
+    const size_t chunk = std::max<size_t>(opts.chunk, 1);
+    std::vector<T> scratch(std::min(chunk, n));
+    std::vector<std::future<void>> sends;
+
+    // reduce: at level `mask` a rank with that bit set hands its partial to r - mask
+    for (size_t off = 0; off < n; off += chunk) {
+        size_t len = std::min(chunk, n - off);
+
+        for (size_t mask = 1; mask < W; mask <<= 1) {
+            if (r & mask) {
+                sends.push_back(tr.isend(r - mask, buf + off, len * sizeof(T)));
+                break;
+            }
+            if (r + mask < W) {
+                tr.recv(r + mask, scratch.data(), len * sizeof(T));
+                _collectives::combine(buf + off, scratch.data(), len, opts.op);
+            }
+        }
+    }
+    for (std::future<void>& f : sends) f.get();
+    sends.clear();
+
+    if (r == 0) _collectives::finish(buf, n, W, opts.op);
+
+    // broadcast back down the same tree
+    size_t top = 1;
+    while (top < W) top <<= 1;
+
+    for (size_t off = 0; off < n; off += chunk) {
+        size_t len = std::min(chunk, n - off);
+
+        for (size_t mask = top >> 1; mask > 0; mask >>= 1) {
+            if (r & (2 * mask - 1)) {
+                if ((r & (2 * mask - 1)) == mask) tr.recv(r - mask, buf + off, len * sizeof(T));
+            } else if (r + mask < W) {
+                sends.push_back(tr.isend(r + mask, buf + off, len * sizeof(T)));
+            }
+        }
+    }
+    for (std::future<void>& f : sends) f.get();
+}
+
+template<typename T>
+void all_reduce(NTensor<T>& t, Transport& tr, const CollectiveOptions& opts = {}) {
+    all_reduce(t.data(), t.size(), tr, opts);
+}
+
+template<typename T>
+void broadcast(NTensor<T>& t, size_t root, Transport& tr, const CollectiveOptions& opts = {}) {
+    broadcast(t.data(), t.size(), root, tr, opts);
+}
+
+template<typename T>
+void reduce_scatter(NTensor<T>& t, Transport& tr, const CollectiveOptions& opts = {}) {
+    reduce_scatter(t.data(), t.size(), tr, opts);
+}
+
+template<typename T>
+void all_gather(NTensor<T>& t, Transport& tr, const CollectiveOptions& opts = {}) {
+    all_gather(t.data(), t.size(), tr, opts);
+}
+
+class CollectiveStream {
+public:
+    explicit CollectiveStream(Transport& tr)
+        : tr_(tr)
+    {
+        /**
+         * @brief Runs collectives on a background thread, in issue order
+         *
+         * Lets training all-reduce gradient buckets while backward is still
+         * producing the next ones. Every rank must issue the same sequence.
+         * Buffers handed in must stay untouched until their future is ready.
+        */
+        worker_ = std::thread([this] { run(); });
+    }
+
+    CollectiveStream(const CollectiveStream&) = delete;
+    CollectiveStream& operator=(const CollectiveStream&) = delete;
+
+    ~CollectiveStream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+    }
+
+    template<typename T>
+    std::future<void> all_reduce(T* buf, size_t n, CollectiveOptions opts = {}) {
+        return enqueue([this, buf, n, opts] { ::all_reduce(buf, n, tr_, opts); });
+    }
+
+    template<typename T>
+    std::future<void> all_reduce(NTensor<T>& t, CollectiveOptions opts = {}) {
+        return all_reduce(t.data(), t.size(), opts);
+    }
+
+    template<typename T>
+    std::future<void> broadcast(T* buf, size_t n, size_t root, CollectiveOptions opts = {}) {
+        return enqueue([this, buf, n, root, opts] { ::broadcast(buf, n, root, tr_, opts); });
+    }
+
+    void synchronize() {
+        enqueue([] {}).get();
+    }
+
+private:
+    Transport& tr_;
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::packaged_task<void()>> queue_;
+    bool stop_ = false;
+
+    std::future<void> enqueue(std::function<void()> fn) {
+        std::packaged_task<void()> task(std::move(fn));
+        std::future<void> fut = task.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+        return fut;
+    }
+
+    void run() {
+        for (;;) {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+#endif // COLLECTIVES_HPP
@@ -0,0 +1,587 @@
+#ifndef CONV_HPP
+#define CONV_HPP
+
+#include <activation.hpp>
+#include <gemm.hpp>
+#include <relayout.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * 2-D convolution, [N, C, H, W] activations and [K x C/groups x R x S] filters.
+ *
+ *   IMPLICIT_GEMM   Y[k, p] = W[k, (c,r,s)] * col[(c,r,s), p], with the patch
+ *                   matrix built one block of output pixels at a time
+ *                   (CONV_COL_ELEMS), so the full im2col matrix never exists.
+ *   WINOGRAD_2x3 /  F(m x m, 3 x 3): per alpha x alpha input tile, alpha = m + 2,
+ *   WINOGRAD_4x3    Y = A^T [ (G g G^T) . (B^T d B) ] A; the elementwise
+ *                   product over channels becomes alpha^2 GEMMs per tile block.
+ *                   2.25x / 4x fewer multiplies than direct 3x3.
+ *   DEPTHWISE       direct loops over one channel plane, inner loop over
+ *                   output columns with the bounds hoisted so it vectorizes.
+ *
+ * choose_conv_algo() picks one from the layer shape. Every path reads and
+ * writes through ActView, so activations may be NCHW, NHWC or NCHWc and the
+ * output keeps the input's layout: a chain of convolutions stays in whatever
+ * layout it was started in, and preferred_layout() says which one to start
+ * in. Implicit GEMM in NHWC gathers whole channel runs per tap and writes its
+ * GEMM output in place; depthwise in NCHWc/NHWC vectorises across channels.
+ */
+enum class ConvAlgo { AUTO, IMPLICIT_GEMM, WINOGRAD_2x3, WINOGRAD_4x3, DEPTHWISE };
+
+typedef struct Conv2dParams {
+    size_t stride_h = 1, stride_w = 1;
+    size_t pad_h = 0, pad_w = 0;
+    size_t dilation_h = 1, dilation_w = 1;
+    size_t groups = 1;
+} Conv2dParams;
+
+typedef struct ConvShape {
+    size_t N, C, H, W;      // input
+    size_t K, R, S;         // output channels, filter height / width
+    size_t OH, OW;          // output
+
+    static ConvShape of(size_t N, size_t C, size_t H, size_t W, size_t K, size_t R, size_t S, const Conv2dParams& p) {
+        const size_t eff_r = p.dilation_h * (R - 1) + 1, eff_s = p.dilation_w * (S - 1) + 1;
+        if (H + 2 * p.pad_h < eff_r || W + 2 * p.pad_w < eff_s) {
+            throw std::runtime_error("conv2d: filter larger than padded input");
+        }
+        return ConvShape{N, C, H, W, K, R, S,
+                         (H + 2 * p.pad_h - eff_r) / p.stride_h + 1,
+                         (W + 2 * p.pad_w - eff_s) / p.stride_w + 1};
+    }
+} ConvShape;
+
+constexpr size_t CONV_COL_ELEMS = 1 << 16;   // im2col block budget per task
+constexpr size_t CONV_WINO_ELEMS = 1 << 18;  // transformed tile budget per task
+
+inline const char* conv_algo_name(ConvAlgo a) {
+    switch (a) {
+    case ConvAlgo::AUTO:          return "auto";
+    case ConvAlgo::IMPLICIT_GEMM: return "implicit_gemm";
+    case ConvAlgo::WINOGRAD_2x3:  return "winograd_2x3";
+    case ConvAlgo::WINOGRAD_4x3:  return "winograd_4x3";
+    case ConvAlgo::DEPTHWISE:     return "depthwise";
+    }
+    return "?";
+}
+
+template<typename T = float>
+ConvAlgo choose_conv_algo(const ConvShape& s, const Conv2dParams& p) {
+    /**
+     * @brief Pick the convolution algorithm for one layer shape
+     *
+     * Depthwise layers have too little reuse for a GEMM and go direct.
+     * Winograd needs a stride-1, undilated, dense 3x3 with enough channels
+     * that the alpha^2 GEMMs are not dominated by the tile transforms; F(4,3)
+     * is used once the output is large enough for its 4x4 tiles not to waste
+     * much on edges. Everything else is implicit GEMM.
+    */
+    if (p.groups > 1 && p.groups == s.C && s.K % s.C == 0) return ConvAlgo::DEPTHWISE;
+
+    const bool winograd_ok = std::is_floating_point_v<accum_t<T>> && p.groups == 1 &&
+                             s.R == 3 && s.S == 3 && p.stride_h == 1 && p.stride_w == 1 &&
+                             p.dilation_h == 1 && p.dilation_w == 1;
+
+    if (winograd_ok && s.C >= 16 && s.K >= 16) {
+        // 16-bit storage loses too much through F(4,3)'s larger transform constants
+        const bool wide = sizeof(T) >= 4 && s.OH >= 8 && s.OW >= 8;
+        return wide ? ConvAlgo::WINOGRAD_4x3 : ConvAlgo::WINOGRAD_2x3;
+    }
+
+    return ConvAlgo::IMPLICIT_GEMM;
+}
+
+namespace _conv {
+
+template<typename T>
+void epilogue(T* y, size_t n, const T* bias, size_t k, Activation act) {
+    if (bias) {
+        for (size_t i = 0; i < n; ++i) y[i] += bias[k];
+    }
+    activate_inplace(y, n, act);
+}
+
+template<typename T>
+void implicit_gemm(const ActView<const T>& x, const T* Wt, const ActView<T>& y, const ConvShape& s,
+                   const Conv2dParams& p, const T* bias, Activation act, ThreadPool* pool) {
+    /*
+     * Computed transposed, Y^T[p, k] = rows[p, (c,r,s)] * W^T[(c,r,s), k], so the
+     * filters are the packed operand (packed once per call) and bias/activation
+     * run in the GEMM epilogue. Each task builds the patch rows of one block
+     * of output pixels and writes its [pixels x K] result to the output
+     * layout. With NHWC input the patch is gathered tap by tap as runs of Cg
+     * contiguous channels (filters reordered to (r, s, c) to match); with
+     * NHWC output the GEMM writes straight into Y.
+     */
+    const size_t G = p.groups, Cg = s.C / G, Kg = s.K / G;
+    const size_t KK = Cg * s.R * s.S, P = s.OH * s.OW, RS = s.R * s.S;
+    const bool nhwc_in = x.b >= s.C, nhwc_out = y.b >= s.K;
+
+    std::vector<PackedB<T>> packed(G);
+    {
+        std::vector<T> reordered(nhwc_in ? Kg * KK : 0);
+        for (size_t g = 0; g < G; ++g) {
+            const T* wg = Wt + g * Kg * KK;
+            if (nhwc_in) {
+                for (size_t k = 0; k < Kg; ++k)
+                    for (size_t c = 0; c < Cg; ++c)
+                        for (size_t rs = 0; rs < RS; ++rs) reordered[k * KK + rs * Cg + c] = wg[k * KK + c * RS + rs];
+                wg = reordered.data();
+            }
+            packed[g] = PackedB<T>::pack(wg, KK, KK, Kg, true);
+        }
+    }
+
+    const size_t pb = std::clamp<size_t>(CONV_COL_ELEMS / KK, 16, std::max<size_t>(P, 16));
+    const size_t blocks = (P + pb - 1) / pb;
+
+    auto body = [&](size_t lo, size_t hi) {
+        std::vector<T> rows(pb * KK), out(pb * Kg);
+
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t n = t / blocks, p0 = (t % blocks) * pb, w = std::min(pb, P - p0);
+
+            for (size_t g = 0; g < G; ++g) {
+                size_t oh = p0 / s.OW, ow = p0 % s.OW;
+                for (size_t j = 0; j < w; ++j) {
+                    T* row = rows.data() + j * KK;
+                    const long ih0 = (long)(oh * p.stride_h) - (long)p.pad_h;
+                    const long iw0 = (long)(ow * p.stride_w) - (long)p.pad_w;
+
+                    if (nhwc_in) {
+                        const T* xg = x.chan(n, g * Cg);
+                        for (size_t r = 0; r < s.R; ++r) {
+                            const long ih = ih0 + (long)(r * p.dilation_h);
+                            for (size_t q = 0; q < s.S; ++q, row += Cg) {
+                                const long iw = iw0 + (long)(q * p.dilation_w);
+                                if (ih >= 0 && ih < (long)s.H && iw >= 0 && iw < (long)s.W) {
+                                    std::copy(xg + (ih * s.W + iw) * x.b, xg + (ih * s.W + iw) * x.b + Cg, row);
+                                } else {
+                                    std::fill(row, row + Cg, (T)0);
+                                }
+                            }
+                        }
+                    } else {
+                        for (size_t c = 0; c < Cg; ++c) {
+                            const T* xc = x.chan(n, g * Cg + c);
+                            for (size_t r = 0; r < s.R; ++r) {
+                                const long ih = ih0 + (long)(r * p.dilation_h);
+                                const bool row_ok = ih >= 0 && ih < (long)s.H;
+
+                                for (size_t q = 0; q < s.S; ++q) {
+                                    const long iw = iw0 + (long)(q * p.dilation_w);
+                                    *row++ = (row_ok && iw >= 0 && iw < (long)s.W) ? xc[(ih * s.W + iw) * x.b] : (T)0;
+                                }
+                            }
+                        }
+                    }
+
+                    if (++ow == s.OW) { ow = 0; ++oh; }
+                }
+
+                const T* bg = bias ? bias + g * Kg : nullptr;
+                if (nhwc_out) {
+                    gemm_packed(rows.data(), KK, w, packed[g], y.chan(n, g * Kg) + p0 * y.b, y.b, bg, act);
+                    continue;
+                }
+
+                gemm_packed(rows.data(), KK, w, packed[g], out.data(), Kg, bg, act);
+
+                for (size_t k = 0; k < Kg; ++k) {
+                    T* yk = y.chan(n, g * Kg + k) + p0 * y.b;
+                    for (size_t j = 0; j < w; ++j) yk[j * y.b] = out[j * Kg + k];
+                }
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, s.N * blocks, 1, body);
+    else body(0, s.N * blocks);
+}
+
+// Winograd transform matrices (Lavin & Gray), row-major, as compile-time constants of the accumulation type
+template<size_t M> struct Wino;
+
+template<> struct Wino<2> {
+    static constexpr size_t A = 4;
+    template<typename U> static constexpr U BT[4][4] = {{1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+    template<typename U> static constexpr U G[4][3] = {{1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+    template<typename U> static constexpr U AT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+};
+
+template<> struct Wino<4> {
+    static constexpr size_t A = 6;
+    template<typename U> static constexpr U BT[6][6] = {
+        {4, 0, -5, 0, 1, 0}, {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+        {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}};
+    template<typename U> static constexpr U G[6][3] = {
+        {(U)(1.0 / 4), 0, 0}, {(U)(-1.0 / 6), (U)(-1.0 / 6), (U)(-1.0 / 6)}, {(U)(-1.0 / 6), (U)(1.0 / 6), (U)(-1.0 / 6)},
+        {(U)(1.0 / 24), (U)(1.0 / 12), (U)(1.0 / 6)}, {(U)(1.0 / 24), (U)(-1.0 / 12), (U)(1.0 / 6)}, {0, 0, 1}};
+    template<typename U> static constexpr U AT[4][6] = {
+        {1, 1, 1, 1, 1, 0}, {0, 1, -1, 2, -2, 0}, {0, 1, 1, 4, 4, 0}, {0, 1, -1, 8, -8, 1}};
+};
+
+template<size_t M, typename T>
+void winograd(const ActView<const T>& x, const T* Wt, const ActView<T>& y, const ConvShape& s,
+              const Conv2dParams& p, const T* bias, Activation act, ThreadPool* pool) {
+    /*
+     * Per block of tiles: V[e][t][c] = (B^T d B)[e], then for each of the
+     * alpha^2 positions e one GEMM M[e][t][k] = V[e] * U[e]^T against the
+     * packed, transformed filters, then Y = A^T M A per tile.
+     */
+    using Acc = accum_t<T>;
+    using W = Wino<M>;
+    constexpr size_t A = W::A, E = A * A;
+    constexpr auto& BT = W::template BT<Acc>;
+    constexpr auto& Gm = W::template G<Acc>;
+    constexpr auto& AT = W::template AT<Acc>;
+
+    const size_t C = s.C, K = s.K;
+    const size_t th = (s.OH + M - 1) / M, tw = (s.OW + M - 1) / M, tiles = s.N * th * tw;
+
+    // U[e] = (G g G^T)[e] for every (k, c), packed as the [C x K] GEMM operand
+    std::vector<PackedB<T>> U(E);
+    {
+        std::vector<T> u(E * K * C);
+        for (size_t k = 0; k < K; ++k) {
+            for (size_t c = 0; c < C; ++c) {
+                const T* g = Wt + (k * C + c) * 9;
+
+                Acc tmp[A][3];
+                for (size_t i = 0; i < A; ++i)
+                    for (size_t j = 0; j < 3; ++j)
+                        tmp[i][j] = Gm[i][0] * (Acc)g[j] + Gm[i][1] * (Acc)g[3 + j] + Gm[i][2] * (Acc)g[6 + j];
+
+                for (size_t i = 0; i < A; ++i)
+                    for (size_t j = 0; j < A; ++j)
+                        u[((i * A + j) * K + k) * C + c] = (T)(tmp[i][0] * Gm[j][0] + tmp[i][1] * Gm[j][1] + tmp[i][2] * Gm[j][2]);
+            }
+        }
+        for (size_t e = 0; e < E; ++e) U[e] = PackedB<T>::pack(u.data() + e * K * C, C, C, K, true);
+    }
+
+    const size_t tb = std::clamp<size_t>(CONV_WINO_ELEMS / (E * (C + K)), 6, 96);
+    const size_t blocks = (tiles + tb - 1) / tb;
+
+    auto body = [&](size_t lo, size_t hi) {
+        std::vector<T> V(E * tb * C), Mt(E * tb * K);
+
+        for (size_t b = lo; b < hi; ++b) {
+            const size_t t0 = b * tb, nt = std::min(tb, tiles - t0);
+
+            for (size_t t = 0; t < nt; ++t) {
+                const size_t tile = t0 + t, n = tile / (th * tw);
+                const long ih0 = (long)(((tile / tw) % th) * M) - (long)p.pad_h;
+                const long iw0 = (long)((tile % tw) * M) - (long)p.pad_w;
+                const bool interior = ih0 >= 0 && iw0 >= 0 && ih0 + (long)A <= (long)s.H && iw0 + (long)A <= (long)s.W;
+
+                for (size_t c = 0; c < C; ++c) {
+                    const T* xc = x.chan(n, c);
+                    const size_t xb = x.b;
+
+                    Acc d[A][A];
+                    if (interior) {
+                        for (size_t i = 0; i < A; ++i)
+                            for (size_t j = 0; j < A; ++j) d[i][j] = (Acc)xc[((ih0 + (long)i) * (long)s.W + iw0 + (long)j) * xb];
+                    } else {
+                        for (size_t i = 0; i < A; ++i) {
+                            const long ih = ih0 + (long)i;
+                            for (size_t j = 0; j < A; ++j) {
+                                const long iw = iw0 + (long)j;
+                                d[i][j] = (ih >= 0 && ih < (long)s.H && iw >= 0 && iw < (long)s.W) ? (Acc)xc[(ih * s.W + iw) * xb] : (Acc)0;
+                            }
+                        }
+                    }
+
+                    Acc bd[A][A];
+                    for (size_t i = 0; i < A; ++i)
+                        for (size_t j = 0; j < A; ++j) {
+                            Acc v = 0;
+                            for (size_t l = 0; l < A; ++l) v += BT[i][l] * d[l][j];
+                            bd[i][j] = v;
+                        }
+
+                    for (size_t i = 0; i < A; ++i)
+                        for (size_t j = 0; j < A; ++j) {
+                            Acc v = 0;
+                            for (size_t l = 0; l < A; ++l) v += bd[i][l] * BT[j][l];
+                            V[((i * A + j) * tb + t) * C + c] = (T)v;
+                        }
+                }
+            }
+
+            for (size_t e = 0; e < E; ++e) {
+                gemm_packed(V.data() + e * tb * C, C, nt, U[e], Mt.data() + e * tb * K, K);
+            }
+
+            for (size_t t = 0; t < nt; ++t) {
+                const size_t tile = t0 + t, n = tile / (th * tw);
+                const size_t oh0 = ((tile / tw) % th) * M, ow0 = (tile % tw) * M;
+
+                for (size_t k = 0; k < K; ++k) {
+                    Acc am[M][A];
+                    for (size_t i = 0; i < M; ++i)
+                        for (size_t j = 0; j < A; ++j) {
+                            Acc v = 0;
+                            for (size_t l = 0; l < A; ++l) v += AT[i][l] * (Acc)Mt[((l * A + j) * tb + t) * K + k];
+                            am[i][j] = v;
+                        }
+
+                    T* yk = y.chan(n, k);
+                    const Acc bk = bias ? (Acc)bias[k] : (Acc)0;
+                    for (size_t i = 0; i < M && oh0 + i < s.OH; ++i)
+                        for (size_t j = 0; j < M && ow0 + j < s.OW; ++j) {
+                            Acc v = bk;
+                            for (size_t l = 0; l < A; ++l) v += am[i][l] * AT[j][l];
+                            yk[((oh0 + i) * s.OW + ow0 + j) * y.b] = activate((T)v, act);
+                        }
+                }
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, blocks, 1, body);
+    else body(0, blocks);
+}
+
+template<typename T>
+void depthwise(const ActView<const T>& x, const T* Wt, const ActView<T>& y, const ConvShape& s,
+               const Conv2dParams& p, const T* bias, Activation act, ThreadPool* pool) {
+    /*
+     * One output row at a time. For each tap the range of output columns
+     * that reads inside the input is computed up front, so the inner loop
+     * carries no bounds checks. NCHW runs it over columns of one plane;
+     * channel-blocked layouts run it over the b channel lanes of a pixel.
+     */
+    using Acc = accum_t<T>;
+    const size_t mult = s.K / s.C;
+
+    auto ow_range = [&](long off, size_t& lo, size_t& hi) {
+        // valid ow: 0 <= ow * stride + off < W
+        const long last = (long)s.W - 1 - off;
+        if (last < 0) return false;
+        lo = off >= 0 ? 0 : (size_t)((-off + (long)p.stride_w - 1) / (long)p.stride_w);
+        hi = std::min(s.OW, (size_t)(last / (long)p.stride_w) + 1);
+        return lo < hi;
+    };
+
+    if (x.b == 1) {
+        auto body = [&](size_t lo, size_t hi) {
+            std::vector<Acc> acc(s.OW);
+
+            for (size_t t = lo; t < hi; ++t) {
+                const size_t n = t / s.K, k = t % s.K;
+                const T* xc = x.chan(n, k / mult);
+                const T* w = Wt + k * s.R * s.S;
+                T* yk = y.chan(n, k);
+
+                for (size_t oh = 0; oh < s.OH; ++oh) {
+                    std::fill(acc.begin(), acc.end(), (Acc)0);
+
+                    for (size_t r = 0; r < s.R; ++r) {
+                        const long ih = (long)(oh * p.stride_h + r * p.dilation_h) - (long)p.pad_h;
+                        if (ih < 0 || ih >= (long)s.H) continue;
+                        const T* xr = xc + ih * s.W;
+
+                        for (size_t q = 0; q < s.S; ++q) {
+                            const Acc wv = (Acc)w[r * s.S + q];
+                            const long off = (long)(q * p.dilation_w) - (long)p.pad_w;
+                            size_t ow_lo, ow_hi;
+                            if (!ow_range(off, ow_lo, ow_hi)) continue;
+
+                            if (p.stride_w == 1) {
+                                const T* xs = xr + off;
+                                for (size_t ow = ow_lo; ow < ow_hi; ++ow) acc[ow] += wv * (Acc)xs[ow];
+                            } else {
+                                for (size_t ow = ow_lo; ow < ow_hi; ++ow) acc[ow] += wv * (Acc)xr[(long)(ow * p.stride_w) + off];
+                            }
+                        }
+                    }
+
+                    T* yr = yk + oh * s.OW * y.b;
+                    for (size_t ow = 0; ow < s.OW; ++ow) yr[ow * y.b] = (T)acc[ow];
+                }
+
+                if (y.b == 1) {
+                    epilogue(yk, s.OH * s.OW, bias, k, act);
+                } else {
+                    for (size_t i = 0; i < s.OH * s.OW; ++i) {
+                        T v = yk[i * y.b];
+                        yk[i * y.b] = activate(bias ? (T)(v + bias[k]) : v, act);
+                    }
+                }
+            }
+        };
+
+        if (pool) pool->parallel_for(0, s.N * s.K, 1, body);
+        else body(0, s.N * s.K);
+        return;
+    }
+
+    if (mult != 1 || y.b != x.b) {
+        throw std::runtime_error("conv2d: blocked depthwise needs one filter per channel and matching layouts");
+    }
+
+    const size_t b = x.b, blocks = x.blocks(), RS = s.R * s.S;
+
+    // filters lane-major per block: wl[((cb * R + r) * S + q) * b + lane], zero for padded lanes
+    std::vector<T> wl(blocks * RS * b, (T)0);
+    for (size_t c = 0; c < s.C; ++c)
+        for (size_t rs = 0; rs < RS; ++rs) wl[((c / b) * RS + rs) * b + c % b] = Wt[c * RS + rs];
+
+    auto body = [&](size_t lo, size_t hi) {
+        std::vector<Acc> acc(s.OW * b);
+        std::vector<Acc> bv(b, (Acc)0);
+
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t n = t / blocks, cb = t % blocks;
+            const size_t lanes = std::min(b, s.C - cb * b);
+            const T* xc = x.chan(n, cb * b);
+            T* yc = y.chan(n, cb * b);
+            for (size_t l = 0; l < lanes; ++l) bv[l] = bias ? (Acc)bias[cb * b + l] : (Acc)0;
+
+            for (size_t oh = 0; oh < s.OH; ++oh) {
+                for (size_t ow = 0; ow < s.OW; ++ow)
+                    for (size_t l = 0; l < b; ++l) acc[ow * b + l] = bv[l];
+
+                for (size_t r = 0; r < s.R; ++r) {
+                    const long ih = (long)(oh * p.stride_h + r * p.dilation_h) - (long)p.pad_h;
+                    if (ih < 0 || ih >= (long)s.H) continue;
+
+                    for (size_t q = 0; q < s.S; ++q) {
+                        const long off = (long)(q * p.dilation_w) - (long)p.pad_w;
+                        size_t ow_lo, ow_hi;
+                        if (!ow_range(off, ow_lo, ow_hi)) continue;
+
+                        const T* wv = wl.data() + ((cb * s.R + r) * s.S + q) * b;
+                        const T* xr = xc + (ih * (long)s.W + off) * (long)b;
+                        const size_t xs = p.stride_w * b;
+                        for (size_t ow = ow_lo; ow < ow_hi; ++ow) {
+                            const T* xp = xr + ow * xs;
+                            Acc* a = acc.data() + ow * b;
+                            for (size_t l = 0; l < b; ++l) a[l] += (Acc)wv[l] * (Acc)xp[l];
+                        }
+                    }
+                }
+
+                T* yr = yc + oh * s.OW * b;
+                if (lanes == b) {
+                    for (size_t i = 0; i < s.OW * b; ++i) yr[i] = (T)acc[i];
+                    activate_inplace(yr, s.OW * b, act);
+                } else {
+                    // padded lanes of the last block stay zero
+                    for (size_t ow = 0; ow < s.OW; ++ow)
+                        for (size_t l = 0; l < lanes; ++l) yr[ow * b + l] = activate((T)acc[ow * b + l], act);
+                }
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, s.N * blocks, 1, body);
+    else body(0, s.N * blocks);
+}
+
+} // namespace _conv
+
+template<typename T = float>
+TensorLayout preferred_layout(const ConvShape& s, const Conv2dParams& p) {
+    /**
+     * @brief Layout the algorithm choose_conv_algo() picks for this shape runs fastest in
+    */
+    switch (choose_conv_algo<T>(s, p)) {
+    case ConvAlgo::IMPLICIT_GEMM: return TensorLayout::nhwc();
+    case ConvAlgo::DEPTHWISE:     return s.K == s.C ? TensorLayout::nhwc() : TensorLayout::nchw();
+    default:                      return TensorLayout::nchw();
+    }
+}
+
+template<typename T = float>
+void conv2d(const T* X, const T* W, T* Y, const ConvShape& s, const Conv2dParams& p,
+            const T* bias = nullptr, ConvAlgo algo = ConvAlgo::AUTO, Activation act = Activation::IDENTITY,
+            ThreadPool* pool = &ThreadPool::global(), TensorLayout layout = {}) {
+    /**
+     * @brief Raw-pointer conv2d into a preallocated output
+     *
+     * @param (TensorLayout) layout: layout of both X and Y (NCHWc: block only, channels are taken from s)
+    */
+    if (algo == ConvAlgo::AUTO) algo = choose_conv_algo<T>(s, p);
+
+    TensorLayout lx = layout, ly = layout;
+    if (layout.kind == Layout::NCHWc) {
+        lx = TensorLayout::nchwc(s.C, layout.block);
+        ly = TensorLayout::nchwc(s.K, layout.block);
+    }
+    ActView<const T> x = ActView<const T>::of(X, s.N, s.C, s.H, s.W, lx);
+    ActView<T> y = ActView<T>::of(Y, s.N, s.K, s.OH, s.OW, ly);
+
+    switch (algo) {
+    case ConvAlgo::DEPTHWISE:
+        if (p.groups != s.C || s.K % s.C != 0) throw std::runtime_error("conv2d: depthwise needs groups == C");
+        _conv::depthwise(x, W, y, s, p, bias, act, pool);
+        return;
+    case ConvAlgo::WINOGRAD_2x3:
+    case ConvAlgo::WINOGRAD_4x3:
+        if (s.R != 3 || s.S != 3 || p.stride_h != 1 || p.stride_w != 1 ||
+            p.dilation_h != 1 || p.dilation_w != 1 || p.groups != 1) {
+            throw std::runtime_error("conv2d: winograd needs a dense 3x3, stride 1, dilation 1");
+        }
+        if (algo == ConvAlgo::WINOGRAD_2x3) _conv::winograd<2>(x, W, y, s, p, bias, act, pool);
+        else _conv::winograd<4>(x, W, y, s, p, bias, act, pool);
+        return;
+    default:
+        _conv::implicit_gemm(x, W, y, s, p, bias, act, pool);
+        return;
+    }
+}
+
+template<typename T = float>
+NTensor<T> conv2d(NTensor<T>& X, NTensor<T>& W, const T* bias = nullptr, Conv2dParams p = {},
+                  ConvAlgo algo = ConvAlgo::AUTO, Activation act = Activation::IDENTITY,
+                  ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Y = act(conv2d(X, W) + bias)
+     *
+     * @param (NTensor<T>) X: [N x C x H x W] activations in any layout (see layout.hpp)
+     * @param (NTensor<T>) W: [K x C/groups x R x S]
+     * @param (const T*) bias: K values, or nullptr
+     * @param (Conv2dParams) p: stride / padding / dilation / groups
+     * @param (ConvAlgo) algo: AUTO = choose_conv_algo()
+     *
+     * @return (NTensor<T>) [N x K x OH x OW] in X's layout
+    */
+    if (W.ndim() != 4) {
+        throw std::runtime_error("conv2d: expected W [K x C/groups x R x S]");
+    }
+
+    auto [N, C, H, Wd] = nchw_dims(X);
+    const size_t* ws = W.shape();
+    if (p.groups == 0 || C % p.groups != 0 || ws[0] % p.groups != 0 || ws[1] != C / p.groups) {
+        throw std::runtime_error("conv2d: channels " + std::to_string(C) + " / filters " + std::to_string(ws[0]) +
+                                 " do not split into " + std::to_string(p.groups) + " groups");
+    }
+
+    ConvShape s = ConvShape::of(N, C, H, Wd, ws[0], ws[2], ws[3], p);
+    if (algo == ConvAlgo::AUTO) algo = choose_conv_algo<T>(s, p);
+
+    // blocked depthwise handles one filter per channel; channel multipliers run in NCHW
+    if (algo == ConvAlgo::DEPTHWISE && s.K != s.C && X.layout().kind != Layout::NCHW) {
+        NTensor<T> Xn = to_layout(X, TensorLayout::nchw(), pool);
+        return conv2d(Xn, W, bias, p, algo, act, pool);
+    }
+
+    TensorLayout ly = X.layout();
+    if (ly.kind == Layout::NCHWc) ly = TensorLayout::nchwc(s.K, ly.block);
+
+    NTensor<T> Y(ly.physical_shape(s.N, s.K, s.OH, s.OW), (T)0, X.config());
+    Y.set_layout(ly);
+
+    conv2d(X.data(), W.data(), Y.data(), s, p, bias, algo, act, pool, X.layout());
+    return Y;
+}
+
+#endif // CONV_HPP
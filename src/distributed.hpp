@@ -0,0 +1,306 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <gemm.hpp>
+#include <transport.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+ * 2-D block-distributed GEMM.
+ *
+ * Ranks form a rows x cols grid (row-major rank order). A [M x K], B [K x N]
+ * and C [M x N] are each split into rows x cols blocks with block_range, and
+ * grid position (i, j) owns block (i, j) of all three.
+ */
+typedef struct ProcessGrid {
+    size_t rows;
+    size_t cols;
+    size_t rank;
+
+    size_t row() const { return rank / cols; }
+    size_t col() const { return rank % cols; }
+    size_t rank_of(size_t r, size_t c) const { return r * cols + c; }
+} ProcessGrid;
+
+inline ProcessGrid make_grid(Transport& tr, size_t rows = 0) {
+    /**
+     * @brief Arrange the transport's ranks into a grid
+     *
+     * @param (Transport) tr: job transport
+     * @param (size_t) rows: grid rows, 0 = the most square factorisation of the world size
+    */
+    size_t world = tr.size();
+
+    if (rows == 0) {
+        rows = (size_t)std::sqrt((double)world);
+        while (world % rows) --rows;
+    }
+
+    if (world % rows) {
+        throw std::runtime_error("make_grid: " + std::to_string(rows) + " rows do not divide "
+            + std::to_string(world) + " ranks");
+    }
+
+    return ProcessGrid{rows, world / rows, tr.rank()};
+}
+
+inline std::pair<size_t, size_t> block_range(size_t n, size_t parts, size_t idx) {
+    return { n * idx / parts, n * (idx + 1) / parts };
+}
+
+inline size_t block_owner(size_t n, size_t parts, size_t k) {
+    size_t idx = 0;
+    while (block_range(n, parts, idx).second <= k) ++idx;
+    return idx;
+}
+
+template<typename T>
+NTensor<T> local_block(NTensor<T>& global, size_t parts_r, size_t parts_c, size_t br, size_t bc) {
+    /**
+     * @brief Copy block (br, bc) of a 2D tensor split into parts_r x parts_c blocks
+    */
+    auto [r0, r1] = block_range(global.shape()[0], parts_r, br);
+    auto [c0, c1] = block_range(global.shape()[1], parts_c, bc);
+    size_t ld = global.shape()[1];
+
+    NTensor<T> out({r1 - r0, c1 - c0}, (T)0, global.config());
+    for (size_t r = r0; r < r1; ++r) {
+        std::copy(global.data() + r * ld + c0, global.data() + r * ld + c1, out.data() + (r - r0) * (c1 - c0));
+    }
+
+    return out;
+}
+
+template<typename T>
+std::optional<NTensor<T>> gather_blocks(NTensor<T>& local, size_t M, size_t N,
+                                        const ProcessGrid& grid, Transport& tr, size_t root = 0) {
+    /**
+     * @brief Assemble the distributed [M x N] matrix on `root`
+     *
+     * @return (std::optional<NTensor<T>>) full matrix on root, empty elsewhere
+    */
+    if (tr.rank() != root) {
+        tr.send(root, local.data(), local.size() * sizeof(T));
+        return std::nullopt;
+    }
+
+    NTensor<T> out({M, N}, (T)0, local.config());
+
+    for (size_t r = 0; r < grid.rows; ++r) {
+        for (size_t c = 0; c < grid.cols; ++c) {
+            auto [r0, r1] = block_range(M, grid.rows, r);
+            auto [c0, c1] = block_range(N, grid.cols, c);
+
+            std::vector<T> block((r1 - r0) * (c1 - c0));
+            size_t src = grid.rank_of(r, c);
+
+            if (src == root) {
+                std::copy(local.data(), local.data() + local.size(), block.begin());
+            } else {
+                tr.recv(src, block.data(), block.size() * sizeof(T));
+            }
+
+            for (size_t i = r0; i < r1; ++i) {
+                std::copy(block.begin() + (i - r0) * (c1 - c0), block.begin() + (i - r0 + 1) * (c1 - c0),
+                          out.data() + i * N + c0);
+            }
+        }
+    }
+
+    return out;
+}
+
+template<typename T>
+void gemm_accumulate(const T* A, const T* B, T* C, size_t M, size_t N, size_t K,
+                     size_t lda, size_t ldb, ThreadPool& pool) {
+    GemmArgs<T> g;
+    g.M = M; g.N = N; g.K = K;
+    g.A = A; g.lda = lda;
+    g.B = B; g.ldb = ldb;
+    g.beta = (T)1;
+    g.C = C; g.ldc = N;
+
+    gemm_parallel(g, pool);
+}
+
+template<typename T>
+NTensor<T> summa_matmul(NTensor<T>& A, NTensor<T>& B, size_t M, size_t K, size_t N,
+                        const ProcessGrid& grid, Transport& tr, ThreadPool& pool = ThreadPool::global()) {
+    /**
+     * @brief SUMMA: C(i,j) = sum over K panels of A(i, panel) * B(panel, j)
+     *
+     * Each K panel is broadcast along process rows (A) and columns (B) by its
+     * owners. The panel for step s+1 is fetched on a separate thread while
+     * step s is multiplied, so communication hides behind the local GEMM.
+     * Any grid shape and any M / K / N work; blocks may be uneven.
+     *
+     * @param (NTensor<T>) A: this rank's block of the [M x K] operand
+     * @param (NTensor<T>) B: this rank's block of the [K x N] operand
+     * @param (size_t) M, K, N: global problem size
+     * @param (ProcessGrid) grid: rank layout
+     * @param (Transport) tr: job transport
+     *
+     * @return (NTensor<T>) this rank's block of C
+    */
+    const size_t P = grid.rows, Q = grid.cols;
+    const size_t my_r = grid.row(), my_c = grid.col();
+
+    auto [m0, m1] = block_range(M, P, my_r);
+    auto [n0, n1] = block_range(N, Q, my_c);
+    auto [ka0, ka1] = block_range(K, Q, my_c); // columns of A held here
+    auto [kb0, kb1] = block_range(K, P, my_r); // rows of B held here
+    const size_t m_loc = m1 - m0, n_loc = n1 - n0;
+
+    if (A.shape()[0] != m_loc || A.shape()[1] != ka1 - ka0
+        || B.shape()[0] != kb1 - kb0 || B.shape()[1] != n_loc) {
+        throw std::runtime_error("summa_matmul: local blocks do not match the grid distribution");
+    }
+
+    // panel edges are where either A's column blocks or B's row blocks change owner
+    std::vector<size_t> edges = {0, K};
+    for (size_t j = 1; j < Q; ++j) edges.push_back(block_range(K, Q, j).first);
+    for (size_t i = 1; i < P; ++i) edges.push_back(block_range(K, P, i).first);
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    struct Panel {
+        std::vector<T> a; // [m_loc x kw]
+        std::vector<T> b; // [kw x n_loc]
+        size_t kw = 0;
+    };
+
+    auto fetch = [&](size_t s) {
+        size_t k0 = edges[s], k1 = edges[s + 1];
+        size_t a_owner = block_owner(K, Q, k0);
+        size_t b_owner = block_owner(K, P, k0);
+
+        Panel p;
+        p.kw = k1 - k0;
+        p.a.resize(m_loc * p.kw);
+        p.b.resize(p.kw * n_loc);
+
+        std::vector<std::future<void>> sends;
+
+        if (my_c == a_owner) {
+            const size_t lda = ka1 - ka0;
+            for (size_t i = 0; i < m_loc; ++i) {
+                const T* src = A.data() + i * lda + (k0 - ka0);
+                std::copy(src, src + p.kw, p.a.data() + i * p.kw);
+            }
+            for (size_t c = 0; c < Q; ++c) {
+                if (c != my_c) sends.push_back(tr.isend(grid.rank_of(my_r, c), p.a.data(), p.a.size() * sizeof(T)));
+            }
+        }
+
+        if (my_r == b_owner) {
+            const T* src = B.data() + (k0 - kb0) * n_loc;
+            std::copy(src, src + p.b.size(), p.b.data());
+            for (size_t r = 0; r < P; ++r) {
+                if (r != my_r) sends.push_back(tr.isend(grid.rank_of(r, my_c), p.b.data(), p.b.size() * sizeof(T)));
+            }
+        }
+
+        if (my_c != a_owner) tr.recv(grid.rank_of(my_r, a_owner), p.a.data(), p.a.size() * sizeof(T));
+        if (my_r != b_owner) tr.recv(grid.rank_of(b_owner, my_c), p.b.data(), p.b.size() * sizeof(T));
+
+        // the panel buffers are the send buffers, they can't leave scope before the sends finish
+        for (std::future<void>& f : sends) f.get();
+
+        return p;
+    };
+
+    NTensor<T> C({m_loc, n_loc}, (T)0, A.config());
+    const size_t steps = edges.size() - 1;
+
+    std::future<Panel> next = std::async(std::launch::async, fetch, 0);
+    for (size_t s = 0; s < steps; ++s) {
+        Panel cur = next.get();
+        if (s + 1 < steps) next = std::async(std::launch::async, fetch, s + 1);
+
+        gemm_accumulate(cur.a.data(), cur.b.data(), C.data(), m_loc, n_loc, cur.kw, cur.kw, n_loc, pool);
+    }
+
+    return C;
+}
+
+template<typename T>
+NTensor<T> cannon_matmul(NTensor<T>& A, NTensor<T>& B, size_t M, size_t K, size_t N,
+                         const ProcessGrid& grid, Transport& tr, ThreadPool& pool = ThreadPool::global()) {
+    /**
+     * @brief Cannon's algorithm on a square q x q grid
+     *
+     * After the initial skew, every step multiplies the resident blocks while
+     * the next A block arrives from the right and the next B block from below,
+     * so each rank only ever talks to its grid neighbours.
+     * Requires q to divide M, K and N.
+     *
+     * @param (NTensor<T>) A, B: this rank's blocks of the [M x K] / [K x N] operands
+     * @param (size_t) M, K, N: global problem size
+     * @param (ProcessGrid) grid: square rank layout
+     * @param (Transport) tr: job transport
+     *
+     * @return (NTensor<T>) this rank's block of C
+    */
+    const size_t q = grid.rows;
+    if (grid.cols != q) throw std::runtime_error("cannon_matmul: needs a square process grid");
+    if (M % q || K % q || N % q) throw std::runtime_error("cannon_matmul: grid size must divide M, K and N");
+
+    const size_t mb = M / q, kb = K / q, nb = N / q;
+    const size_t i = grid.row(), j = grid.col();
+
+    if (A.shape()[0] != mb || A.shape()[1] != kb || B.shape()[0] != kb || B.shape()[1] != nb) {
+        throw std::runtime_error("cannon_matmul: local blocks do not match the grid distribution");
+    }
+
+    std::vector<T> a_cur(A.data(), A.data() + A.size()), a_next(a_cur.size());
+    std::vector<T> b_cur(B.data(), B.data() + B.size()), b_next(b_cur.size());
+
+    // move the resident blocks to (dst_a, dst_b) while taking new ones from (src_a, src_b)
+    auto exchange = [&](size_t dst_a, size_t src_a, size_t dst_b, size_t src_b) {
+        std::vector<std::future<void>> sends;
+        if (dst_a != grid.rank) sends.push_back(tr.isend(dst_a, a_cur.data(), a_cur.size() * sizeof(T)));
+        if (dst_b != grid.rank) sends.push_back(tr.isend(dst_b, b_cur.data(), b_cur.size() * sizeof(T)));
+
+        if (src_a != grid.rank) tr.recv(src_a, a_next.data(), a_next.size() * sizeof(T));
+        else a_next = a_cur;
+        if (src_b != grid.rank) tr.recv(src_b, b_next.data(), b_next.size() * sizeof(T));
+        else b_next = b_cur;
+
+        for (std::future<void>& f : sends) f.get();
+    };
+
+    // skew: row i of A shifts left by i, column j of B shifts up by j
+    exchange(grid.rank_of(i, (j + q - i) % q), grid.rank_of(i, (j + i) % q),
+             grid.rank_of((i + q - j) % q, j), grid.rank_of((i + j) % q, j));
+    std::swap(a_cur, a_next);
+    std::swap(b_cur, b_next);
+
+    NTensor<T> C({mb, nb}, (T)0, A.config());
+
+    for (size_t s = 0; s < q; ++s) {
+        std::future<void> shift;
+        if (s + 1 < q) {
+            shift = std::async(std::launch::async, exchange,
+                grid.rank_of(i, (j + q - 1) % q), grid.rank_of(i, (j + 1) % q),
+                grid.rank_of((i + q - 1) % q, j), grid.rank_of((i + 1) % q, j));
+        }
+
+        gemm_accumulate(a_cur.data(), b_cur.data(), C.data(), mb, nb, kb, kb, nb, pool);
+
+        if (shift.valid()) {
+            shift.get();
+            std::swap(a_cur, a_next);
+            std::swap(b_cur, b_next);
+        }
+    }
+
+    return C;
+}
+
+#endif // DISTRIBUTED_HPP
@@ -0,0 +1,368 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include <activation.hpp>
+#include <half.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Row-major GEMM: C[M x N] = alpha * op(A)[M x K] * op(B)[K x N] + beta * C
+ *
+ * op(X) = X^T when the matching trans flag is set, in which case X is read
+ * through its leading dimension without being copied.
+ */
+template<typename T>
+struct GemmArgs {
+    bool trans_a = false;
+    bool trans_b = false;
+    size_t M = 0, N = 0, K = 0;
+    T alpha = (T)1;
+    const T* A = nullptr; size_t lda = 0;
+    const T* B = nullptr; size_t ldb = 0;
+    T beta = (T)0;
+    T* C = nullptr; size_t ldc = 0;
+};
+
+constexpr size_t GEMM_TILE_M = 64;
+constexpr size_t GEMM_TILE_N = 256;
+constexpr size_t GEMM_TILE_K = 256;
+
+template<typename T>
+void gemm_tile_widened(const GemmArgs<T>& g, size_t i0, size_t i1, size_t j0, size_t j1) {
+    /**
+     * @brief gemm_tile for storage types narrower than their arithmetic (bf16 / fp16)
+     *
+     * Each output row segment is summed over all of K in accum_t<T> and
+     * rounded to T once, instead of once per multiply-add.
+    */
+    using Acc = accum_t<T>;
+    Acc acc[GEMM_TILE_N];
+
+    for (size_t jb = j0; jb < j1; jb += GEMM_TILE_N) {
+        const size_t je = std::min(jb + GEMM_TILE_N, j1), w = je - jb;
+
+        for (size_t i = i0; i < i1; ++i) {
+            std::fill(acc, acc + w, (Acc)0);
+
+            for (size_t p = 0; p < g.K; ++p) {
+                Acc a = g.trans_a ? (Acc)g.A[p * g.lda + i] : (Acc)g.A[i * g.lda + p];
+
+                if (!g.trans_b) {
+                    const T* b = g.B + p * g.ldb + jb;
+                    for (size_t j = 0; j < w; ++j) acc[j] += a * (Acc)b[j];
+                } else {
+                    for (size_t j = 0; j < w; ++j) acc[j] += a * (Acc)g.B[(jb + j) * g.ldb + p];
+                }
+            }
+
+            T* c = g.C + i * g.ldc + jb;
+            const Acc alpha = (Acc)g.alpha, beta = (Acc)g.beta;
+            for (size_t j = 0; j < w; ++j) {
+                Acc v = alpha * acc[j];
+                if (beta != (Acc)0) v += beta * (Acc)c[j];
+                c[j] = (T)v;
+            }
+        }
+    }
+}
+
+template<typename T>
+void gemm_tile(const GemmArgs<T>& g, size_t i0, size_t i1, size_t j0, size_t j1) {
+    /**
+     * @brief Compute the C[i0:i1, j0:j1] block of a GEMM
+     *
+     * K is walked in GEMM_TILE_K panels so the touched rows of B stay in cache.
+    */
+    if constexpr (!std::is_same_v<accum_t<T>, T>) {
+        gemm_tile_widened(g, i0, i1, j0, j1);
+        return;
+    }
+
+    for (size_t i = i0; i < i1; ++i) {
+        T* c = g.C + i * g.ldc;
+        if (g.beta == (T)0) {
+            std::fill(c + j0, c + j1, (T)0);
+        } else if (g.beta != (T)1) {
+            for (size_t j = j0; j < j1; ++j) c[j] *= g.beta;
+        }
+    }
+
+    for (size_t p0 = 0; p0 < g.K; p0 += GEMM_TILE_K) {
+        size_t p1 = std::min(p0 + GEMM_TILE_K, g.K);
+
+        for (size_t i = i0; i < i1; ++i) {
+            T* c = g.C + i * g.ldc;
+
+            if (!g.trans_b) {
+                for (size_t p = p0; p < p1; ++p) {
+                    T a = g.trans_a ? g.A[p * g.lda + i] : g.A[i * g.lda + p];
+                    a *= g.alpha;
+
+                    const T* b = g.B + p * g.ldb;
+                    for (size_t j = j0; j < j1; ++j) c[j] += a * b[j];
+                }
+            } else {
+                for (size_t j = j0; j < j1; ++j) {
+                    const T* b = g.B + j * g.ldb;
+                    T acc = (T)0;
+
+                    if (!g.trans_a) {
+                        const T* a = g.A + i * g.lda;
+                        for (size_t p = p0; p < p1; ++p) acc += a[p] * b[p];
+                    } else {
+                        for (size_t p = p0; p < p1; ++p) acc += g.A[p * g.lda + i] * b[p];
+                    }
+
+                    c[j] += g.alpha * acc;
+                }
+            }
+        }
+    }
+}
+
+template<typename T>
+void gemm(const GemmArgs<T>& g) {
+    gemm_tile(g, 0, g.M, 0, g.N);
+}
+
+template<typename T>
+void gemm_parallel(const GemmArgs<T>& g, ThreadPool& pool, TaskOptions opts = {}) {
+    /**
+     * @brief Split C into GEMM_TILE_M x GEMM_TILE_N tiles and run each as its own pool task
+     *
+     * Tiles are the preemption points: a higher-priority task submitted while
+     * a large GEMM is in flight is picked up as soon as a worker finishes its
+     * current tile, instead of waiting behind the whole multiplication.
+     * Tiles are also where opts.cancel is polled: once it trips, the tiles
+     * still queued are dropped and OperationCancelled is rethrown here.
+     *
+     * @param (GemmArgs<T>) g: problem description
+     * @param (ThreadPool) pool: pool the tile tasks are queued on
+     * @param (TaskOptions) opts: priority class / deadline for every tile
+    */
+    size_t tiles_m = (g.M + GEMM_TILE_M - 1) / GEMM_TILE_M;
+    size_t tiles_n = (g.N + GEMM_TILE_N - 1) / GEMM_TILE_N;
+
+    pool.parallel_for(0, tiles_m * tiles_n, 1, [&g, &opts, tiles_n](size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) {
+            opts.cancel.throw_if_cancelled();
+
+            size_t i0 = (t / tiles_n) * GEMM_TILE_M;
+            size_t j0 = (t % tiles_n) * GEMM_TILE_N;
+            gemm_tile(g, i0, std::min(i0 + GEMM_TILE_M, g.M), j0, std::min(j0 + GEMM_TILE_N, g.N));
+        }
+    }, opts);
+}
+
+template<typename T>
+NTensor<T> tiled_matmul(NTensor<T>& A, NTensor<T>& B, ThreadPool& pool, TaskOptions opts = {}) {
+    /**
+     * @brief Multiply two 2D tensors on a thread pool under a priority class
+     *
+     * @param (NTensor<T>) A: [M x K]
+     * @param (NTensor<T>) B: [K x N]
+     * @param (ThreadPool) pool: pool to schedule the tile tasks on
+     * @param (TaskOptions) opts: e.g. {.priority = Priority::CRITICAL} for small latency-bound calls,
+     *     opts.cancel aborts the multiplication between tiles
+     *
+     * @return (NTensor<T>) [M x N] product
+    */
+    if (A.ndim() != 2 || B.ndim() != 2 || A.shape()[1] != B.shape()[0]) {
+        throw std::runtime_error("tiled_matmul: expected [M x K] * [K x N] operands");
+    }
+
+    size_t M = A.shape()[0], K = A.shape()[1], N = B.shape()[1];
+    NTensor<T> out({M, N}, (T)0, A.config());
+
+    GemmArgs<T> g;
+    g.M = M; g.N = N; g.K = K;
+    g.A = A.data(); g.lda = K;
+    g.B = B.data(); g.ldb = N;
+    g.C = out.data(); g.ldc = N;
+
+    gemm_parallel(g, pool, opts);
+
+    return out;
+}
+
+/*
+ * Pre-packed B operand for repeated multiplication by the same matrix
+ * (layer weights). Columns are grouped in GEMM_PANEL_N wide panels stored
+ * [panel][k][GEMM_PANEL_N], zero padded, so the micro-kernel streams one
+ * contiguous panel per k instead of striding across rows of B.
+ */
+constexpr size_t GEMM_PANEL_N = 16;
+constexpr size_t GEMM_MICRO_M = 6;
+
+template<typename T>
+struct PackedB {
+    size_t K = 0;
+    size_t N = 0;
+    std::vector<T> data;
+
+    size_t panels() const { return (N + GEMM_PANEL_N - 1) / GEMM_PANEL_N; }
+    const T* panel(size_t p) const { return data.data() + p * K * GEMM_PANEL_N; }
+
+    static PackedB pack(const T* B, size_t ldb, size_t K, size_t N, bool trans_b = false) {
+        /**
+         * @brief Pack op(B) [K x N] into panel-major layout
+         *
+         * @param (const T*) B: source, row-major
+         * @param (size_t) ldb: leading dimension of B
+         * @param (bool) trans_b: B is stored [N x K]
+        */
+        PackedB out;
+        out.K = K;
+        out.N = N;
+        out.data.assign(out.panels() * K * GEMM_PANEL_N, (T)0);
+
+        for (size_t p = 0; p < out.panels(); ++p) {
+            T* dst = out.data.data() + p * K * GEMM_PANEL_N;
+            size_t j0 = p * GEMM_PANEL_N;
+            size_t jn = std::min(GEMM_PANEL_N, N - j0);
+
+            for (size_t k = 0; k < K; ++k) {
+                for (size_t j = 0; j < jn; ++j) {
+                    dst[k * GEMM_PANEL_N + j] = trans_b ? B[(j0 + j) * ldb + k] : B[k * ldb + j0 + j];
+                }
+            }
+        }
+
+        return out;
+    }
+};
+
+// one packed panel row as a single GCC/Clang vector; the compiler splits it to the target's SIMD width
+template<typename T>
+struct PanelVec {
+    typedef T type __attribute__((vector_size(GEMM_PANEL_N * sizeof(T))));
+};
+
+// c: MR x GEMM_PANEL_N block, loaded (or zeroed) once, accumulated in registers, stored once
+template<typename T, size_t MR>
+inline void gemm_packed_micro(const T* A, size_t lda, const T* bp, size_t K, T* c_out, bool accumulate) {
+    if constexpr (!std::is_arithmetic_v<T>) {
+        // storage-only types (bf16 / fp16) have no vector form; accumulate each row in accum_t<T>
+        for (size_t r = 0; r < MR; ++r) {
+            accum_t<T> c[GEMM_PANEL_N];
+            for (size_t j = 0; j < GEMM_PANEL_N; ++j) c[j] = accumulate ? (accum_t<T>)c_out[r * GEMM_PANEL_N + j] : 0;
+
+            for (size_t k = 0; k < K; ++k) {
+                const accum_t<T> a = (accum_t<T>)A[r * lda + k];
+                for (size_t j = 0; j < GEMM_PANEL_N; ++j) c[j] += a * (accum_t<T>)bp[k * GEMM_PANEL_N + j];
+            }
+
+            for (size_t j = 0; j < GEMM_PANEL_N; ++j) c_out[r * GEMM_PANEL_N + j] = (T)c[j];
+        }
+    } else {
+        typedef typename PanelVec<T>::type V;
+        V c[MR];
+
+        for (size_t r = 0; r < MR; ++r) {
+            if (accumulate) std::memcpy(&c[r], c_out + r * GEMM_PANEL_N, sizeof(V));
+            else c[r] = V{};
+        }
+
+        for (size_t k = 0; k < K; ++k) {
+            V b;
+            std::memcpy(&b, bp + k * GEMM_PANEL_N, sizeof(b));
+
+            for (size_t r = 0; r < MR; ++r) c[r] += A[r * lda + k] * b;
+        }
+
+        for (size_t r = 0; r < MR; ++r) std::memcpy(c_out + r * GEMM_PANEL_N, &c[r], sizeof(V));
+    }
+}
+
+template<typename T>
+void gemm_packed_tile(const T* A, size_t lda, const PackedB<T>& Bp, T* C, size_t ldc,
+                      size_t i0, size_t i1, size_t p0, size_t p1, const T* bias, Activation act) {
+    /**
+     * @brief C[i0:i1, panels p0:p1] = act(A * Bp + bias) for i1 - i0 <= GEMM_TILE_M
+     *
+     * K is walked in GEMM_TILE_K slices so the active slice of the panel stays
+     * in L1 across the row micro-tiles. Partial sums live in a small per-tile
+     * buffer; bias and activation are applied as it is written to C, so the
+     * output is stored exactly once.
+    */
+    T tile[GEMM_TILE_M * GEMM_PANEL_N];
+
+    for (size_t p = p0; p < p1; ++p) {
+        const T* bp = Bp.panel(p);
+        size_t j0 = p * GEMM_PANEL_N;
+        size_t jn = std::min(GEMM_PANEL_N, Bp.N - j0);
+
+        for (size_t k0 = 0; k0 < Bp.K || k0 == 0; k0 += GEMM_TILE_K) {
+            size_t kn = std::min(GEMM_TILE_K, Bp.K - k0);
+            bool accumulate = k0 > 0;
+
+            for (size_t i = i0; i < i1; i += GEMM_MICRO_M) {
+                size_t mr = std::min(GEMM_MICRO_M, i1 - i);
+                const T* a = A + i * lda + k0;
+                T* t = tile + (i - i0) * GEMM_PANEL_N;
+
+                if (mr == GEMM_MICRO_M) {
+                    gemm_packed_micro<T, GEMM_MICRO_M>(a, lda, bp + k0 * GEMM_PANEL_N, kn, t, accumulate);
+                } else {
+                    for (size_t r = 0; r < mr; ++r) {
+                        gemm_packed_micro<T, 1>(a + r * lda, lda, bp + k0 * GEMM_PANEL_N, kn,
+                                                t + r * GEMM_PANEL_N, accumulate);
+                    }
+                }
+            }
+
+            if (Bp.K == 0) break;
+        }
+
+        for (size_t i = i0; i < i1; ++i) {
+            const T* v = tile + (i - i0) * GEMM_PANEL_N;
+            T* c = C + i * ldc + j0;
+            for (size_t j = 0; j < jn; ++j) c[j] = v[j] + (bias ? bias[j0 + j] : (T)0);
+            activate_inplace(c, jn, act);
+        }
+    }
+}
+
+template<typename T>
+void gemm_packed(const T* A, size_t lda, size_t M, const PackedB<T>& Bp, T* C, size_t ldc,
+                 const T* bias = nullptr, Activation act = Activation::IDENTITY,
+                 ThreadPool* pool = nullptr, TaskOptions opts = {}) {
+    /**
+     * @brief Fused C = act(A * Bp + bias) against a pre-packed B
+     *
+     * @param (const T*) A: [M x K] row-major, leading dimension lda
+     * @param (PackedB<T>) Bp: packed [K x N] operand
+     * @param (T*) C: [M x N] output, leading dimension ldc
+     * @param (const T*) bias: N values added to every row, or nullptr
+     * @param (Activation) act: applied after the bias
+     * @param (ThreadPool*) pool: run tiles on this pool, nullptr = calling thread
+    */
+    const size_t panels_per_tile = GEMM_TILE_N / GEMM_PANEL_N;
+    const size_t tiles_m = (M + GEMM_TILE_M - 1) / GEMM_TILE_M;
+    const size_t tiles_n = (Bp.panels() + panels_per_tile - 1) / panels_per_tile;
+
+    auto run = [&](size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) {
+            opts.cancel.throw_if_cancelled();
+
+            size_t i0 = (t / tiles_n) * GEMM_TILE_M;
+            size_t p0 = (t % tiles_n) * panels_per_tile;
+            gemm_packed_tile(A, lda, Bp, C, ldc, i0, std::min(i0 + GEMM_TILE_M, M),
+                             p0, std::min(p0 + panels_per_tile, Bp.panels()), bias, act);
+        }
+    };
+
+    if (pool) {
+        pool->parallel_for(0, tiles_m * tiles_n, 1, run, opts);
+    } else {
+        run(0, tiles_m * tiles_n);
+    }
+}
+
+#endif // GEMM_HPP
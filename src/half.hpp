@@ -0,0 +1,191 @@
+#ifndef HALF_HPP
+#define HALF_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+/*
+ * 16-bit floating point storage types.
+ *
+ *   bf16: 1 sign | 8 exponent | 7 mantissa  (float's range, ~3 significant digits)
+ *   fp16: 1 sign | 5 exponent | 10 mantissa (IEEE binary16, max 65504)
+ *
+ * Values are stored as 16 bits and widened to float for arithmetic, so
+ * NTensor<bf16> halves memory traffic while every operation still computes
+ * in fp32; conversions round to nearest even. Construction from float is
+ * explicit, which keeps mixed bf16/float expressions unambiguous (they
+ * evaluate in float).
+ */
+namespace _half {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+struct BF16Format {
+    static uint16_t from_float(float f) {
+        uint32_t u = float_bits(f);
+        if ((u & 0x7fffffffu) > 0x7f800000u) return (uint16_t)((u >> 16) | 0x0040u);  // quiet NaN
+
+        u += 0x7fffu + ((u >> 16) & 1u);
+        return (uint16_t)(u >> 16);
+    }
+
+    static float to_float(uint16_t h) {
+        return bits_float((uint32_t)h << 16);
+    }
+};
+
+struct FP16Format {
+    static uint16_t from_float(float f) {
+#if defined(__F16C__)
+        return (uint16_t)_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+        uint32_t u = float_bits(f);
+        uint16_t sign = (uint16_t)((u >> 16) & 0x8000u);
+        uint32_t abs = u & 0x7fffffffu;
+
+        if (abs >= 0x7f800000u) return sign | (abs > 0x7f800000u ? 0x7e00u : 0x7c00u);  // NaN / inf
+        if (abs >= 0x477ff000u) return sign | 0x7c00u;                                 // rounds past 65504
+
+        if (abs < 0x38800000u) {
+            // subnormal (or zero): add 0.5 so the float adder rounds the mantissa for us
+            float r = bits_float(abs) + 0.5f;
+            return sign | (uint16_t)(float_bits(r) - 0x3f000000u);
+        }
+
+        uint32_t mant_odd = (abs >> 13) & 1u;
+        abs += 0xc8000fffu + mant_odd;  // rebias exponent (127 -> 15) and round to nearest even
+        return sign | (uint16_t)(abs >> 13);
+#endif
+    }
+
+    static float to_float(uint16_t h) {
+#if defined(__F16C__)
+        return _cvtsh_ss(h);
+#else
+        uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+        uint32_t exp = (h >> 10) & 0x1fu;
+        uint32_t mant = h & 0x3ffu;
+
+        if (exp == 0x1f) return bits_float(sign | 0x7f800000u | (mant << 13));
+        if (exp == 0) {
+            float r = (float)mant * 5.9604644775390625e-8f;  // 2^-24
+            return sign ? -r : r;
+        }
+        return bits_float(sign | ((exp + 112u) << 23) | (mant << 13));
+#endif
+    }
+};
+
+} // namespace _half
+
+template<typename Format>
+class Float16 {
+public:
+    Float16() = default;
+
+    template<typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+    explicit Float16(U v) : bits_(Format::from_float((float)v)) {}
+
+    operator float() const { return Format::to_float(bits_); }
+
+    static Float16 from_bits(uint16_t b) {
+        Float16 h;
+        h.bits_ = b;
+        return h;
+    }
+
+    uint16_t bits() const { return bits_; }
+
+    Float16& operator+=(Float16 o) { return *this = Float16((float)*this + (float)o); }
+    Float16& operator-=(Float16 o) { return *this = Float16((float)*this - (float)o); }
+    Float16& operator*=(Float16 o) { return *this = Float16((float)*this * (float)o); }
+    Float16& operator/=(Float16 o) { return *this = Float16((float)*this / (float)o); }
+
+    friend Float16 operator+(Float16 a, Float16 b) { return Float16((float)a + (float)b); }
+    friend Float16 operator-(Float16 a, Float16 b) { return Float16((float)a - (float)b); }
+    friend Float16 operator*(Float16 a, Float16 b) { return Float16((float)a * (float)b); }
+    friend Float16 operator/(Float16 a, Float16 b) { return Float16((float)a / (float)b); }
+    friend Float16 operator-(Float16 a) { return from_bits(a.bits_ ^ 0x8000u); }
+
+    friend bool operator==(Float16 a, Float16 b) { return (float)a == (float)b; }
+    friend bool operator!=(Float16 a, Float16 b) { return (float)a != (float)b; }
+    friend bool operator<(Float16 a, Float16 b) { return (float)a < (float)b; }
+    friend bool operator>(Float16 a, Float16 b) { return (float)a > (float)b; }
+    friend bool operator<=(Float16 a, Float16 b) { return (float)a <= (float)b; }
+    friend bool operator>=(Float16 a, Float16 b) { return (float)a >= (float)b; }
+
+private:
+    uint16_t bits_ = 0;
+};
+
+using bf16 = Float16<_half::BF16Format>;
+using fp16 = Float16<_half::FP16Format>;
+
+static_assert(sizeof(bf16) == 2 && sizeof(fp16) == 2);
+
+namespace _half {
+
+template<typename T> struct Accum { using type = T; };
+template<typename F> struct Accum<Float16<F>> { using type = float; };
+
+} // namespace _half
+
+// type that sums of T are carried in: float for the 16-bit formats, T otherwise
+template<typename T>
+using accum_t = typename _half::Accum<T>::type;
+
+template<typename F>
+void convert(const float* src, Float16<F>* dst, size_t n) {
+    /**
+     * @brief Round n floats to a 16-bit format
+    */
+#if defined(__F16C__)
+    if constexpr (std::is_same_v<F, _half::FP16Format>) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+        }
+        for (; i < n; ++i) dst[i] = Float16<F>(src[i]);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) dst[i] = Float16<F>(src[i]);
+}
+
+template<typename F>
+void convert(const Float16<F>* src, float* dst, size_t n) {
+    /**
+     * @brief Widen n 16-bit values to float
+    */
+#if defined(__F16C__)
+    if constexpr (std::is_same_v<F, _half::FP16Format>) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+        }
+        for (; i < n; ++i) dst[i] = (float)src[i];
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; ++i) dst[i] = (float)src[i];
+}
+
+#endif // HALF_HPP
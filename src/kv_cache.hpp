@@ -0,0 +1,274 @@
+#ifndef KV_CACHE_HPP
+#define KV_CACHE_HPP
+
+#include <attention.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Paged key / value cache for autoregressive decoding.
+ *
+ * Keys and values live in two NTensors allocated once, of shape
+ * [pages, layers, kv_heads, page_tokens, head_dim]: a page holds page_tokens
+ * consecutive positions of one sequence for every layer and head, and the
+ * rows of one (page, layer, head) are contiguous with stride head_dim. A
+ * sequence is a list of page indices plus a length.
+ *
+ * Sequences only grow (extend() then store()). fork() makes a child that
+ * shares all of its parent's pages, reference counted; full pages are never
+ * written again, so sharing them is free, and the one partially filled tail
+ * page is copied the first time either side extends into it (copy on write).
+ *
+ * Readers never copy: for_each_block() hands out (k, v, rows, position)
+ * ranges that point into the page storage, and attend() feeds them straight
+ * into AttentionTile.
+ */
+typedef struct KVCacheConfig {
+    size_t layers = 1;
+    size_t kv_heads = 1;
+    size_t head_dim = 64;
+    size_t page_tokens = 16;
+    size_t pages = 256;
+} KVCacheConfig;
+
+template<typename T = float>
+class KVCache {
+public:
+    KVCache(KVCacheConfig cfg, NTensorConfig tcfg)
+        : cfg_(cfg),
+          k_({cfg.pages, cfg.layers, cfg.kv_heads, cfg.page_tokens, cfg.head_dim}, (T)0, tcfg),
+          v_({cfg.pages, cfg.layers, cfg.kv_heads, cfg.page_tokens, cfg.head_dim}, (T)0, tcfg),
+          refs_(cfg.pages, 0)
+    {
+        /**
+         * @brief Preallocate every page up front; nothing is allocated while decoding
+        */
+        if (cfg.page_tokens == 0 || cfg.pages == 0) throw std::runtime_error("KVCache: empty page pool");
+
+        free_.reserve(cfg.pages);
+        for (size_t p = cfg.pages; p-- > 0;) free_.push_back((uint32_t)p);
+    }
+
+    KVCache(const KVCache&) = delete;
+    KVCache& operator=(const KVCache&) = delete;
+
+    size_t create() {
+        /**
+         * @brief New empty sequence
+         *
+         * @return (size_t) sequence id
+        */
+        std::lock_guard<std::mutex> lock(mutex_);
+        seqs_[next_id_] = Seq{};
+        return next_id_++;
+    }
+
+    size_t fork(size_t parent) {
+        /**
+         * @brief New sequence that shares parent's cached prefix (no data is copied)
+        */
+        std::lock_guard<std::mutex> lock(mutex_);
+        Seq child = seq(parent);
+        for (uint32_t p : child.pages) ++refs_[p];
+
+        seqs_[next_id_] = std::move(child);
+        return next_id_++;
+    }
+
+    void release(size_t id) {
+        /**
+         * @brief Drop a sequence; pages no other sequence shares go back to the pool
+        */
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (uint32_t p : seq(id).pages) unref(p);
+        seqs_.erase(id);
+    }
+
+    size_t extend(size_t id, size_t n) {
+        /**
+         * @brief Append n positions to a sequence, taking pages from the pool as needed
+         *
+         * Fill them with store() (every layer) before reading them back.
+         *
+         * @return (size_t) position of the first new token
+        */
+        std::lock_guard<std::mutex> lock(mutex_);
+        Seq& s = seq(id);
+        const size_t P = cfg_.page_tokens, start = s.len;
+
+        // a shared, partially filled tail page is about to be written: give this sequence its own copy
+        if (n > 0 && start % P != 0 && refs_[s.pages.back()] > 1) {
+            const uint32_t src = s.pages.back(), dst = take();
+            copy_page(src, dst, start % P);
+            unref(src);
+            s.pages.back() = dst;
+        }
+
+        const size_t need = (start + n + P - 1) / P;
+        if (need - s.pages.size() > free_.size()) {
+            throw std::runtime_error("KVCache: out of pages (" + std::to_string(need - s.pages.size()) +
+                                     " needed, " + std::to_string(free_.size()) + " free)");
+        }
+        while (s.pages.size() < need) s.pages.push_back(take());
+
+        s.len = start + n;
+        return start;
+    }
+
+    void store(size_t id, size_t layer, size_t pos, const T* k, const T* v, size_t n) {
+        /**
+         * @brief Write keys / values of n positions from pos for one layer
+         *
+         * @param (const T*) k: [kv_heads x n x head_dim]
+         * @param (const T*) v: [kv_heads x n x head_dim]
+        */
+        const Seq s = snapshot(id);
+        if (pos + n > s.len) throw std::runtime_error("KVCache: store past the extended length");
+
+        const size_t D = cfg_.head_dim, P = cfg_.page_tokens;
+        for (size_t h = 0; h < cfg_.kv_heads; ++h) {
+            for (size_t t = 0; t < n; ++t) {
+                const size_t at = pos + t;
+                const size_t off = offset(s.pages[at / P], layer, h) + (at % P) * D;
+                std::copy(k + (h * n + t) * D, k + (h * n + t + 1) * D, k_.data() + off);
+                std::copy(v + (h * n + t) * D, v + (h * n + t + 1) * D, v_.data() + off);
+            }
+        }
+    }
+
+    template<typename F>
+    void for_each_block(size_t id, size_t layer, size_t head, F&& fn, size_t len = SIZE_MAX) const {
+        /**
+         * @brief fn(k, v, ld, rows, pos) for each page of the first len positions, in order
+         *
+         * k and v point into the cache; row r of the block is position pos + r.
+        */
+        const Seq s = snapshot(id);
+        const size_t P = cfg_.page_tokens, n = std::min(len, s.len);
+
+        for (size_t pos = 0; pos < n; pos += P) {
+            const size_t off = offset(s.pages[pos / P], layer, head);
+            fn(k_.data() + off, v_.data() + off, cfg_.head_dim, std::min(P, n - pos), pos);
+        }
+    }
+
+    void attend(size_t id, size_t layer, const T* q, T* o, size_t heads, size_t nq,
+                AttentionParams p = {}, ThreadPool* pool = &ThreadPool::global()) const {
+        /**
+         * @brief Attention of the sequence's last nq positions over its cache, for one layer
+         *
+         * @param (const T*) q: [heads x nq x head_dim], heads a multiple of kv_heads
+         * @param (T*) o: [heads x nq x head_dim]
+         *
+         * With nq == 1 (decoding) every query head of a kv head's group goes
+         * through the cached pages together; with nq > 1 and p.causal, query
+         * row i sees positions up to len - nq + i.
+        */
+        const size_t Hkv = cfg_.kv_heads, D = cfg_.head_dim;
+        if (heads % Hkv != 0) throw std::runtime_error("KVCache: query heads must be a multiple of kv_heads");
+
+        const size_t len = length(id);
+        if (nq > len) throw std::runtime_error("KVCache: more queries than cached positions");
+
+        using Acc = accum_t<T>;
+        const Acc scale = (Acc)(p.scale > 0.0 ? p.scale : 1.0 / std::sqrt((double)D));
+        const size_t group = heads / Hkv;
+
+        // a task is one block of query rows; for decoding those rows are the heads of one group
+        const bool stacked = nq == 1;
+        const size_t rows = stacked ? group : nq, units = stacked ? Hkv : heads;
+        const size_t qb = (rows + ATTN_BLOCK_Q - 1) / ATTN_BLOCK_Q;
+
+        auto body = [&](size_t lo, size_t hi) {
+            AttentionTile<T>& t = AttentionTile<T>::local(D, D);
+
+            for (size_t task = lo; task < hi; ++task) {
+                const size_t u = task / qb, i0 = (task % qb) * ATTN_BLOCK_Q;
+                const size_t n = std::min(ATTN_BLOCK_Q, rows - i0);
+                const size_t kvh = stacked ? u : u / group;
+                const size_t row0 = u * rows + i0;
+
+                t.begin(q + row0 * D, D, n, scale, p.causal && !stacked, len - nq + i0);
+                for_each_block(id, layer, kvh, [&](const T* k, const T* v, size_t ld, size_t m, size_t pos) {
+                    t.attend(k, ld, v, ld, m, pos);
+                }, len);
+                t.store(o + row0 * D, D);
+            }
+        };
+
+        if (pool) pool->parallel_for(0, units * qb, 1, body);
+        else body(0, units * qb);
+    }
+
+    size_t length(size_t id) const { return snapshot(id).len; }
+    size_t pages_free() const { std::lock_guard<std::mutex> lock(mutex_); return free_.size(); }
+    size_t pages_used() const { return cfg_.pages - pages_free(); }
+    const KVCacheConfig& config() const { return cfg_; }
+
+private:
+    struct Seq {
+        std::vector<uint32_t> pages;
+        size_t len = 0;
+    };
+
+    // element offset of (page, layer, head) rows in k_ / v_
+    size_t offset(size_t page, size_t layer, size_t head) const {
+        return ((page * cfg_.layers + layer) * cfg_.kv_heads + head) * cfg_.page_tokens * cfg_.head_dim;
+    }
+
+    Seq& seq(size_t id) {
+        auto it = seqs_.find(id);
+        if (it == seqs_.end()) throw std::runtime_error("KVCache: unknown sequence " + std::to_string(id));
+        return it->second;
+    }
+
+    // copy of the page list and length, taken under the lock: another thread's
+    // extend() or release() may reallocate or erase the Seq as soon as it is dropped
+    Seq snapshot(size_t id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return const_cast<KVCache*>(this)->seq(id);
+    }
+
+    uint32_t take() {
+        if (free_.empty()) throw std::runtime_error("KVCache: out of pages");
+        const uint32_t p = free_.back();
+        free_.pop_back();
+        refs_[p] = 1;
+        return p;
+    }
+
+    void unref(uint32_t p) {
+        if (--refs_[p] == 0) free_.push_back(p);
+    }
+
+    void copy_page(uint32_t src, uint32_t dst, size_t rows) {
+        const size_t D = cfg_.head_dim;
+        for (size_t l = 0; l < cfg_.layers; ++l) {
+            for (size_t h = 0; h < cfg_.kv_heads; ++h) {
+                const size_t a = offset(src, l, h), b = offset(dst, l, h);
+                std::copy(k_.data() + a, k_.data() + a + rows * D, k_.data() + b);
+                std::copy(v_.data() + a, v_.data() + a + rows * D, v_.data() + b);
+            }
+        }
+    }
+
+    KVCacheConfig cfg_;
+    mutable NTensor<T> k_, v_;
+
+    mutable std::mutex mutex_;
+    std::vector<uint32_t> refs_;
+    std::vector<uint32_t> free_;
+    std::unordered_map<size_t, Seq> seqs_;
+    size_t next_id_ = 0;
+};
+
+#endif // KV_CACHE_HPP
@@ -0,0 +1,99 @@
+#ifndef LAYOUT_HPP
+#define LAYOUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Memory layout of a 4-D activation tensor with logical dims [N, C, H, W].
+ *
+ *   NCHW     physical [N, C, H, W]           one plane per channel
+ *   NHWC     physical [N, H, W, C]           channels contiguous per pixel
+ *   NCHWc    physical [N, C/c, H, W, c]      channels in blocks of c = SIMD lanes,
+ *                                            C padded up to a multiple of c with zeros
+ *
+ * All three are "channels in blocks of b" with b = 1 (NCHW), b = C (NHWC) or
+ * b = c (NCHWc): element (n, ch, h, w) lives at
+ *     n * image + (ch / b) * H * W * b + (h * W + w) * b + ch % b
+ * which is what ActView computes, so kernels can be written once against it.
+ */
+enum class Layout : uint8_t { NCHW, NHWC, NCHWc };
+
+#if defined(__AVX512F__)
+constexpr size_t SIMD_BYTES = 64;
+#elif defined(__AVX__)
+constexpr size_t SIMD_BYTES = 32;
+#else
+constexpr size_t SIMD_BYTES = 16;
+#endif
+
+template<typename T>
+constexpr size_t simd_lanes() { return SIMD_BYTES / sizeof(T) > 1 ? SIMD_BYTES / sizeof(T) : 1; }
+
+typedef struct TensorLayout {
+    Layout kind = Layout::NCHW;
+    size_t block = 0;       // NCHWc: channels per block
+    size_t channels = 0;    // logical C, NCHWc only (the physical dim is padded)
+
+    bool operator==(const TensorLayout& o) const {
+        return kind == o.kind && (kind != Layout::NCHWc || (block == o.block && channels == o.channels));
+    }
+    bool operator!=(const TensorLayout& o) const { return !(*this == o); }
+
+    size_t block_for(size_t C) const {
+        switch (kind) {
+        case Layout::NCHW:  return 1;
+        case Layout::NHWC:  return C;
+        case Layout::NCHWc: return block;
+        }
+        return 1;
+    }
+
+    std::vector<size_t> physical_shape(size_t N, size_t C, size_t H, size_t W) const {
+        switch (kind) {
+        case Layout::NHWC:  return {N, H, W, C};
+        case Layout::NCHWc: return {N, (C + block - 1) / block, H, W, block};
+        default:            return {N, C, H, W};
+        }
+    }
+
+    static TensorLayout nchw() { return TensorLayout{}; }
+    static TensorLayout nhwc() { return TensorLayout{Layout::NHWC, 0, 0}; }
+
+    static TensorLayout nchwc(size_t C, size_t block) {
+        if (block == 0) throw std::runtime_error("NCHWc layout needs a block size");
+        return TensorLayout{Layout::NCHWc, block, C};
+    }
+} TensorLayout;
+
+inline const char* layout_name(Layout l) {
+    switch (l) {
+    case Layout::NCHW:  return "NCHW";
+    case Layout::NHWC:  return "NHWC";
+    case Layout::NCHWc: return "NCHWc";
+    }
+    return "?";
+}
+
+template<typename T>
+struct ActView {
+    T* data;
+    size_t N, C, H, W;
+    size_t b;               // channels per block, see above
+
+    size_t blocks() const { return (C + b - 1) / b; }
+    size_t image() const { return blocks() * H * W * b; }
+
+    // channel plane base; pixel (h, w) of it is at [(h * W + w) * b]
+    T* chan(size_t n, size_t c) const {
+        return data + n * image() + (c / b) * H * W * b + c % b;
+    }
+
+    static ActView of(T* data, size_t N, size_t C, size_t H, size_t W, const TensorLayout& l) {
+        return ActView{data, N, C, H, W, l.block_for(C)};
+    }
+};
+
+#endif // LAYOUT_HPP
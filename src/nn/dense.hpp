@@ -0,0 +1,111 @@
+#ifndef NN_DENSE_HPP
+#define NN_DENSE_HPP
+
+#include <gemm.hpp>
+#include <nn/neuron.hpp>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+
+namespace nn {
+
+template<typename T = float>
+class Dense {
+public:
+    Dense(NTensor<T> weight, NTensor<T> bias, Activation act = Activation::IDENTITY)
+        : weight_(std::move(weight)), bias_(std::move(bias)), act_(act)
+    {
+        /**
+         * @brief Fully connected layer Y = act(X * W + b)
+         *
+         * @param (NTensor<T>) weight: [in x out]
+         * @param (NTensor<T>) bias: {out}
+         * @param (Activation) act: fused into the GEMM epilogue
+        */
+        if (weight_.ndim() != 2 || bias_.size() != weight_.shape()[1]) {
+            throw std::runtime_error("Dense: expected weight [in x out] and bias {out}");
+        }
+        repack();
+    }
+
+    Dense(size_t in, size_t out, Activation act, NTensorConfig cfg, uint32_t seed = 0)
+        : Dense(glorot(in, out, cfg, seed), NTensor<T>({out}, (T)0, cfg), act)
+    {}
+
+    static Dense from_weights(std::map<std::string, NTensor<T>>& weights, const std::string& prefix,
+                              Activation act = Activation::IDENTITY) {
+        /**
+         * @brief Build from "<prefix>.weight" / "<prefix>.bias" of a loaded weights file
+        */
+        auto w = weights.find(prefix + ".weight");
+        auto b = weights.find(prefix + ".bias");
+        if (w == weights.end() || b == weights.end()) {
+            throw std::runtime_error("Dense: missing " + prefix + ".weight / " + prefix + ".bias");
+        }
+        return Dense(w->second, b->second, act);
+    }
+
+    void repack() {
+        /**
+         * @brief Refresh the packed weight panels; call after modifying weight()
+        */
+        packed_ = PackedB<T>::pack(weight_.data(), out(), in(), out());
+    }
+
+    NTensor<T> forward(NTensor<T>& X, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @brief Batched forward pass as one fused GEMM + bias + activation
+         *
+         * @param (NTensor<T>) X: [batch x in]
+         * @param (ThreadPool*) pool: pool for the GEMM tiles, nullptr = calling thread
+         *
+         * @return (NTensor<T>) [batch x out]
+        */
+        if (X.ndim() != 2 || X.shape()[1] != in()) {
+            throw std::runtime_error("Dense: input must be [batch x " + std::to_string(in()) + "]");
+        }
+
+        NTensor<T> Y({X.shape()[0], out()}, (T)0, X.config());
+        forward(X.data(), X.shape()[0], Y.data(), pool);
+        return Y;
+    }
+
+    void forward(const T* X, size_t batch, T* Y, ThreadPool* pool = &ThreadPool::global()) {
+        gemm_packed(X, in(), batch, packed_, Y, out(), bias_.data(), act_, pool);
+    }
+
+    Neuron<T> neuron(size_t j) {
+        std::vector<T> w(in());
+        for (size_t i = 0; i < in(); ++i) w[i] = weight_.data()[i * out() + j];
+        return Neuron<T>(std::move(w), bias_.data()[j], act_);
+    }
+
+    NTensor<T>& weight() { return weight_; }
+    NTensor<T>& bias() { return bias_; }
+    Activation activation() const { return act_; }
+    size_t in() { return weight_.shape()[0]; }
+    size_t out() { return weight_.shape()[1]; }
+
+private:
+    NTensor<T> weight_;
+    NTensor<T> bias_;
+    Activation act_;
+    PackedB<T> packed_;
+
+    static NTensor<T> glorot(size_t in, size_t out, NTensorConfig cfg, uint32_t seed) {
+        NTensor<T> w({in, out}, (T)0, cfg);
+
+        std::mt19937 rng(seed);
+        double limit = std::sqrt(6.0 / (double)(in + out));
+        std::uniform_real_distribution<double> dist(-limit, limit);
+        for (size_t i = 0; i < w.size(); ++i) w.data()[i] = (T)dist(rng);
+
+        return w;
+    }
+};
+
+} // namespace nn
+
+#endif // NN_DENSE_HPP
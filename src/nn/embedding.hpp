@@ -0,0 +1,181 @@
+#ifndef NN_EMBEDDING_HPP
+#define NN_EMBEDDING_HPP
+
+#include <optim.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Embedding table: row lookups into a [vocab x dim] weight.
+ *
+ * forward() gathers a batch of ids into a dense [n x dim] block, one row
+ * copy per id, prefetching the rows EMBED_PREFETCH ids ahead so the random
+ * reads into a large table overlap. row() is the zero-copy lookup of a single
+ * id. backward() never materialises a [vocab x dim] gradient: it sorts the
+ * batch by id and sums the output gradient of each distinct id into a
+ * SparseRows, which Optimizer::step() applies to those rows only.
+ */
+constexpr size_t EMBED_PREFETCH = 8;
+constexpr size_t EMBED_TASK_ELEMS = 1 << 15;
+
+namespace nn {
+
+template<typename T = float>
+class Embedding {
+public:
+    explicit Embedding(NTensor<T> weight)
+        : weight_(std::move(weight))
+    {
+        /**
+         * @brief Lookup table over weight [vocab x dim]
+        */
+        if (weight_.ndim() != 2) throw std::runtime_error("Embedding: expected weight [vocab x dim]");
+    }
+
+    Embedding(size_t vocab, size_t dim, NTensorConfig cfg, uint32_t seed = 0)
+        : Embedding(normal(vocab, dim, cfg, seed))
+    {}
+
+    static Embedding from_weights(std::map<std::string, NTensor<T>>& weights, const std::string& prefix) {
+        /**
+         * @brief Build from "<prefix>.weight" of a loaded weights file
+        */
+        auto w = weights.find(prefix + ".weight");
+        if (w == weights.end()) throw std::runtime_error("Embedding: missing " + prefix + ".weight");
+        return Embedding(w->second);
+    }
+
+    const T* row(size_t id) {
+        /**
+         * @brief Zero-copy view of one embedding, dim() values, valid until the weight changes
+        */
+        if (id >= vocab()) throw std::runtime_error("Embedding: id " + std::to_string(id) + " out of range");
+        return weight_.data() + id * dim();
+    }
+
+    NTensor<T> forward(const size_t* ids, size_t n, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @brief Gather the rows of n ids
+         *
+         * @return (NTensor<T>) [n x dim]
+        */
+        NTensor<T> Y({n, dim()}, (T)0, weight_.config());
+        forward(ids, n, Y.data(), pool);
+        return Y;
+    }
+
+    void forward(const size_t* ids, size_t n, T* out, ThreadPool* pool = &ThreadPool::global()) {
+        check(ids, n);
+
+        const size_t D = dim();
+        const T* w = weight_.data();
+
+        auto body = [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) {
+                if (i + EMBED_PREFETCH < hi) prefetch_row(w + ids[i + EMBED_PREFETCH] * D, D);
+                std::copy_n(w + ids[i] * D, D, out + i * D);
+            }
+        };
+
+        if (pool && n * D > EMBED_TASK_ELEMS) pool->parallel_for(0, n, std::max<size_t>(1, EMBED_TASK_ELEMS / D), body);
+        else body(0, n);
+    }
+
+    SparseRows<T> backward(const size_t* ids, size_t n, const T* grad_out, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @brief Gradient of the weight for a forward() over ids, given d(loss)/d(output)
+         *
+         * @param (const T*) grad_out: [n x dim]
+         *
+         * @return (SparseRows<T>) one summed row per distinct id, ids ascending
+        */
+        check(ids, n);
+
+        const size_t D = dim();
+        std::vector<uint32_t> order(n);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return ids[a] != ids[b] ? ids[a] < ids[b] : a < b;
+        });
+
+        // segment k of order holds the positions of the k-th distinct id
+        SparseRows<T> g;
+        g.cols = D;
+        std::vector<size_t> start;
+        for (size_t i = 0; i < n; ++i) {
+            if (i == 0 || ids[order[i]] != ids[order[i - 1]]) {
+                g.rows.push_back(ids[order[i]]);
+                start.push_back(i);
+            }
+        }
+        start.push_back(n);
+        g.values.resize(g.rows.size() * D);
+
+        using Acc = accum_t<T>;
+        auto body = [&](size_t lo, size_t hi) {
+            std::vector<Acc> acc(D);
+            for (size_t k = lo; k < hi; ++k) {
+                std::fill(acc.begin(), acc.end(), (Acc)0);
+                for (size_t i = start[k]; i < start[k + 1]; ++i) {
+                    const T* src = grad_out + (size_t)order[i] * D;
+                    for (size_t j = 0; j < D; ++j) acc[j] += (Acc)src[j];
+                }
+
+                T* dst = g.values.data() + k * D;
+                for (size_t j = 0; j < D; ++j) dst[j] = (T)acc[j];
+            }
+        };
+
+        const size_t rows = g.rows.size();
+        if (pool && n * D > EMBED_TASK_ELEMS) pool->parallel_for(0, rows, std::max<size_t>(1, EMBED_TASK_ELEMS / D), body);
+        else body(0, rows);
+
+        return g;
+    }
+
+    NTensor<T>& weight() { return weight_; }
+    size_t vocab() { return weight_.shape()[0]; }
+    size_t dim() { return weight_.shape()[1]; }
+
+private:
+    NTensor<T> weight_;
+
+    void check(const size_t* ids, size_t n) {
+        const size_t V = vocab();
+        for (size_t i = 0; i < n; ++i) {
+            if (ids[i] >= V) {
+                throw std::runtime_error("Embedding: id " + std::to_string(ids[i]) + " out of range (vocab " +
+                                         std::to_string(V) + ")");
+            }
+        }
+    }
+
+    static void prefetch_row(const T* p, size_t D) {
+        const char* c = (const char*)p;
+        for (size_t b = 0; b < D * sizeof(T); b += 64) __builtin_prefetch(c + b, 0, 1);
+    }
+
+    static NTensor<T> normal(size_t vocab, size_t dim, NTensorConfig cfg, uint32_t seed) {
+        NTensor<T> w({vocab, dim}, (T)0, cfg);
+
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> dist(0.0, 1.0);
+        for (size_t i = 0; i < w.size(); ++i) w.data()[i] = (T)dist(rng);
+
+        return w;
+    }
+};
+
+} // namespace nn
+
+#endif // NN_EMBEDDING_HPP
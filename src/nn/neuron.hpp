@@ -0,0 +1,47 @@
+#ifndef NN_NEURON_HPP
+#define NN_NEURON_HPP
+
+#include <activation.hpp>
+
+#include <vector>
+
+namespace nn {
+
+template<typename T = float>
+class Neuron {
+public:
+    Neuron(std::vector<T> weights, T bias, Activation act = Activation::IDENTITY)
+        : weights_(std::move(weights)), bias_(bias), act_(act)
+    {
+        /**
+         * @brief Single unit: act(w . x + b)
+         *
+         * Meant for inspection and tiny models; a layer of neurons should be a
+         * Dense, whose forward pass runs every unit of a batch in one GEMM.
+         *
+         * @param (std::vector<T>) weights: one weight per input
+         * @param (T) bias: added before the activation
+         * @param (Activation) act: output nonlinearity
+        */
+    }
+
+    T forward(const T* x) const {
+        T acc = bias_;
+        for (size_t i = 0; i < weights_.size(); ++i) acc += weights_[i] * x[i];
+        return activate(acc, act_);
+    }
+
+    const std::vector<T>& weights() const { return weights_; }
+    T bias() const { return bias_; }
+    Activation activation() const { return act_; }
+    size_t inputs() const { return weights_.size(); }
+
+private:
+    std::vector<T> weights_;
+    T bias_;
+    Activation act_;
+};
+
+} // namespace nn
+
+#endif // NN_NEURON_HPP
@@ -0,0 +1,138 @@
+#ifndef NN_QUANTIZED_DENSE_HPP
+#define NN_QUANTIZED_DENSE_HPP
+
+#include <activation.hpp>
+#include <quantize.hpp>
+#include <serialize.hpp>
+#include <tensor.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+class QuantizedDense {
+public:
+    QuantizedDense(const int8_t* weight, size_t in, size_t out, std::vector<float> weight_scale,
+                   float input_scale, std::vector<float> bias, Activation act = Activation::IDENTITY)
+        : in_(in), out_(out), w_scale_(std::move(weight_scale)), x_scale_(input_scale),
+          bias_(std::move(bias)), act_(act), wt_(in * out)
+    {
+        /**
+         * @brief Int8 Dense: Y = act(dequant(quant(X) * Wq) + b)
+         *
+         * @param (const int8_t*) weight: [in x out], column k quantized with weight_scale[k]
+         * @param (float) input_scale: static activation scale from calibration; <= 0 quantizes
+         *     each input row with its own range instead
+         * @param (std::vector<float>) bias: {out}, kept in float
+        */
+        if (w_scale_.size() != out || bias_.size() != out) {
+            throw std::runtime_error("QuantizedDense: expected " + std::to_string(out) + " weight scales and biases");
+        }
+
+        // stored transposed for gemm_s8
+        for (size_t i = 0; i < in; ++i)
+            for (size_t k = 0; k < out; ++k) wt_[k * in + i] = weight[i * out + k];
+    }
+
+    static QuantizedDense from_blobs(const std::map<std::string, TensorBlob>& q, const std::string& prefix) {
+        /**
+         * @brief Build from a quantized weights file written by save_quantized()
+        */
+        auto get = [&](const char* name) -> const TensorBlob& {
+            auto it = q.find(prefix + name);
+            if (it == q.end()) throw std::runtime_error("QuantizedDense: missing " + prefix + name);
+            return it->second;
+        };
+
+        const TensorBlob& w = get(".weight");
+        if (w.dtype != I8 || w.shape.size() != 2) throw std::runtime_error("QuantizedDense: " + prefix + ".weight must be int8 [in x out]");
+        if (w.bytes.size() != w.shape[0] * w.shape[1]) {
+            throw std::runtime_error("QuantizedDense: " + prefix + ".weight holds " + std::to_string(w.bytes.size()) +
+                                     " bytes, expected " + std::to_string(w.shape[0] * w.shape[1]));
+        }
+
+        auto floats = [&](const char* name) {
+            NTensor<float> t = get(name).tensor<float>(NTensorConfig{SIZE_MAX});
+            return std::vector<float>(t.data(), t.data() + t.size());
+        };
+
+        const std::vector<float> input_scale = floats(".input_scale");
+        if (input_scale.empty()) throw std::runtime_error("QuantizedDense: " + prefix + ".input_scale is empty");
+
+        Activation act = Activation::IDENTITY;
+        auto a = q.find(prefix + ".activation");
+        if (a != q.end()) {
+            NTensor<int32_t> t = a->second.tensor<int32_t>(NTensorConfig{SIZE_MAX});
+            const int32_t v = t.size() ? t.data()[0] : -1;
+            if (v < (int32_t)Activation::IDENTITY || v > (int32_t)Activation::SILU) {
+                throw std::runtime_error("QuantizedDense: " + prefix + ".activation is not a valid activation");
+            }
+            act = (Activation)v;
+        }
+
+        return QuantizedDense((const int8_t*)w.bytes.data(), w.shape[0], w.shape[1], floats(".weight_scale"),
+                              input_scale[0], floats(".bias"), act);
+    }
+
+    NTensor<float> forward(NTensor<float>& X, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @param (NTensor<float>) X: [batch x in]
+         *
+         * @return (NTensor<float>) [batch x out]
+        */
+        if (X.ndim() != 2 || X.shape()[1] != in_) {
+            throw std::runtime_error("QuantizedDense: input must be [batch x " + std::to_string(in_) + "]");
+        }
+
+        NTensor<float> Y({X.shape()[0], out_}, 0.0f, X.config());
+        forward(X.data(), X.shape()[0], Y.data(), pool);
+        return Y;
+    }
+
+    void forward(const float* X, size_t batch, float* Y, ThreadPool* pool = &ThreadPool::global()) {
+        xq_.resize(batch * in_);
+        acc_.resize(batch * out_);
+        std::vector<float> row_scale(batch, x_scale_);
+
+        for (size_t r = 0; r < batch; ++r) {
+            const float* x = X + r * in_;
+            if (x_scale_ <= 0.0f) {
+                float amax = 0.0f;
+                for (size_t i = 0; i < in_; ++i) amax = std::max(amax, std::fabs(x[i]));
+                row_scale[r] = int8_scale(amax);
+            }
+            quantize_int8(x, xq_.data() + r * in_, in_, row_scale[r]);
+        }
+
+        gemm_s8(xq_.data(), in_, batch, wt_.data(), in_, out_, in_, acc_.data(), out_, pool);
+
+        for (size_t r = 0; r < batch; ++r) {
+            float* y = Y + r * out_;
+            const int32_t* a = acc_.data() + r * out_;
+            for (size_t k = 0; k < out_; ++k) y[k] = (float)a[k] * (row_scale[r] * w_scale_[k]) + bias_[k];
+            activate_inplace(y, out_, act_);
+        }
+    }
+
+    size_t in() const { return in_; }
+    size_t out() const { return out_; }
+    float input_scale() const { return x_scale_; }
+    const std::vector<float>& weight_scale() const { return w_scale_; }
+
+private:
+    size_t in_, out_;
+    std::vector<float> w_scale_;
+    float x_scale_;
+    std::vector<float> bias_;
+    Activation act_;
+    std::vector<int8_t> wt_;        // [out x in]
+    std::vector<int8_t> xq_;
+    std::vector<int32_t> acc_;
+};
+
+} // namespace nn
+
+#endif // NN_QUANTIZED_DENSE_HPP
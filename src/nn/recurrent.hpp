@@ -0,0 +1,288 @@
+#ifndef NN_RECURRENT_HPP
+#define NN_RECURRENT_HPP
+
+#include <gemm.hpp>
+#include <vmath.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * LSTM and GRU layers.
+ *
+ * Weights are stored like Dense ([in x out]) with the gates concatenated
+ * along the columns, in PyTorch order:
+ *
+ *   LSTM   weight_ih [in x 4H], weight_hh [H x 4H]   gates i, f, g, o
+ *   GRU    weight_ih [in x 3H], weight_hh [H x 3H]   gates r, z, n
+ *
+ * plus bias_ih / bias_hh {G * H}. Sequences are time-major, [steps x batch x in].
+ *
+ * forward() does the input side of every timestep up front as one
+ * [steps * batch x in] * [in x G * H] GEMM. Each timestep then does a single
+ * packed GEMM of the previous hidden state against all gates of weight_hh at
+ * once, and one pass over the two gate rows that applies every
+ * nonlinearity, updates the cell and writes h. That pass runs on vmath.hpp
+ * vectors whenever T accumulates in float. The hidden state of step t is row
+ * block t of the output, which is also the GEMM input for step t + 1, so
+ * nothing is copied between steps.
+ */
+namespace nn {
+
+template<typename T = float>
+struct RecurrentState {
+    std::vector<T> h;               // [batch x hidden]
+    std::vector<accum_t<T>> c;      // [batch x hidden], LSTM only
+};
+
+namespace _recurrent {
+
+// VMATH_LANES floats at a time when T accumulates in float, one accum_t<T> at a time otherwise
+template<typename T>
+struct Lanes {
+    static constexpr bool vec = std::is_same_v<accum_t<T>, float>;
+    using V = std::conditional_t<vec, _vmath::vf, accum_t<T>>;
+    static constexpr size_t n = vec ? VMATH_LANES : 1;
+
+    static V load(const T* p, size_t k) {
+        if constexpr (std::is_same_v<T, float>) {
+            return _vmath::load_partial(p, k);
+        } else if constexpr (vec) {
+            float tmp[VMATH_LANES] = {};
+            for (size_t i = 0; i < k; ++i) tmp[i] = (float)p[i];
+            return _vmath::load(tmp);
+        } else {
+            return (V)p[0];
+        }
+    }
+
+    static void store(T* p, V v, size_t k) {
+        if constexpr (std::is_same_v<T, float>) {
+            _vmath::store_partial(p, v, k);
+        } else if constexpr (vec) {
+            float tmp[VMATH_LANES];
+            _vmath::store(tmp, v);
+            for (size_t i = 0; i < k; ++i) p[i] = (T)tmp[i];
+        } else {
+            p[0] = (T)v;
+        }
+    }
+};
+
+inline _vmath::vf sigmoid(_vmath::vf x) { return _vmath::sigmoid<MathAccuracy::PRECISE>(x); }
+inline _vmath::vf tanh(_vmath::vf x) { return _vmath::tanh<MathAccuracy::PRECISE>(x); }
+
+template<typename S, typename = std::enable_if_t<std::is_floating_point_v<S>>>
+S sigmoid(S x) { return (S)1 / ((S)1 + std::exp(-x)); }
+
+template<typename S, typename = std::enable_if_t<std::is_floating_point_v<S>>>
+S tanh(S x) { return std::tanh(x); }
+
+} // namespace _recurrent
+
+struct LSTMCell {
+    static constexpr size_t gates = 4;
+    static constexpr bool has_cell = true;
+
+    template<typename T>
+    static void step(const T* gx, const T* gh, const T*, accum_t<T>* c, T* h, size_t H) {
+        /**
+         * @brief c = f * c + i * g, h = o * tanh(c) for one batch row
+         *
+         * @param (const T*) gx: input-side gate preactivations [4H]
+         * @param (const T*) gh: hidden-side gate preactivations [4H]
+        */
+        using L = _recurrent::Lanes<T>;
+        using LA = _recurrent::Lanes<accum_t<T>>;
+
+        for (size_t j = 0; j < H; j += L::n) {
+            const size_t k = std::min(L::n, H - j);
+            auto i = _recurrent::sigmoid(L::load(gx + j, k) + L::load(gh + j, k));
+            auto f = _recurrent::sigmoid(L::load(gx + H + j, k) + L::load(gh + H + j, k));
+            auto g = _recurrent::tanh(L::load(gx + 2 * H + j, k) + L::load(gh + 2 * H + j, k));
+            auto o = _recurrent::sigmoid(L::load(gx + 3 * H + j, k) + L::load(gh + 3 * H + j, k));
+
+            auto cn = f * LA::load(c + j, k) + i * g;
+            LA::store(c + j, cn, k);
+            L::store(h + j, o * _recurrent::tanh(cn), k);
+        }
+    }
+};
+
+struct GRUCell {
+    static constexpr size_t gates = 3;
+    static constexpr bool has_cell = false;
+
+    template<typename T>
+    static void step(const T* gx, const T* gh, const T* h_prev, accum_t<T>*, T* h, size_t H) {
+        /**
+         * @brief n = tanh(xn + r * hn), h = n + z * (h_prev - n) for one batch row
+         *
+         * gh already includes bias_hh, so r scales the recurrent bias of n as
+         * well, as in PyTorch.
+        */
+        using L = _recurrent::Lanes<T>;
+
+        for (size_t j = 0; j < H; j += L::n) {
+            const size_t k = std::min(L::n, H - j);
+            auto r = _recurrent::sigmoid(L::load(gx + j, k) + L::load(gh + j, k));
+            auto z = _recurrent::sigmoid(L::load(gx + H + j, k) + L::load(gh + H + j, k));
+            auto n = _recurrent::tanh(L::load(gx + 2 * H + j, k) + r * L::load(gh + 2 * H + j, k));
+
+            L::store(h + j, n + z * (L::load(h_prev + j, k) - n), k);
+        }
+    }
+};
+
+template<typename T, typename Cell>
+class Recurrent {
+public:
+    Recurrent(NTensor<T> weight_ih, NTensor<T> weight_hh, NTensor<T> bias_ih, NTensor<T> bias_hh)
+        : w_ih_(std::move(weight_ih)), w_hh_(std::move(weight_hh)),
+          b_ih_(std::move(bias_ih)), b_hh_(std::move(bias_hh))
+    {
+        /**
+         * @brief Recurrent layer from gate-concatenated weights (see the top of this file)
+         *
+         * @param (NTensor<T>) weight_ih: [in x G*H]
+         * @param (NTensor<T>) weight_hh: [H x G*H]
+         * @param (NTensor<T>) bias_ih: {G*H}
+         * @param (NTensor<T>) bias_hh: {G*H}
+        */
+        if (w_ih_.ndim() != 2 || w_hh_.ndim() != 2 || w_ih_.shape()[1] % Cell::gates != 0) {
+            throw std::runtime_error("Recurrent: expected weight_ih [in x G*H] and weight_hh [H x G*H]");
+        }
+        const size_t GH = w_ih_.shape()[1];
+        if (w_hh_.shape()[0] * Cell::gates != GH || w_hh_.shape()[1] != GH ||
+            b_ih_.size() != GH || b_hh_.size() != GH) {
+            throw std::runtime_error("Recurrent: weight_hh / bias shapes do not match weight_ih [" +
+                                     std::to_string(w_ih_.shape()[0]) + " x " + std::to_string(GH) + "]");
+        }
+        repack();
+    }
+
+    Recurrent(size_t in, size_t hidden, NTensorConfig cfg, uint32_t seed = 0)
+        : Recurrent(uniform({in, Cell::gates * hidden}, hidden, cfg, seed),
+                    uniform({hidden, Cell::gates * hidden}, hidden, cfg, seed + 1),
+                    uniform({Cell::gates * hidden}, hidden, cfg, seed + 2),
+                    uniform({Cell::gates * hidden}, hidden, cfg, seed + 3))
+    {}
+
+    static Recurrent from_weights(std::map<std::string, NTensor<T>>& weights, const std::string& prefix) {
+        /**
+         * @brief Build from "<prefix>.weight_ih", ".weight_hh", ".bias_ih", ".bias_hh" of a loaded weights file
+        */
+        auto get = [&](const char* name) -> NTensor<T>& {
+            auto it = weights.find(prefix + name);
+            if (it == weights.end()) throw std::runtime_error("Recurrent: missing " + prefix + name);
+            return it->second;
+        };
+        return Recurrent(get(".weight_ih"), get(".weight_hh"), get(".bias_ih"), get(".bias_hh"));
+    }
+
+    void repack() {
+        /**
+         * @brief Refresh the packed weight panels; call after modifying the weights
+        */
+        ih_packed_ = PackedB<T>::pack(w_ih_.data(), gates_width(), in(), gates_width());
+        hh_packed_ = PackedB<T>::pack(w_hh_.data(), gates_width(), hidden(), gates_width());
+    }
+
+    NTensor<T> forward(NTensor<T>& X, RecurrentState<T>* state = nullptr, ThreadPool* pool = &ThreadPool::global()) {
+        /**
+         * @brief Run the layer over a whole sequence
+         *
+         * @param (NTensor<T>) X: [steps x batch x in]
+         * @param (RecurrentState<T>*) state: initial state (empty = zeros), replaced by the final one; nullptr = zeros
+         *
+         * @return (NTensor<T>) hidden state of every step, [steps x batch x hidden]
+        */
+        if (X.ndim() != 3 || X.shape()[2] != in()) {
+            throw std::runtime_error("Recurrent: input must be [steps x batch x " + std::to_string(in()) + "]");
+        }
+
+        NTensor<T> Y({X.shape()[0], X.shape()[1], hidden()}, (T)0, X.config());
+        forward(X.data(), X.shape()[0], X.shape()[1], Y.data(), state, pool);
+        return Y;
+    }
+
+    void forward(const T* X, size_t steps, size_t batch, T* Y, RecurrentState<T>* state = nullptr,
+                 ThreadPool* pool = &ThreadPool::global()) {
+        const size_t H = hidden(), GH = gates_width();
+
+        std::vector<T> h0(batch * H, (T)0);
+        std::vector<accum_t<T>> c(Cell::has_cell ? batch * H : 0, (accum_t<T>)0);
+        if (state && !state->h.empty()) {
+            if (state->h.size() != batch * H || (Cell::has_cell && state->c.size() != batch * H)) {
+                throw std::runtime_error("Recurrent: state does not match [batch x hidden]");
+            }
+            h0 = state->h;
+            if constexpr (Cell::has_cell) c = state->c;
+        }
+        if (steps == 0) return;
+
+        // input side of every step at once
+        gates_x_.resize(steps * batch * GH);
+        gemm_packed(X, in(), steps * batch, ih_packed_, gates_x_.data(), GH, b_ih_.data(), Activation::IDENTITY, pool);
+
+        gates_h_.resize(batch * GH);
+        for (size_t t = 0; t < steps; ++t) {
+            const T* h_prev = t == 0 ? h0.data() : Y + (t - 1) * batch * H;
+            T* h = Y + t * batch * H;
+
+            gemm_packed(h_prev, H, batch, hh_packed_, gates_h_.data(), GH, b_hh_.data(), Activation::IDENTITY, pool);
+
+            for (size_t b = 0; b < batch; ++b) {
+                Cell::step(gates_x_.data() + (t * batch + b) * GH, gates_h_.data() + b * GH, h_prev + b * H,
+                           Cell::has_cell ? c.data() + b * H : nullptr, h + b * H, H);
+            }
+        }
+
+        if (state) {
+            const T* last = Y + (steps - 1) * batch * H;
+            state->h.assign(last, last + batch * H);
+            if constexpr (Cell::has_cell) state->c = std::move(c);
+        }
+    }
+
+    NTensor<T>& weight_ih() { return w_ih_; }
+    NTensor<T>& weight_hh() { return w_hh_; }
+    NTensor<T>& bias_ih() { return b_ih_; }
+    NTensor<T>& bias_hh() { return b_hh_; }
+    size_t in() { return w_ih_.shape()[0]; }
+    size_t hidden() { return w_hh_.shape()[0]; }
+    size_t gates_width() { return w_ih_.shape()[1]; }
+
+private:
+    NTensor<T> w_ih_, w_hh_;
+    NTensor<T> b_ih_, b_hh_;
+    PackedB<T> ih_packed_, hh_packed_;
+    std::vector<T> gates_x_, gates_h_;
+
+    static NTensor<T> uniform(std::initializer_list<size_t> shape, size_t hidden, NTensorConfig cfg, uint32_t seed) {
+        NTensor<T> w(shape, (T)0, cfg);
+
+        std::mt19937 rng(seed);
+        double limit = 1.0 / std::sqrt((double)hidden);
+        std::uniform_real_distribution<double> dist(-limit, limit);
+        for (size_t i = 0; i < w.size(); ++i) w.data()[i] = (T)dist(rng);
+
+        return w;
+    }
+};
+
+template<typename T = float>
+using LSTM = Recurrent<T, LSTMCell>;
+
+template<typename T = float>
+using GRU = Recurrent<T, GRUCell>;
+
+} // namespace nn
+
+#endif // NN_RECURRENT_HPP
@@ -0,0 +1,415 @@
+#ifndef NN_SEQUENTIAL_HPP
+#define NN_SEQUENTIAL_HPP
+
+#include <conv.hpp>
+#include <gemm.hpp>
+#include <nn/dense.hpp>
+#include <relayout.hpp>
+
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Inference model: a chain of layers built from a weights file.
+ *
+ * load() reads each LayerSpec's tensors ("<name>.weight", "<name>.bias",
+ * BATCHNORM also "<name>.running_mean" / "<name>.running_var") and then runs
+ * simplify(), a load-time pass that rewrites the chain into fewer ops:
+ *
+ *   BATCHNORM / SCALE / BIAS      become one per-channel affine y = a * x + c,
+ *                                 and consecutive affines merge
+ *   standalone ACTIVATION         fused into the epilogue of the op before it
+ *   DENSE / CONV2D -> affine      folded into the weights and bias (W[:, k] *= a[k])
+ *   affine -> DENSE               folded into the Dense (rows of W scaled, c W added to b)
+ *   DENSE -> DENSE                merged into one Dense (W1 W2, b1 W2 + b2) when
+ *                                 the first has no activation and the product is
+ *                                 no larger than the pair (in * out <= mid * (in + out))
+ *
+ * Every rewrite is exact up to rounding. An affine in front of a CONV2D is
+ * left alone: padding would see its offset on real pixels but not on the
+ * zero border.
+ */
+namespace nn {
+
+enum class LayerKind { DENSE, CONV2D, BATCHNORM, SCALE, BIAS, ACTIVATION };
+
+typedef struct LayerSpec {
+    LayerKind kind;
+    std::string name;                       // weights prefix
+    Activation act = Activation::IDENTITY;  // DENSE / CONV2D epilogue, or the ACTIVATION itself
+    Conv2dParams conv = {};
+    double eps = 1e-5;                      // BATCHNORM
+} LayerSpec;
+
+namespace _sequential {
+
+enum class Op { DENSE, CONV2D, AFFINE, ACTIVATION };
+
+template<typename T>
+struct Layer {
+    Op op;
+    std::string name;
+    Activation act = Activation::IDENTITY;
+    Conv2dParams conv = {};
+    std::vector<size_t> shape;  // DENSE [in, out], CONV2D [K, C/groups, R, S]
+    std::vector<T> w;           // DENSE / CONV2D weight; AFFINE scale a
+    std::vector<T> b;           // DENSE / CONV2D bias; AFFINE offset c
+
+    size_t outputs() const { return op == Op::DENSE ? shape[1] : shape[0]; }
+};
+
+template<typename T>
+NTensor<T>* find(std::map<std::string, NTensor<T>>& weights, const std::string& key, bool required) {
+    auto it = weights.find(key);
+    if (it != weights.end()) return &it->second;
+    if (required) throw std::runtime_error("Sequential: missing " + key);
+    return nullptr;
+}
+
+template<typename T>
+std::vector<T> values(NTensor<T>* t, size_t n, T fill, const std::string& what) {
+    if (!t) return std::vector<T>(n, fill);
+    if (t->size() != n) throw std::runtime_error("Sequential: " + what + " has " + std::to_string(t->size()) +
+                                                 " values, expected " + std::to_string(n));
+    return std::vector<T>(t->data(), t->data() + n);
+}
+
+} // namespace _sequential
+
+template<typename T = float>
+class Sequential {
+public:
+    using Layer = _sequential::Layer<T>;
+    using Op = _sequential::Op;
+
+    static Sequential load(const std::vector<LayerSpec>& specs, std::map<std::string, NTensor<T>>& weights,
+                           NTensorConfig cfg, bool optimize = true) {
+        /**
+         * @brief Build the chain from loaded weights and (by default) simplify it
+         *
+         * @param (std::vector<LayerSpec>) specs: layers in execution order
+         * @param (std::map<std::string, NTensor<T>>) weights: e.g. from load_weights(); copied, not kept
+         * @param (bool) optimize: run simplify() before the layers are packed
+        */
+        Sequential m(cfg);
+        for (const LayerSpec& s : specs) m.layers_.push_back(read(s, weights));
+
+        if (optimize) m.simplify();
+        m.compile();
+        return m;
+    }
+
+    void simplify() {
+        /**
+         * @brief Apply the rewrites listed at the top of this file until none applies
+        */
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 0; i + 1 < layers_.size() && !changed; ++i) {
+                changed = rewrite(layers_[i], layers_[i + 1]);
+                if (changed) layers_.erase(layers_.begin() + (long)i + 1);
+            }
+        }
+        compiled_.clear();
+    }
+
+    NTensor<T> forward(NTensor<T>& X, ThreadPool* pool = &ThreadPool::global(),
+                       const std::function<void(size_t, NTensor<T>&)>& observe = {}) {
+        /**
+         * @brief Run the chain
+         *
+         * @param (NTensor<T>) X: [batch x features] or [N x C x H x W] in any layout;
+         *     a 4-D activation entering a DENSE is flattened per image in NCHW order
+         * @param (std::function) observe: called with (layer index, layer input) before each layer
+        */
+        if (compiled_.size() != layers_.size()) compile();
+
+        NTensor<T> cur = copy(X);
+        for (size_t i = 0; i < layers_.size(); ++i) {
+            Layer& l = layers_[i];
+            if (l.op == Op::DENSE && cur.ndim() != 2) cur = flatten(cur, pool);
+            if (observe) observe(i, cur);
+
+            switch (l.op) {
+            case Op::DENSE:
+                cur = compiled_[i].dense->forward(cur, pool);
+                break;
+            case Op::CONV2D:
+                cur = conv2d(cur, *compiled_[i].weight, l.b.data(), l.conv, ConvAlgo::AUTO, l.act, pool);
+                break;
+            case Op::AFFINE:
+                affine(cur, l.w.data(), l.b.data(), l.w.size());
+                activate(cur, l.act);
+                break;
+            case Op::ACTIVATION:
+                activate(cur, l.act);
+                break;
+            }
+        }
+        return cur;
+    }
+
+    std::string describe() {
+        /**
+         * @brief One line per layer, e.g. "dense fc1+fc2 784x10 relu"
+        */
+        std::string out;
+        for (Layer& l : layers_) {
+            switch (l.op) {
+            case Op::DENSE:
+                out += "dense " + l.name + " " + std::to_string(l.shape[0]) + "x" + std::to_string(l.shape[1]);
+                break;
+            case Op::CONV2D:
+                out += "conv2d " + l.name + " " + std::to_string(l.shape[2]) + "x" + std::to_string(l.shape[3]) + " " +
+                       std::to_string(l.shape[1] * l.conv.groups) + "->" + std::to_string(l.shape[0]);
+                break;
+            case Op::AFFINE:
+                out += "affine " + l.name + " " + std::to_string(l.w.size());
+                break;
+            case Op::ACTIVATION:
+                out += "activation " + l.name;
+                break;
+            }
+            out += std::string(" ") + activation_name(l.act) + "\n";
+        }
+        return out;
+    }
+
+    size_t size() const { return layers_.size(); }
+    std::vector<Layer>& layers() { return layers_; }
+
+private:
+    struct Compiled {
+        std::unique_ptr<Dense<T>> dense;
+        std::optional<NTensor<T>> weight;
+    };
+
+    explicit Sequential(NTensorConfig cfg) : cfg_(cfg) {}
+
+    NTensorConfig cfg_;
+    std::vector<Layer> layers_;
+    std::vector<Compiled> compiled_;
+
+    static Layer read(const LayerSpec& s, std::map<std::string, NTensor<T>>& weights) {
+        using namespace _sequential;
+        Layer l;
+        l.name = s.name;
+        l.act = s.act;
+
+        switch (s.kind) {
+        case LayerKind::DENSE:
+        case LayerKind::CONV2D: {
+            NTensor<T>* w = find(weights, s.name + ".weight", true);
+            const size_t want = s.kind == LayerKind::DENSE ? 2 : 4;
+            if (w->ndim() != want) {
+                throw std::runtime_error("Sequential: " + s.name + ".weight must be " + std::to_string(want) + "-D");
+            }
+            l.op = s.kind == LayerKind::DENSE ? Op::DENSE : Op::CONV2D;
+            l.conv = s.conv;
+            l.shape.assign(w->shape(), w->shape() + w->ndim());
+            l.w.assign(w->data(), w->data() + w->size());
+            l.b = values(find(weights, s.name + ".bias", false), l.outputs(), (T)0, s.name + ".bias");
+            return l;
+        }
+        case LayerKind::BATCHNORM: {
+            NTensor<T>* mean = find(weights, s.name + ".running_mean", true);
+            const size_t C = mean->size();
+            std::vector<T> mu = values(mean, C, (T)0, s.name + ".running_mean");
+            std::vector<T> var = values(find(weights, s.name + ".running_var", true), C, (T)0, s.name + ".running_var");
+            std::vector<T> gamma = values(find(weights, s.name + ".weight", false), C, (T)1, s.name + ".weight");
+            std::vector<T> beta = values(find(weights, s.name + ".bias", false), C, (T)0, s.name + ".bias");
+
+            // y = gamma (x - mu) / sqrt(var + eps) + beta = a x + c
+            l.op = Op::AFFINE;
+            l.w.resize(C);
+            l.b.resize(C);
+            for (size_t k = 0; k < C; ++k) {
+                const double a = (double)gamma[k] / std::sqrt((double)var[k] + s.eps);
+                l.w[k] = (T)a;
+                l.b[k] = (T)((double)beta[k] - a * (double)mu[k]);
+            }
+            return l;
+        }
+        case LayerKind::SCALE: {
+            NTensor<T>* w = find(weights, s.name + ".weight", true);
+            l.op = Op::AFFINE;
+            l.w = values(w, w->size(), (T)1, s.name + ".weight");
+            l.b = values(find(weights, s.name + ".bias", false), w->size(), (T)0, s.name + ".bias");
+            return l;
+        }
+        case LayerKind::BIAS: {
+            NTensor<T>* b = find(weights, s.name + ".bias", true);
+            l.op = Op::AFFINE;
+            l.w.assign(b->size(), (T)1);
+            l.b = values(b, b->size(), (T)0, s.name + ".bias");
+            return l;
+        }
+        case LayerKind::ACTIVATION:
+            l.op = Op::ACTIVATION;
+            return l;
+        }
+        throw std::runtime_error("Sequential: unknown layer kind");
+    }
+
+    bool rewrite(Layer& x, Layer& y) {
+        // y is erased when this returns true
+        const bool linear = x.act == Activation::IDENTITY;
+
+        if (y.op == Op::ACTIVATION && linear && x.op != Op::ACTIVATION) {
+            x.act = y.act;
+            return true;
+        }
+
+        if (y.op == Op::AFFINE && linear && x.op == Op::AFFINE && x.w.size() == y.w.size()) {
+            for (size_t k = 0; k < x.w.size(); ++k) {
+                x.b[k] = x.b[k] * y.w[k] + y.b[k];
+                x.w[k] = x.w[k] * y.w[k];
+            }
+            x.name += "+" + y.name;
+            x.act = y.act;
+            return true;
+        }
+
+        if (y.op == Op::AFFINE && linear && (x.op == Op::DENSE || x.op == Op::CONV2D) && y.w.size() == x.outputs()) {
+            const size_t K = x.outputs();
+            if (x.op == Op::DENSE) {
+                // W [in x out]: column k scales
+                for (size_t i = 0; i < x.shape[0]; ++i)
+                    for (size_t k = 0; k < K; ++k) x.w[i * K + k] *= y.w[k];
+            } else {
+                // W [K x C/groups x R x S]: filter k scales
+                const size_t per = x.w.size() / K;
+                for (size_t k = 0; k < K; ++k)
+                    for (size_t j = 0; j < per; ++j) x.w[k * per + j] *= y.w[k];
+            }
+            for (size_t k = 0; k < K; ++k) x.b[k] = x.b[k] * y.w[k] + y.b[k];
+            x.name += "+" + y.name;
+            x.act = y.act;
+            return true;
+        }
+
+        if (x.op == Op::AFFINE && linear && y.op == Op::DENSE && x.w.size() == y.shape[0]) {
+            // (a . x + c) W + b = x (diag(a) W) + (c W + b)
+            const size_t in = y.shape[0], out = y.shape[1];
+            for (size_t i = 0; i < in; ++i) {
+                for (size_t j = 0; j < out; ++j) {
+                    y.b[j] += x.b[i] * y.w[i * out + j];
+                    y.w[i * out + j] *= x.w[i];
+                }
+            }
+            y.name = x.name + "+" + y.name;
+            std::swap(x, y);
+            return true;
+        }
+
+        if (x.op == Op::DENSE && linear && y.op == Op::DENSE) {
+            const size_t in = x.shape[0], mid = x.shape[1], out = y.shape[1];
+            if (in * out > mid * (in + out)) return false;
+
+            NTensor<T> w1({in, mid}, (T)0, cfg_), w2({mid, out}, (T)0, cfg_);
+            std::copy(x.w.begin(), x.w.end(), w1.data());
+            std::copy(y.w.begin(), y.w.end(), w2.data());
+            NTensor<T> w = tiled_matmul(w1, w2, ThreadPool::global());
+
+            std::vector<T> b(y.b);
+            for (size_t k = 0; k < mid; ++k)
+                for (size_t j = 0; j < out; ++j) b[j] += x.b[k] * y.w[k * out + j];
+
+            x.w.assign(w.data(), w.data() + w.size());
+            x.b = std::move(b);
+            x.shape = {in, out};
+            x.name += "+" + y.name;
+            x.act = y.act;
+            return true;
+        }
+
+        return false;
+    }
+
+    void compile() {
+        compiled_.clear();
+        compiled_.resize(layers_.size());
+
+        for (size_t i = 0; i < layers_.size(); ++i) {
+            Layer& l = layers_[i];
+            if (l.op != Op::DENSE && l.op != Op::CONV2D) continue;
+
+            NTensor<T> w(l.shape, (T)0, cfg_);
+            std::copy(l.w.begin(), l.w.end(), w.data());
+
+            if (l.op == Op::DENSE) {
+                NTensor<T> b({l.shape[1]}, (T)0, cfg_);
+                std::copy(l.b.begin(), l.b.end(), b.data());
+                compiled_[i].dense = std::make_unique<Dense<T>>(std::move(w), std::move(b), l.act);
+            } else {
+                compiled_[i].weight.emplace(std::move(w));
+            }
+        }
+    }
+
+    NTensor<T> copy(NTensor<T>& x) {
+        NTensor<T> y(std::vector<size_t>(x.shape(), x.shape() + x.ndim()), (T)0, x.config());
+        std::copy(x.data(), x.data() + x.size(), y.data());
+        y.set_layout(x.layout());
+        return y;
+    }
+
+    NTensor<T> flatten(NTensor<T>& x, ThreadPool* pool) {
+        NTensor<T> xn = x.layout().kind == Layout::NCHW ? copy(x) : to_layout(x, TensorLayout::nchw(), pool);
+        const size_t N = xn.shape()[0];
+
+        NTensor<T> y({N, xn.size() / N}, (T)0, xn.config());
+        std::copy(xn.data(), xn.data() + xn.size(), y.data());
+        return y;
+    }
+
+    static void affine(NTensor<T>& x, const T* a, const T* c, size_t C) {
+        if (x.ndim() == 2) {
+            if (x.shape()[1] != C) throw std::runtime_error("Sequential: affine over " + std::to_string(C) + " channels");
+            for (size_t r = 0; r < x.shape()[0]; ++r) {
+                T* row = x.data() + r * C;
+                for (size_t k = 0; k < C; ++k) row[k] = row[k] * a[k] + c[k];
+            }
+            return;
+        }
+
+        auto [N, Cx, H, W] = nchw_dims(x);
+        if (Cx != C) throw std::runtime_error("Sequential: affine over " + std::to_string(C) + " channels");
+
+        ActView<T> v = ActView<T>::of(x.data(), N, C, H, W, x.layout());
+        for (size_t n = 0; n < N; ++n) {
+            for (size_t k = 0; k < C; ++k) {
+                T* p = v.chan(n, k);
+                for (size_t i = 0; i < H * W; ++i) p[i * v.b] = p[i * v.b] * a[k] + c[k];
+            }
+        }
+    }
+
+    static void activate(NTensor<T>& x, Activation act) {
+        if (act == Activation::IDENTITY) return;
+        activate_inplace(x.data(), x.size(), act);
+
+        // NCHWc padding channels must stay zero (sigmoid(0) is not)
+        const TensorLayout& l = x.layout();
+        if (x.ndim() == 5 && l.kind == Layout::NCHWc && l.channels % l.block != 0) {
+            auto [N, C, H, W] = nchw_dims(x);
+            ActView<T> v = ActView<T>::of(x.data(), N, C, H, W, l);
+            for (size_t n = 0; n < N; ++n) {
+                T* last = v.chan(n, C - 1) - (C - 1) % v.b;
+                for (size_t i = 0; i < H * W; ++i)
+                    for (size_t k = C % v.b; k < v.b; ++k) last[i * v.b + k] = (T)0;
+            }
+        }
+    }
+};
+
+} // namespace nn
+
+#endif // NN_SEQUENTIAL_HPP
@@ -0,0 +1,314 @@
+#ifndef NORM_HPP
+#define NORM_HPP
+
+#include <half.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+#include <vmath.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Fused row-wise kernels over the last axis of a [rows x cols] row-major
+ * array: softmax, log-softmax, layernorm, RMSnorm and softmax cross-entropy
+ * (forward and gradient together).
+ *
+ * Each row is read at most twice and written once, a row at a time, so the
+ * second pass finds it in L1/L2 instead of going back to memory the way a
+ * chain of max() / sub / exp / sum() / div ops would:
+ *
+ *   softmax        max | exp, store, sum | scale (in place, cached)
+ *   log_softmax    max | sum exp         | x - max - log(sum)
+ *   layernorm      sum and sum of squares (shifted by x[0]) | normalise
+ *   rmsnorm        sum of squares | normalise
+ *
+ * float rows run on VMATH_LANES-wide vectors with the vmath.hpp exp / log;
+ * other types use scalar loops accumulating in accum_t<T>. Rows are split
+ * across the pool in tasks of about NORM_TASK_ELEMS elements.
+ */
+constexpr size_t NORM_TASK_ELEMS = 1 << 15;
+
+namespace _norm {
+
+using _vmath::vf;
+
+template<typename T>
+void softmax_row(const T* x, T* y, size_t n) {
+    if constexpr (std::is_same_v<T, float>) {
+        const float m = vreduce_max(x, n);
+        const float inv = 1.0f / vexp_sum(x, y, n, m);
+        for (size_t i = 0; i < n; ++i) y[i] *= inv;
+    } else {
+        using Acc = accum_t<T>;
+        Acc m = -std::numeric_limits<Acc>::infinity();
+        for (size_t i = 0; i < n; ++i) m = std::max(m, (Acc)x[i]);
+
+        Acc s = 0;
+        for (size_t i = 0; i < n; ++i) s += std::exp((Acc)x[i] - m);
+
+        const Acc inv = (Acc)1 / s;
+        for (size_t i = 0; i < n; ++i) y[i] = (T)(std::exp((Acc)x[i] - m) * inv);
+    }
+}
+
+template<typename T>
+void log_softmax_row(const T* x, T* y, size_t n) {
+    if constexpr (std::is_same_v<T, float>) {
+        const float m = vreduce_max(x, n);
+        const float shift = m + std::log(vexp_sum(x, nullptr, n, m));
+        for (size_t i = 0; i < n; ++i) y[i] = x[i] - shift;
+    } else {
+        using Acc = accum_t<T>;
+        Acc m = -std::numeric_limits<Acc>::infinity();
+        for (size_t i = 0; i < n; ++i) m = std::max(m, (Acc)x[i]);
+
+        Acc s = 0;
+        for (size_t i = 0; i < n; ++i) s += std::exp((Acc)x[i] - m);
+
+        const Acc shift = m + std::log(s);
+        for (size_t i = 0; i < n; ++i) y[i] = (T)((Acc)x[i] - shift);
+    }
+}
+
+// sum(x - k) and sum((x - k)^2) in one pass
+template<typename T>
+void shifted_moments(const T* x, size_t n, accum_t<T> k, accum_t<T>& s1, accum_t<T>& s2) {
+    using Acc = accum_t<T>;
+    if constexpr (std::is_same_v<T, float>) {
+        const vf kv = _vmath::splat(k);
+        vf a = _vmath::splat(0.0f), b = _vmath::splat(0.0f);
+
+        size_t i = 0;
+        for (; i + VMATH_LANES <= n; i += VMATH_LANES) {
+            vf d = _vmath::load(x + i) - kv;
+            a += d;
+            b += d * d;
+        }
+        s1 = _vmath::hsum(a);
+        s2 = _vmath::hsum(b);
+        for (; i < n; ++i) {
+            const float d = x[i] - k;
+            s1 += d;
+            s2 += d * d;
+        }
+    } else {
+        s1 = s2 = (Acc)0;
+        for (size_t i = 0; i < n; ++i) {
+            const Acc d = (Acc)x[i] - k;
+            s1 += d;
+            s2 += d * d;
+        }
+    }
+}
+
+template<typename T>
+void layernorm_row(const T* x, T* y, size_t n, const T* gamma, const T* beta, accum_t<T> eps) {
+    using Acc = accum_t<T>;
+
+    // shifting by the first element keeps E[x^2] - E[x]^2 from cancelling when |mean| >> std
+    Acc s1, s2;
+    const Acc k = (Acc)x[0];
+    shifted_moments(x, n, k, s1, s2);
+
+    const Acc d = s1 / (Acc)n;
+    const Acc var = std::max(s2 / (Acc)n - d * d, (Acc)0);
+    const Acc mean = k + d, rstd = (Acc)1 / std::sqrt(var + eps);
+
+    for (size_t i = 0; i < n; ++i) {
+        Acc v = ((Acc)x[i] - mean) * rstd;
+        if (gamma) v *= (Acc)gamma[i];
+        if (beta) v += (Acc)beta[i];
+        y[i] = (T)v;
+    }
+}
+
+template<typename T>
+void rmsnorm_row(const T* x, T* y, size_t n, const T* gamma, accum_t<T> eps) {
+    using Acc = accum_t<T>;
+
+    Acc s1, s2;
+    shifted_moments(x, n, (Acc)0, s1, s2);
+    const Acc r = (Acc)1 / std::sqrt(s2 / (Acc)n + eps);
+
+    for (size_t i = 0; i < n; ++i) y[i] = (T)((Acc)x[i] * r * (gamma ? (Acc)gamma[i] : (Acc)1));
+}
+
+// rows per task so each task touches about NORM_TASK_ELEMS elements
+inline size_t row_grain(size_t cols) { return std::max<size_t>(1, NORM_TASK_ELEMS / std::max<size_t>(cols, 1)); }
+
+template<typename F>
+void for_rows(size_t rows, size_t cols, ThreadPool* pool, F&& row) {
+    auto body = [&](size_t lo, size_t hi) {
+        for (size_t r = lo; r < hi; ++r) row(r);
+    };
+
+    if (pool) pool->parallel_for(0, rows, row_grain(cols), body);
+    else body(0, rows);
+}
+
+} // namespace _norm
+
+template<typename T = float>
+void softmax(const T* x, T* y, size_t rows, size_t cols, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief y = softmax(x) along each row; y may equal x
+    */
+    _norm::for_rows(rows, cols, pool, [&](size_t r) { _norm::softmax_row(x + r * cols, y + r * cols, cols); });
+}
+
+template<typename T = float>
+void log_softmax(const T* x, T* y, size_t rows, size_t cols, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief y = x - logsumexp(x) along each row; y may equal x
+    */
+    _norm::for_rows(rows, cols, pool, [&](size_t r) { _norm::log_softmax_row(x + r * cols, y + r * cols, cols); });
+}
+
+template<typename T = float>
+void layernorm(const T* x, T* y, size_t rows, size_t cols, const T* gamma = nullptr, const T* beta = nullptr,
+               double eps = 1e-5, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief y = (x - mean) / sqrt(var + eps) * gamma + beta along each row; y may equal x
+     *
+     * @param (const T*) gamma: cols scales, or nullptr for 1
+     * @param (const T*) beta: cols shifts, or nullptr for 0
+    */
+    _norm::for_rows(rows, cols, pool, [&](size_t r) {
+        _norm::layernorm_row(x + r * cols, y + r * cols, cols, gamma, beta, (accum_t<T>)eps);
+    });
+}
+
+template<typename T = float>
+void rmsnorm(const T* x, T* y, size_t rows, size_t cols, const T* gamma = nullptr,
+             double eps = 1e-6, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief y = x / sqrt(mean(x^2) + eps) * gamma along each row; y may equal x
+    */
+    _norm::for_rows(rows, cols, pool, [&](size_t r) {
+        _norm::rmsnorm_row(x + r * cols, y + r * cols, cols, gamma, (accum_t<T>)eps);
+    });
+}
+
+template<typename T = float>
+double softmax_cross_entropy(const T* logits, const size_t* labels, size_t rows, size_t cols,
+                             T* grad = nullptr, double grad_scale = 0.0, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Mean over rows of -log softmax(logits)[label], and optionally its gradient
+     *
+     * One kernel for the forward and backward: the exponentials computed for
+     * the loss are written to grad and scaled in place into
+     * grad_scale * (softmax - onehot(label)) while the row is still cached.
+     *
+     * @param (const size_t*) labels: rows class indices in [0, cols)
+     * @param (T*) grad: [rows x cols] output, or nullptr for the loss only
+     * @param (double) grad_scale: multiplies the gradient; 0 = 1 / rows (gradient of the mean)
+     *
+     * @return (double) mean loss
+    */
+    if (rows == 0) return 0.0;
+    for (size_t r = 0; r < rows; ++r) {
+        if (labels[r] >= cols) {
+            throw std::runtime_error("softmax_cross_entropy: label " + std::to_string(labels[r]) +
+                                     " out of range for " + std::to_string(cols) + " classes");
+        }
+    }
+
+    using Acc = accum_t<T>;
+    const Acc gs = (Acc)(grad_scale != 0.0 ? grad_scale : 1.0 / (double)rows);
+    const size_t grain = _norm::row_grain(cols);
+    std::vector<double> partial((rows + grain - 1) / grain, 0.0);
+
+    auto body = [&](size_t lo, size_t hi) {
+        double loss = 0.0;
+
+        for (size_t r = lo; r < hi; ++r) {
+            const T* x = logits + r * cols;
+            T* g = grad ? grad + r * cols : nullptr;
+
+            Acc m, s;
+            if constexpr (std::is_same_v<T, float>) {
+                m = vreduce_max(x, cols);
+                s = vexp_sum(x, g, cols, m);
+            } else {
+                m = -std::numeric_limits<Acc>::infinity();
+                for (size_t i = 0; i < cols; ++i) m = std::max(m, (Acc)x[i]);
+                s = (Acc)0;
+                for (size_t i = 0; i < cols; ++i) {
+                    const Acc e = std::exp((Acc)x[i] - m);
+                    if (g) g[i] = (T)e;
+                    s += e;
+                }
+            }
+
+            loss += (double)(m + std::log(s) - (Acc)x[labels[r]]);
+
+            if (g) {
+                const Acc k = gs / s;
+                for (size_t i = 0; i < cols; ++i) g[i] = (T)((Acc)g[i] * k);
+                g[labels[r]] = (T)((Acc)g[labels[r]] - gs);
+            }
+        }
+
+        partial[lo / grain] = loss;
+    };
+
+    if (pool) pool->parallel_for(0, rows, grain, body);
+    else body(0, rows);
+
+    double total = 0.0;
+    for (double p : partial) total += p;
+    return total / (double)rows;
+}
+
+template<typename T = float>
+NTensor<T> softmax(NTensor<T>& x, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief softmax over the last axis
+    */
+    const size_t cols = x.shape()[x.ndim() - 1];
+    NTensor<T> y(std::vector<size_t>(x.shape(), x.shape() + x.ndim()), (T)0, x.config());
+    softmax(x.data(), y.data(), x.size() / cols, cols, pool);
+    return y;
+}
+
+template<typename T = float>
+NTensor<T> log_softmax(NTensor<T>& x, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief log-softmax over the last axis
+    */
+    const size_t cols = x.shape()[x.ndim() - 1];
+    NTensor<T> y(std::vector<size_t>(x.shape(), x.shape() + x.ndim()), (T)0, x.config());
+    log_softmax(x.data(), y.data(), x.size() / cols, cols, pool);
+    return y;
+}
+
+template<typename T = float>
+NTensor<T> layernorm(NTensor<T>& x, const T* gamma = nullptr, const T* beta = nullptr, double eps = 1e-5,
+                     ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief layernorm over the last axis
+    */
+    const size_t cols = x.shape()[x.ndim() - 1];
+    NTensor<T> y(std::vector<size_t>(x.shape(), x.shape() + x.ndim()), (T)0, x.config());
+    layernorm(x.data(), y.data(), x.size() / cols, cols, gamma, beta, eps, pool);
+    return y;
+}
+
+template<typename T = float>
+NTensor<T> rmsnorm(NTensor<T>& x, const T* gamma = nullptr, double eps = 1e-6, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief RMSnorm over the last axis
+    */
+    const size_t cols = x.shape()[x.ndim() - 1];
+    NTensor<T> y(std::vector<size_t>(x.shape(), x.shape() + x.ndim()), (T)0, x.config());
+    rmsnorm(x.data(), y.data(), x.size() / cols, cols, gamma, eps, pool);
+    return y;
+}
+
+#endif // NORM_HPP
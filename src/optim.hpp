@@ -0,0 +1,337 @@
+#ifndef OPTIM_HPP
+#define OPTIM_HPP
+
+#include <autograd.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Fused optimizer steps. Each kernel reads the gradient once and updates the
+ * parameter and its state buffers in the same pass, in place, with no
+ * temporaries; parameters are cut into OPTIM_CHUNK-element chunks that run as
+ * pool tasks.
+ *
+ * Optimizer<P, M>: parameters are stored as P, optimizer state (and, when
+ * M != P, a master copy of every parameter) as M. With P a 16-bit type and
+ * M = float, updates accumulate in full precision and the P tensor is
+ * refreshed from the master copy after every step.
+ *
+ * A parameter's gradient can also be SparseRows: only the listed rows of a
+ * [rows x cols] parameter are updated, and only their state moves ("lazy"
+ * updates, as in SparseAdam). Untouched rows are never read, so tables far
+ * too large for a dense gradient (embeddings) can be trained.
+ */
+constexpr size_t OPTIM_CHUNK = 1 << 14;
+
+typedef struct SGDConfig {
+    double lr = 1e-2;
+    double momentum = 0.9;
+    double weight_decay = 0.0;
+    bool nesterov = false;
+} SGDConfig;
+
+typedef struct AdamConfig {
+    double lr = 1e-3;
+    double beta1 = 0.9;
+    double beta2 = 0.999;
+    double eps = 1e-8;
+    double weight_decay = 0.0;
+    bool decoupled_weight_decay = false;  // AdamW: decay the weight directly instead of adding to the gradient
+} AdamConfig;
+
+// gradient of a [rows x cols] parameter that is zero outside the listed rows
+template<typename T = float>
+struct SparseRows {
+    size_t cols = 0;
+    std::vector<size_t> rows;       // distinct row indices
+    std::vector<T> values;          // [rows.size() x cols], row k is the gradient of rows[k]
+};
+
+template<typename P, typename M>
+void sgd_kernel(P* param, M* master, const P* grad, M* mom, size_t n,
+                M lr, M mu, M wd, bool nesterov, M grad_scale) {
+    /**
+     * @brief v = mu * v + (g + wd * w);  w -= lr * (nesterov ? g + mu * v : v)
+     *
+     * @param (M*) master: full-precision weights, nullptr when P == M (param is updated directly)
+     * @param (M) grad_scale: multiplies every gradient first, e.g. 1 / loss_scale
+    */
+    for (size_t i = 0; i < n; ++i) {
+        M w;
+        if constexpr (std::is_same_v<P, M>) w = master ? master[i] : param[i];
+        else w = master[i];
+
+        M g = (M)grad[i] * grad_scale + wd * w;
+        M v = mu * mom[i] + g;
+        mom[i] = v;
+
+        w -= lr * (nesterov ? g + mu * v : v);
+
+        if (master) master[i] = w;
+        param[i] = (P)w;
+    }
+}
+
+template<typename P, typename M>
+void adam_kernel(P* param, M* master, const P* grad, M* m, M* v, size_t n,
+                 M lr, M b1, M b2, M eps, M wd, bool decoupled, M bc1, M bc2, M grad_scale) {
+    /**
+     * @brief One Adam/AdamW update, bias-corrected with bc1 = 1 - b1^t, bc2 = 1 - b2^t
+    */
+    const M step = lr / bc1;
+    const M inv_sqrt_bc2 = (M)1 / std::sqrt(bc2);
+    const M decay = decoupled ? (M)1 - lr * wd : (M)1;
+    const M l2 = decoupled ? (M)0 : wd;
+
+    for (size_t i = 0; i < n; ++i) {
+        M w;
+        if constexpr (std::is_same_v<P, M>) w = master ? master[i] : param[i];
+        else w = master[i];
+
+        M g = (M)grad[i] * grad_scale + l2 * w;
+        M mi = b1 * m[i] + ((M)1 - b1) * g;
+        M vi = b2 * v[i] + ((M)1 - b2) * g * g;
+        m[i] = mi;
+        v[i] = vi;
+
+        w = w * decay - step * mi / (std::sqrt(vi) * inv_sqrt_bc2 + eps);
+
+        if (master) master[i] = w;
+        param[i] = (P)w;
+    }
+}
+
+template<typename P = float, typename M = P>
+class Optimizer {
+public:
+    explicit Optimizer(ThreadPool* pool = &ThreadPool::global())
+        : pool_(pool)
+    {}
+
+    virtual ~Optimizer() = default;
+
+    Optimizer(const Optimizer&) = delete;
+    Optimizer& operator=(const Optimizer&) = delete;
+
+    void add_param(NTensor<P>& p) {
+        /**
+         * @brief Register a parameter; its state buffers start at zero
+         *
+         * The tensor is updated in place and must outlive the optimizer.
+        */
+        Param q;
+        q.tensor = &p;
+        q.state.assign(state_buffers() * p.size(), (M)0);
+        if (!std::is_same_v<P, M>) q.master.assign(p.data(), p.data() + p.size());
+
+        for (size_t lo = 0; lo < p.size(); lo += OPTIM_CHUNK) {
+            chunks_.push_back(Chunk{params_.size(), lo, std::min(lo + OPTIM_CHUNK, p.size())});
+        }
+        params_.push_back(std::move(q));
+    }
+
+    void step(const std::vector<const P*>& grads, M grad_scale = (M)1) {
+        /**
+         * @brief Apply one update to every parameter
+         *
+         * @param (std::vector<const P*>) grads: one gradient per add_param() call, in order;
+         *     nullptr skips that parameter
+         * @param (M) grad_scale: multiplies every gradient inside the kernel
+        */
+        step(grads, {}, grad_scale);
+    }
+
+    void step(const std::vector<const P*>& grads, const std::vector<const SparseRows<P>*>& sparse,
+              M grad_scale = (M)1) {
+        /**
+         * @brief step() where some parameters have row-sparse gradients
+         *
+         * @param (std::vector<const SparseRows<P>*>) sparse: empty, or one entry per parameter;
+         *     a non-null entry replaces grads[i] and updates only its rows
+        */
+        if (grads.size() != params_.size() || (!sparse.empty() && sparse.size() != params_.size())) {
+            throw std::runtime_error("Optimizer: expected " + std::to_string(params_.size()) + " gradients");
+        }
+
+        // sparse rows of every parameter, OPTIM_CHUNK elements' worth per task
+        std::vector<Chunk> rows;
+        for (size_t i = 0; i < sparse.size(); ++i) {
+            const SparseRows<P>* s = sparse[i];
+            if (!s) continue;
+
+            const size_t n = params_[i].tensor->size();
+            if (s->cols == 0 || n % s->cols != 0 || s->values.size() != s->rows.size() * s->cols) {
+                throw std::runtime_error("Optimizer: sparse gradient does not match parameter " + std::to_string(i));
+            }
+            // a repeated row would be stepped twice, and raced on when it lands in two chunks
+            std::vector<size_t> sorted = s->rows;
+            std::sort(sorted.begin(), sorted.end());
+            if (!sorted.empty() && sorted.back() >= n / s->cols) {
+                throw std::runtime_error("Optimizer: sparse gradient row out of range");
+            }
+            if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+                throw std::runtime_error("Optimizer: sparse gradient rows must be distinct");
+            }
+
+            const size_t per = std::max<size_t>(1, OPTIM_CHUNK / s->cols);
+            for (size_t lo = 0; lo < s->rows.size(); lo += per) {
+                rows.push_back(Chunk{i, lo, std::min(lo + per, s->rows.size())});
+            }
+        }
+
+        ++steps_;
+        begin_step();
+
+        auto dense = [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                const Chunk& ch = chunks_[c];
+                const P* g = grads[ch.param];
+                if (g && (sparse.empty() || !sparse[ch.param])) update(params_[ch.param], ch.lo, ch.hi, g + ch.lo, grad_scale);
+            }
+        };
+
+        auto rowwise = [&](size_t lo, size_t hi) {
+            for (size_t c = lo; c < hi; ++c) {
+                const Chunk& ch = rows[c];
+                const SparseRows<P>& s = *sparse[ch.param];
+                for (size_t k = ch.lo; k < ch.hi; ++k) {
+                    const size_t e = s.rows[k] * s.cols;
+                    update(params_[ch.param], e, e + s.cols, s.values.data() + k * s.cols, grad_scale);
+                }
+            }
+        };
+
+        if (pool_) {
+            pool_->parallel_for(0, chunks_.size(), 1, dense);
+            if (!rows.empty()) pool_->parallel_for(0, rows.size(), 1, rowwise);
+        } else {
+            dense(0, chunks_.size());
+            rowwise(0, rows.size());
+        }
+    }
+
+    void step(Tape<P>& tape, M grad_scale = (M)1) {
+        /**
+         * @brief step() with each parameter's gradient taken from tape (after backward)
+        */
+        std::vector<const P*> grads(params_.size());
+        for (size_t i = 0; i < params_.size(); ++i) grads[i] = tape.grad(*params_[i].tensor);
+        step(grads, grad_scale);
+    }
+
+    NTensor<P>& param(size_t i) { return *params_[i].tensor; }
+    M* master(size_t i) { return params_[i].master.empty() ? nullptr : params_[i].master.data(); }
+    size_t steps() const { return steps_; }
+    size_t size() const { return params_.size(); }
+
+protected:
+    struct Param {
+        NTensor<P>* tensor;
+        std::vector<M> master;  // empty when P == M
+        std::vector<M> state;   // state_buffers() consecutive buffers of tensor->size()
+    };
+
+    struct Chunk {
+        size_t param, lo, hi;
+    };
+
+    virtual size_t state_buffers() const = 0;
+    virtual void begin_step() {}
+    // elements [lo, hi) of p; grad points at the gradient of element lo
+    virtual void update(Param& p, size_t lo, size_t hi, const P* grad, M grad_scale) = 0;
+
+    size_t steps_ = 0;
+
+private:
+    ThreadPool* pool_;
+    std::vector<Param> params_;
+    std::vector<Chunk> chunks_;
+};
+
+template<typename P = float, typename M = P>
+class SGD : public Optimizer<P, M> {
+public:
+    using Param = typename Optimizer<P, M>::Param;
+
+    explicit SGD(SGDConfig cfg, ThreadPool* pool = &ThreadPool::global())
+        : Optimizer<P, M>(pool), cfg_(cfg)
+    {
+        /**
+         * @brief SGD with (optionally Nesterov) momentum and L2 weight decay
+        */
+    }
+
+    SGDConfig& config() { return cfg_; }
+
+protected:
+    size_t state_buffers() const override { return 1; }
+
+    void update(Param& p, size_t lo, size_t hi, const P* grad, M grad_scale) override {
+        M* master = p.master.empty() ? nullptr : p.master.data() + lo;
+        sgd_kernel<P, M>(p.tensor->data() + lo, master, grad, p.state.data() + lo, hi - lo,
+                         (M)cfg_.lr, (M)cfg_.momentum, (M)cfg_.weight_decay, cfg_.nesterov, grad_scale);
+    }
+
+private:
+    SGDConfig cfg_;
+};
+
+template<typename P = float, typename M = P>
+class Adam : public Optimizer<P, M> {
+public:
+    using Param = typename Optimizer<P, M>::Param;
+
+    explicit Adam(AdamConfig cfg, ThreadPool* pool = &ThreadPool::global())
+        : Optimizer<P, M>(pool), cfg_(cfg)
+    {
+        /**
+         * @brief Adam; with cfg.decoupled_weight_decay this is AdamW
+        */
+    }
+
+    AdamConfig& config() { return cfg_; }
+
+protected:
+    size_t state_buffers() const override { return 2; }
+
+    void begin_step() override {
+        bc1_ = (M)(1.0 - std::pow(cfg_.beta1, (double)this->steps_));
+        bc2_ = (M)(1.0 - std::pow(cfg_.beta2, (double)this->steps_));
+    }
+
+    void update(Param& p, size_t lo, size_t hi, const P* grad, M grad_scale) override {
+        const size_t n = p.tensor->size();
+        M* master = p.master.empty() ? nullptr : p.master.data() + lo;
+
+        adam_kernel<P, M>(p.tensor->data() + lo, master, grad,
+                          p.state.data() + lo, p.state.data() + n + lo, hi - lo,
+                          (M)cfg_.lr, (M)cfg_.beta1, (M)cfg_.beta2, (M)cfg_.eps, (M)cfg_.weight_decay,
+                          cfg_.decoupled_weight_decay, bc1_, bc2_, grad_scale);
+    }
+
+private:
+    AdamConfig cfg_;
+    M bc1_ = (M)1, bc2_ = (M)1;
+};
+
+template<typename P = float, typename M = P>
+class AdamW : public Adam<P, M> {
+public:
+    explicit AdamW(AdamConfig cfg, ThreadPool* pool = &ThreadPool::global())
+        : Adam<P, M>(decoupled(cfg), pool)
+    {}
+
+private:
+    static AdamConfig decoupled(AdamConfig cfg) {
+        cfg.decoupled_weight_decay = true;
+        return cfg;
+    }
+};
+
+#endif // OPTIM_HPP
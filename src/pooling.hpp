@@ -0,0 +1,397 @@
+#ifndef POOLING_HPP
+#define POOLING_HPP
+
+#include <half.hpp>
+#include <relayout.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Max / average / global pooling and nearest / bilinear upsampling.
+ *
+ * Inputs are [N, C, L] (1-D, treated as H = 1) or [N, C, H, W] activations
+ * in any layout.hpp layout; outputs keep the input's layout. Every kernel
+ * works on a "lane group" of one image: one channel plane in NCHW, one
+ * channel block in NCHWc, or a run of up to POOL_LANES channels in NHWC, with
+ * pixel stride b. Tasks are (image, lane group) pairs on the thread pool.
+ *
+ * Windowed pooling is separable: each input row is reduced across kernel_w
+ * once into a row buffer, then output rows reduce kernel_h of those buffers.
+ * Overlapping windows (stride < kernel) reuse the row reductions instead of
+ * re-reading kernel_h * kernel_w inputs per output, and both passes run over
+ * contiguous (pixel, lane) runs that vectorise. Upsampling precomputes its
+ * source columns and weights once, and keeps the last two horizontally
+ * interpolated source rows so output rows that share them do not redo them.
+ */
+constexpr size_t POOL_LANES = 64;
+
+typedef struct Pool2dParams {
+    size_t kernel_h = 2, kernel_w = 2;
+    size_t stride_h = 0, stride_w = 0;  // 0 = kernel size
+    size_t pad_h = 0, pad_w = 0;
+    bool count_include_pad = false;     // AVG: divide by kernel_h * kernel_w even where the window hangs off the edge
+} Pool2dParams;
+
+enum class PoolMode { MAX, AVG };
+enum class UpsampleMode { NEAREST, BILINEAR };
+
+namespace _pooling {
+
+// logical [N, C, H, W] and layout of a 3-D or 4-D activation
+template<typename T>
+std::array<size_t, 4> dims(NTensor<T>& x, TensorLayout& layout) {
+    if (x.ndim() == 3) {
+        if (x.layout().kind != Layout::NCHW) throw std::runtime_error("pooling: 1-D inputs must be [N, C, L]");
+        layout = TensorLayout::nchw();
+        return {x.shape()[0], x.shape()[1], 1, x.shape()[2]};
+    }
+    layout = x.layout();
+    return nchw_dims(x);
+}
+
+template<typename T>
+NTensor<T> make_output(NTensor<T>& x, const TensorLayout& layout, size_t N, size_t C, size_t OH, size_t OW) {
+    if (x.ndim() == 3) return NTensor<T>({N, C, OW}, (T)0, x.config());
+
+    NTensor<T> y(layout.physical_shape(N, C, OH, OW), (T)0, x.config());
+    y.set_layout(layout);
+    return y;
+}
+
+// one task's lanes: base pointers, pixel stride b, lane count
+struct Group {
+    size_t n, c0, lanes;
+};
+
+template<typename F>
+void for_groups(size_t N, size_t C, size_t b, ThreadPool* pool, F&& fn) {
+    // lanes per task: 1 (NCHW), the block (NCHWc), or a POOL_LANES slice of the pixel (NHWC)
+    const size_t per = std::min(b, POOL_LANES);
+    const size_t groups = (C + per - 1) / per;
+
+    auto body = [&](size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t n = t / groups, c0 = (t % groups) * per;
+            fn(Group{n, c0, std::min(per, C - c0)});
+        }
+    };
+
+    if (pool) pool->parallel_for(0, N * groups, 1, body);
+    else body(0, N * groups);
+}
+
+struct MaxOp {
+    template<typename B> static B init() { return std::numeric_limits<B>::has_infinity ? -std::numeric_limits<B>::infinity()
+                                                                                      : std::numeric_limits<B>::lowest(); }
+    template<typename B> static B apply(B a, B v) { return v > a ? v : a; }
+};
+
+struct SumOp {
+    template<typename B> static B init() { return (B)0; }
+    template<typename B> static B apply(B a, B v) { return a + v; }
+};
+
+// valid [lo, hi) of outputs o for which o * stride + off lands in [0, n)
+inline bool out_range(long off, size_t stride, size_t n, size_t outs, size_t& lo, size_t& hi) {
+    const long last = (long)n - 1 - off;
+    if (last < 0) return false;
+    lo = off >= 0 ? 0 : (size_t)((-off + (long)stride - 1) / (long)stride);
+    hi = std::min(outs, (size_t)(last / (long)stride) + 1);
+    return lo < hi;
+}
+
+template<typename Op, typename B, typename T>
+void pool_group(const T* x, T* y, size_t b, size_t lanes, size_t H, size_t W, size_t OH, size_t OW,
+                const Pool2dParams& p, std::vector<B>& rowbuf, std::vector<B>& acc) {
+    /*
+     * rowbuf[ih][ow][l]: row ih reduced across the kernel_w window of column ow
+     * acc[ow][l]: running reduction of one output row over kernel_h row buffers
+     */
+    const size_t row = OW * lanes;
+    rowbuf.assign(H * row, Op::template init<B>());
+    acc.resize(row);
+
+    for (size_t ih = 0; ih < H; ++ih) {
+        const T* xr = x + ih * W * b;
+        B* hr = rowbuf.data() + ih * row;
+
+        for (size_t q = 0; q < p.kernel_w; ++q) {
+            const long off = (long)q - (long)p.pad_w;
+            size_t lo, hi;
+            if (!out_range(off, p.stride_w, W, OW, lo, hi)) continue;
+
+            if (p.stride_w == 1 && lanes == b) {
+                // consecutive outputs read consecutive pixels: one contiguous run
+                const T* xs = xr + (long)(lo + off) * (long)b;
+                B* hs = hr + lo * lanes;
+                for (size_t i = 0; i < (hi - lo) * lanes; ++i) hs[i] = Op::apply(hs[i], (B)xs[i]);
+            } else {
+                for (size_t ow = lo; ow < hi; ++ow) {
+                    const T* xs = xr + ((long)(ow * p.stride_w) + off) * (long)b;
+                    B* hs = hr + ow * lanes;
+                    for (size_t l = 0; l < lanes; ++l) hs[l] = Op::apply(hs[l], (B)xs[l]);
+                }
+            }
+        }
+    }
+
+    for (size_t oh = 0; oh < OH; ++oh) {
+        std::fill(acc.begin(), acc.end(), Op::template init<B>());
+
+        // kernel rows r in [rlo, rhi) land inside the input
+        const long off = (long)(oh * p.stride_h) - (long)p.pad_h;
+        const size_t rlo = off < 0 ? (size_t)(-off) : 0;
+        const size_t rhi = std::min(p.kernel_h, (size_t)std::max<long>(0, (long)H - off));
+
+        for (size_t r = rlo; r < rhi; ++r) {
+            const B* hr = rowbuf.data() + (size_t)(off + (long)r) * row;
+            for (size_t i = 0; i < row; ++i) acc[i] = Op::apply(acc[i], hr[i]);
+        }
+
+        T* yr = y + oh * OW * b;
+        if constexpr (std::is_same_v<Op, SumOp>) {
+            const size_t rows_in = rhi > rlo ? rhi - rlo : 0;
+            for (size_t ow = 0; ow < OW; ++ow) {
+                size_t count = p.kernel_h * p.kernel_w;
+                if (!p.count_include_pad) {
+                    const long c0 = (long)(ow * p.stride_w) - (long)p.pad_w;
+                    const long c1 = std::min<long>(c0 + (long)p.kernel_w, (long)W);
+                    count = rows_in * (size_t)std::max<long>(0, c1 - std::max<long>(c0, 0));
+                }
+                const B inv = count ? (B)1 / (B)count : (B)0;
+                for (size_t l = 0; l < lanes; ++l) yr[ow * b + l] = (T)(acc[ow * lanes + l] * inv);
+            }
+        } else {
+            for (size_t ow = 0; ow < OW; ++ow)
+                for (size_t l = 0; l < lanes; ++l) yr[ow * b + l] = (T)acc[ow * lanes + l];
+        }
+    }
+}
+
+} // namespace _pooling
+
+template<typename T = float>
+NTensor<T> pool2d(NTensor<T>& x, PoolMode mode, Pool2dParams p = {}, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Max or average pooling over each kernel_h x kernel_w window
+     *
+     * @param (NTensor<T>) x: [N, C, H, W] in any layout, or [N, C, L] (the h fields of p are ignored)
+     * @param (Pool2dParams) p: window, stride (0 = window) and padding; pad at most half the window
+     *
+     * @return (NTensor<T>) [N, C, OH, OW] in x's layout, OH = (H + 2 pad_h - kernel_h) / stride_h + 1
+    */
+    TensorLayout layout;
+    auto [N, C, H, W] = _pooling::dims(x, layout);
+
+    if (x.ndim() == 3) p.kernel_h = 1, p.stride_h = 1, p.pad_h = 0;
+    if (p.stride_h == 0) p.stride_h = p.kernel_h;
+    if (p.stride_w == 0) p.stride_w = p.kernel_w;
+
+    // padding of at most half a window keeps at least one real input in every window
+    if (p.kernel_h == 0 || p.kernel_w == 0 || 2 * p.pad_h > p.kernel_h || 2 * p.pad_w > p.kernel_w ||
+        H + 2 * p.pad_h < p.kernel_h || W + 2 * p.pad_w < p.kernel_w) {
+        throw std::runtime_error("pool2d: window " + std::to_string(p.kernel_h) + "x" + std::to_string(p.kernel_w) +
+                                 " does not fit the " + std::to_string(H) + "x" + std::to_string(W) + " input");
+    }
+
+    const size_t OH = (H + 2 * p.pad_h - p.kernel_h) / p.stride_h + 1;
+    const size_t OW = (W + 2 * p.pad_w - p.kernel_w) / p.stride_w + 1;
+
+    NTensor<T> y = _pooling::make_output(x, layout, N, C, OH, OW);
+    ActView<const T> xv = ActView<const T>::of(x.data(), N, C, H, W, layout);
+    ActView<T> yv = ActView<T>::of(y.data(), N, C, OH, OW, layout);
+
+    // both modes reduce in accum_t<T>: bf16 / fp16 have no numeric_limits, so MaxOp needs float's -inf
+    using Acc = accum_t<T>;
+    _pooling::for_groups(N, C, xv.b, pool, [&](_pooling::Group g) {
+        thread_local std::vector<Acc> rowbuf, acc;
+
+        if (mode == PoolMode::MAX) {
+            _pooling::pool_group<_pooling::MaxOp, Acc>(xv.chan(g.n, g.c0), yv.chan(g.n, g.c0), xv.b, g.lanes,
+                                                       H, W, OH, OW, p, rowbuf, acc);
+        } else {
+            _pooling::pool_group<_pooling::SumOp, Acc>(xv.chan(g.n, g.c0), yv.chan(g.n, g.c0), xv.b, g.lanes,
+                                                       H, W, OH, OW, p, rowbuf, acc);
+        }
+    });
+
+    return y;
+}
+
+template<typename T = float>
+NTensor<T> max_pool2d(NTensor<T>& x, Pool2dParams p = {}, ThreadPool* pool = &ThreadPool::global()) {
+    return pool2d(x, PoolMode::MAX, p, pool);
+}
+
+template<typename T = float>
+NTensor<T> avg_pool2d(NTensor<T>& x, Pool2dParams p = {}, ThreadPool* pool = &ThreadPool::global()) {
+    return pool2d(x, PoolMode::AVG, p, pool);
+}
+
+template<typename T = float>
+NTensor<T> global_pool(NTensor<T>& x, PoolMode mode, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Max or mean over all pixels of each channel
+     *
+     * @return (NTensor<T>) [N, C, 1, 1] in x's layout ([N, C, 1] for 1-D input)
+    */
+    TensorLayout layout;
+    auto [N, C, H, W] = _pooling::dims(x, layout);
+
+    NTensor<T> y = _pooling::make_output(x, layout, N, C, 1, 1);
+    ActView<const T> xv = ActView<const T>::of(x.data(), N, C, H, W, layout);
+    ActView<T> yv = ActView<T>::of(y.data(), N, C, 1, 1, layout);
+
+    using Acc = accum_t<T>;
+    const size_t HW = H * W;
+
+    _pooling::for_groups(N, C, xv.b, pool, [&](_pooling::Group g) {
+        const T* xs = xv.chan(g.n, g.c0);
+        T* ys = yv.chan(g.n, g.c0);
+        Acc acc[POOL_LANES];
+
+        if (mode == PoolMode::MAX) {
+            for (size_t l = 0; l < g.lanes; ++l) acc[l] = _pooling::MaxOp::init<Acc>();
+            for (size_t i = 0; i < HW; ++i)
+                for (size_t l = 0; l < g.lanes; ++l) acc[l] = _pooling::MaxOp::apply(acc[l], (Acc)xs[i * xv.b + l]);
+            for (size_t l = 0; l < g.lanes; ++l) ys[l] = (T)acc[l];
+        } else {
+            for (size_t l = 0; l < g.lanes; ++l) acc[l] = (Acc)0;
+            for (size_t i = 0; i < HW; ++i)
+                for (size_t l = 0; l < g.lanes; ++l) acc[l] += (Acc)xs[i * xv.b + l];
+            for (size_t l = 0; l < g.lanes; ++l) ys[l] = (T)(acc[l] / (Acc)HW);
+        }
+    });
+
+    return y;
+}
+
+template<typename T = float>
+NTensor<T> global_avg_pool(NTensor<T>& x, ThreadPool* pool = &ThreadPool::global()) {
+    return global_pool(x, PoolMode::AVG, pool);
+}
+
+template<typename T = float>
+NTensor<T> global_max_pool(NTensor<T>& x, ThreadPool* pool = &ThreadPool::global()) {
+    return global_pool(x, PoolMode::MAX, pool);
+}
+
+namespace _pooling {
+
+// source index pair and weight of the second for each output coordinate
+struct Tap {
+    size_t i0, i1;
+    float w1;
+};
+
+inline std::vector<Tap> taps(size_t in, size_t out, UpsampleMode mode, bool align_corners) {
+    std::vector<Tap> t(out);
+    for (size_t o = 0; o < out; ++o) {
+        if (mode == UpsampleMode::NEAREST) {
+            const size_t i = std::min(in - 1, (size_t)std::floor((double)o * (double)in / (double)out));
+            t[o] = Tap{i, i, 0.0f};
+            continue;
+        }
+
+        double src;
+        if (align_corners) src = out > 1 ? (double)o * (double)(in - 1) / (double)(out - 1) : 0.0;
+        else src = std::max(0.0, ((double)o + 0.5) * (double)in / (double)out - 0.5);
+
+        const size_t i0 = std::min(in - 1, (size_t)src);
+        t[o] = Tap{i0, std::min(in - 1, i0 + 1), (float)(src - (double)i0)};
+    }
+    return t;
+}
+
+} // namespace _pooling
+
+template<typename T = float>
+NTensor<T> upsample(NTensor<T>& x, size_t out_h, size_t out_w, UpsampleMode mode = UpsampleMode::NEAREST,
+                    bool align_corners = false, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Resize every channel to out_h x out_w (nearest or bilinear)
+     *
+     * Nearest takes source floor(o * in / out); bilinear follows the usual
+     * half-pixel convention, or maps the corner pixels onto each other with
+     * align_corners.
+     *
+     * @return (NTensor<T>) [N, C, out_h, out_w] in x's layout ([N, C, out_w] for 1-D input)
+    */
+    TensorLayout layout;
+    auto [N, C, H, W] = _pooling::dims(x, layout);
+    if (x.ndim() == 3) out_h = 1;
+    if (out_h == 0 || out_w == 0 || H == 0 || W == 0) throw std::runtime_error("upsample: empty input or output");
+
+    NTensor<T> y = _pooling::make_output(x, layout, N, C, out_h, out_w);
+    ActView<const T> xv = ActView<const T>::of(x.data(), N, C, H, W, layout);
+    ActView<T> yv = ActView<T>::of(y.data(), N, C, out_h, out_w, layout);
+
+    const std::vector<_pooling::Tap> th = _pooling::taps(H, out_h, mode, align_corners);
+    const std::vector<_pooling::Tap> tw = _pooling::taps(W, out_w, mode, align_corners);
+
+    using Acc = accum_t<T>;
+    const size_t b = xv.b;
+
+    _pooling::for_groups(N, C, b, pool, [&](_pooling::Group g) {
+        const T* xs = xv.chan(g.n, g.c0);
+        T* ys = yv.chan(g.n, g.c0);
+        const size_t lanes = g.lanes, row = out_w * lanes;
+
+        if (mode == UpsampleMode::NEAREST) {
+            for (size_t oh = 0; oh < out_h; ++oh) {
+                const T* xr = xs + th[oh].i0 * W * b;
+                T* yr = ys + oh * out_w * b;
+                for (size_t ow = 0; ow < out_w; ++ow)
+                    for (size_t l = 0; l < lanes; ++l) yr[ow * b + l] = xr[tw[ow].i0 * b + l];
+            }
+            return;
+        }
+
+        // horizontally interpolated source rows, cached by source index
+        thread_local std::vector<Acc> cache;
+        cache.resize(2 * row);
+        size_t have[2] = {SIZE_MAX, SIZE_MAX};
+
+        auto hrow = [&](size_t ih) -> const Acc* {
+            for (size_t s = 0; s < 2; ++s)
+                if (have[s] == ih) return cache.data() + s * row;
+
+            // evict the slot the next output row no longer needs (the lower index)
+            const size_t s = have[0] == SIZE_MAX ? 0 : have[1] == SIZE_MAX ? 1 : (have[0] < have[1] ? 0 : 1);
+            Acc* dst = cache.data() + s * row;
+            const T* xr = xs + ih * W * b;
+            for (size_t ow = 0; ow < out_w; ++ow) {
+                const T* a = xr + tw[ow].i0 * b;
+                const T* c = xr + tw[ow].i1 * b;
+                const Acc w1 = (Acc)tw[ow].w1, w0 = (Acc)1 - w1;
+                for (size_t l = 0; l < lanes; ++l) dst[ow * lanes + l] = w0 * (Acc)a[l] + w1 * (Acc)c[l];
+            }
+            have[s] = ih;
+            return dst;
+        };
+
+        for (size_t oh = 0; oh < out_h; ++oh) {
+            const Acc* r0 = hrow(th[oh].i0);
+            const Acc* r1 = hrow(th[oh].i1);
+            const Acc w1 = (Acc)th[oh].w1, w0 = (Acc)1 - w1;
+
+            T* yr = ys + oh * out_w * b;
+            for (size_t ow = 0; ow < out_w; ++ow)
+                for (size_t l = 0; l < lanes; ++l) yr[ow * b + l] = (T)(w0 * r0[ow * lanes + l] + w1 * r1[ow * lanes + l]);
+        }
+    });
+
+    return y;
+}
+
+#endif // POOLING_HPP
@@ -0,0 +1,53 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+
+/*
+ * Inference server wire format, native byte order (host-local transports only).
+ *
+ * Every request is a RequestHeader followed by rows * cols f32 values (the A
+ * operand, row-major). Every response is a ResponseHeader followed by
+ * payload_bytes bytes: the [rows x cols] f32 product for MATMUL, or for LIST
+ * `rows` entries of { u32 name_len | name | u32 K | u32 N }.
+ */
+constexpr uint32_t PROTOCOL_MAGIC = 0x4C4D4C49; // "ILML"
+constexpr uint64_t MAX_REQUEST_ELEMENTS = 1ull << 26;
+
+enum class Op : uint32_t {
+    LIST   = 1, // enumerate the loaded 2D weights, their index is the `weight` field
+    MATMUL = 2  // out = A * weights[weight]
+};
+
+enum class Status : uint32_t {
+    OK             = 0,
+    BAD_REQUEST    = 1,
+    UNKNOWN_WEIGHT = 2,
+    SHAPE_MISMATCH = 3,
+    INTERNAL       = 4
+};
+
+struct RequestHeader {
+    uint32_t magic;
+    uint32_t op;
+    uint64_t id;      // echoed back so clients can pipeline
+    uint32_t weight;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t reserved;
+};
+
+struct ResponseHeader {
+    uint32_t magic;
+    uint32_t status;
+    uint64_t id;
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t latency_us; // server-side receive-complete -> send-start
+    uint64_t payload_bytes;
+};
+
+static_assert(sizeof(RequestHeader) == 32, "RequestHeader layout is part of the protocol");
+static_assert(sizeof(ResponseHeader) == 40, "ResponseHeader layout is part of the protocol");
+
+#endif // PROTOCOL_HPP
@@ -0,0 +1,201 @@
+#ifndef PRUNE_HPP
+#define PRUNE_HPP
+
+#include <sparse.hpp>
+#include <tensor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Magnitude pruning of Dense-oriented weights W [in x out].
+ *
+ *   UNSTRUCTURED  zero the sparsity * in * out smallest |w| of the whole tensor
+ *   N_M           in every group of m consecutive inputs of an output column
+ *                 keep the n largest |w| (2:4 = 50%); sparsity is ignored
+ *   BLOCK         score each block_k x GEMM_PANEL_N block by its sum of
+ *                 squares and zero the lowest blocks until sparsity * in * out
+ *                 weights are covered; edge blocks are smaller, so the count
+ *                 is in weights, not blocks
+ *
+ * prune() only masks W in place, so the result still works with every dense
+ * path (Dense, gemm_packed, fine-tuning with the mask re-applied). The
+ * prune_csr / prune_nm / prune_blocks wrappers mask and then compress into
+ * the matching sparse.hpp format for sparse_matmul(). Ties are broken by
+ * position, so UNSTRUCTURED hits the requested count exactly and BLOCK
+ * overshoots it by less than one block.
+ */
+enum class PruneMode { UNSTRUCTURED, N_M, BLOCK };
+
+inline const char* prune_mode_name(PruneMode mode) {
+    switch (mode) {
+    case PruneMode::UNSTRUCTURED: return "unstructured";
+    case PruneMode::N_M:          return "n:m";
+    case PruneMode::BLOCK:        return "block";
+    }
+    return "unknown";
+}
+
+typedef struct PruneConfig {
+    PruneMode mode = PruneMode::UNSTRUCTURED;
+    double sparsity = 0.5;      // fraction of weights zeroed (UNSTRUCTURED, BLOCK)
+    size_t n = 2, m = 4;        // N_M pattern
+    size_t block_k = 4;         // BLOCK rows; block columns are GEMM_PANEL_N
+} PruneConfig;
+
+namespace _prune {
+
+template<typename T>
+double magnitude(T w) {
+    return std::fabs((double)(accum_t<T>)w);
+}
+
+inline auto by_score(const std::vector<double>& score) {
+    return [&score](size_t a, size_t b) { return score[a] < score[b] || (score[a] == score[b] && a < b); };
+}
+
+// indices of the `count` lowest scores, ties to the lower index
+inline std::vector<size_t> lowest(const std::vector<double>& score, size_t count) {
+    std::vector<size_t> order(score.size());
+    std::iota(order.begin(), order.end(), (size_t)0);
+
+    count = std::min(count, order.size());
+    std::nth_element(order.begin(), order.begin() + count, order.end(), by_score(score));
+    order.resize(count);
+    return order;
+}
+
+// all indices, lowest score first
+inline std::vector<size_t> ascending(const std::vector<double>& score) {
+    std::vector<size_t> order(score.size());
+    std::iota(order.begin(), order.end(), (size_t)0);
+    std::sort(order.begin(), order.end(), by_score(score));
+    return order;
+}
+
+inline size_t target(double sparsity, size_t total) {
+    if (!(sparsity >= 0.0 && sparsity <= 1.0)) {
+        throw std::runtime_error("prune: sparsity must be in [0, 1], got " + std::to_string(sparsity));
+    }
+    return (size_t)std::floor(sparsity * (double)total);
+}
+
+} // namespace _prune
+
+template<typename T>
+double prune(NTensor<T>& W, const PruneConfig& cfg) {
+    /**
+     * @brief Zero the lowest-magnitude weights of W in place
+     *
+     * @param (NTensor<T>) W: [in x out] row-major
+     * @param (PruneConfig) cfg: pattern and target sparsity
+     *
+     * @return (double) fraction of W that is zero afterwards
+    */
+    if (W.ndim() != 2) throw std::runtime_error("prune: weight must be [in x out]");
+
+    const size_t K = W.shape()[0], N = W.shape()[1];
+    T* w = W.data();
+
+    switch (cfg.mode) {
+    case PruneMode::UNSTRUCTURED: {
+        std::vector<double> score(K * N);
+        for (size_t i = 0; i < K * N; ++i) score[i] = _prune::magnitude(w[i]);
+        for (size_t i : _prune::lowest(score, _prune::target(cfg.sparsity, K * N))) w[i] = (T)0;
+        break;
+    }
+    case PruneMode::N_M: {
+        if (cfg.m == 0 || cfg.n > cfg.m || K % cfg.m != 0) {
+            throw std::runtime_error("prune: in = " + std::to_string(K) + " does not split into " +
+                                     std::to_string(cfg.n) + ":" + std::to_string(cfg.m) + " groups");
+        }
+
+        std::vector<double> score(cfg.m);
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t g = 0; g < K; g += cfg.m) {
+                for (size_t i = 0; i < cfg.m; ++i) score[i] = _prune::magnitude(w[(g + i) * N + j]);
+                for (size_t i : _prune::lowest(score, cfg.m - cfg.n)) w[(g + i) * N + j] = (T)0;
+            }
+        }
+        break;
+    }
+    case PruneMode::BLOCK: {
+        if (cfg.block_k == 0) throw std::runtime_error("prune: block_k must be positive");
+
+        const size_t rows = (K + cfg.block_k - 1) / cfg.block_k;
+        const size_t cols = (N + GEMM_PANEL_N - 1) / GEMM_PANEL_N;
+
+        auto extent = [&](size_t b) {
+            const size_t k0 = (b / cols) * cfg.block_k, j0 = (b % cols) * GEMM_PANEL_N;
+            return std::array<size_t, 4>{k0, std::min(k0 + cfg.block_k, K), j0, std::min(j0 + GEMM_PANEL_N, N)};
+        };
+        auto each = [&](size_t b, auto&& fn) {
+            const auto [k0, k1, j0, j1] = extent(b);
+            for (size_t k = k0; k < k1; ++k)
+                for (size_t j = j0; j < j1; ++j) fn(w[k * N + j]);
+        };
+
+        std::vector<double> score(rows * cols, 0.0);
+        for (size_t b = 0; b < score.size(); ++b) {
+            each(b, [&](T& v) { score[b] += _prune::magnitude(v) * _prune::magnitude(v); });
+        }
+
+        // edge blocks hold fewer weights, so count what is zeroed rather than blocks
+        const size_t want = _prune::target(cfg.sparsity, K * N);
+        size_t zeroed = 0;
+        for (size_t b : _prune::ascending(score)) {
+            if (zeroed >= want) break;
+            const auto [k0, k1, j0, j1] = extent(b);
+            each(b, [](T& v) { v = (T)0; });
+            zeroed += (k1 - k0) * (j1 - j0);
+        }
+        break;
+    }
+    }
+
+    size_t zeros = 0;
+    for (size_t i = 0; i < K * N; ++i) zeros += w[i] == (T)0;
+    return (K * N) != 0 ? (double)zeros / (double)(K * N) : 0.0;
+}
+
+template<typename T>
+SparseCSR<T> prune_csr(NTensor<T>& W, double sparsity) {
+    /**
+     * @brief Unstructured magnitude pruning, compressed to CSR
+    */
+    prune(W, PruneConfig{PruneMode::UNSTRUCTURED, sparsity});
+    return SparseCSR<T>::from_dense(W.data(), W.shape()[0], W.shape()[1]);
+}
+
+template<typename T>
+SparseNM<T> prune_nm(NTensor<T>& W, size_t n = 2, size_t m = 4) {
+    /**
+     * @brief N:M pruning along the input dimension, compressed to SparseNM
+    */
+    PruneConfig cfg;
+    cfg.mode = PruneMode::N_M;
+    cfg.n = n;
+    cfg.m = m;
+    prune(W, cfg);
+    return SparseNM<T>::from_dense(W.data(), W.shape()[0], W.shape()[1], n, m);
+}
+
+template<typename T>
+BlockSparse<T> prune_blocks(NTensor<T>& W, double sparsity, size_t block_k = 4) {
+    /**
+     * @brief Block pruning with block_k x GEMM_PANEL_N blocks, compressed to BlockSparse
+    */
+    PruneConfig cfg;
+    cfg.mode = PruneMode::BLOCK;
+    cfg.sparsity = sparsity;
+    cfg.block_k = block_k;
+    prune(W, cfg);
+    return BlockSparse<T>::from_dense(W.data(), W.shape()[0], W.shape()[1], block_k);
+}
+
+#endif // PRUNE_HPP
@@ -0,0 +1,111 @@
+#ifndef QUANTIZE_HPP
+#define QUANTIZE_HPP
+
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Symmetric int8 quantization and the int8 GEMM it feeds.
+ *
+ *   q = clamp(round(x / scale), -127, 127),   x ~= q * scale
+ *
+ * -128 is never produced, so negation stays in range and the product of two
+ * values fits the int16 pairs the compiler's pmaddwd (or VNNI) lowering
+ * expects. Weights get one scale per output channel, activations one per
+ * tensor (calibrate.hpp picks both).
+ *
+ * gemm_s8 takes B transposed, [N x K]: every output is the dot product of two
+ * contiguous int8 runs accumulated in int32, which the compiler vectorises;
+ * outputs are computed 2 x 2 at a time so every loaded byte feeds two
+ * products. Tiles are QGEMM_TILE_M rows of A by QGEMM_TILE_N rows of B^T,
+ * sized so the B^T block stays in L2 while the A rows stream past it.
+ */
+constexpr int32_t QINT8_MAX = 127;
+constexpr size_t QGEMM_TILE_M = 16;
+constexpr size_t QGEMM_TILE_N = 64;
+
+inline float int8_scale(float amax) {
+    /**
+     * @brief Scale that maps [-amax, amax] onto [-127, 127]; 1 for an all-zero range
+    */
+    return amax > 0.0f && std::isfinite(amax) ? amax / (float)QINT8_MAX : 1.0f;
+}
+
+inline void quantize_int8(const float* x, int8_t* q, size_t n, float scale) {
+    const float inv = 1.0f / scale;
+    for (size_t i = 0; i < n; ++i) {
+        float v = std::nearbyint(x[i] * inv);
+        v = std::min(std::max(v, -(float)QINT8_MAX), (float)QINT8_MAX);
+        q[i] = (int8_t)v;
+    }
+}
+
+inline void dequantize_int8(const int8_t* q, float* x, size_t n, float scale) {
+    for (size_t i = 0; i < n; ++i) x[i] = (float)q[i] * scale;
+}
+
+inline int32_t dot_s8(const int8_t* a, const int8_t* b, size_t K) {
+    int32_t acc = 0;
+    for (size_t k = 0; k < K; ++k) acc += (int32_t)a[k] * (int32_t)b[k];
+    return acc;
+}
+
+inline void dot_s8_2x2(const int8_t* a, size_t lda, const int8_t* b, size_t ldb, size_t K, int32_t* c, size_t ldc) {
+    const int8_t* a1 = a + lda;
+    const int8_t* b1 = b + ldb;
+    int32_t c00 = 0, c01 = 0, c10 = 0, c11 = 0;
+
+    for (size_t k = 0; k < K; ++k) {
+        const int32_t x0 = a[k], x1 = a1[k], y0 = b[k], y1 = b1[k];
+        c00 += x0 * y0;
+        c01 += x0 * y1;
+        c10 += x1 * y0;
+        c11 += x1 * y1;
+    }
+
+    c[0] = c00;
+    c[1] = c01;
+    c[ldc] = c10;
+    c[ldc + 1] = c11;
+}
+
+inline void gemm_s8(const int8_t* A, size_t lda, size_t M, const int8_t* Bt, size_t ldb, size_t N, size_t K,
+                    int32_t* C, size_t ldc, ThreadPool* pool = nullptr) {
+    /**
+     * @brief C[M x N] = A[M x K] * B[K x N] in int32, with B passed transposed
+     *
+     * @param (const int8_t*) Bt: B^T, [N x K] row-major, leading dimension ldb
+     * @param (ThreadPool*) pool: run tiles on this pool, nullptr = calling thread
+    */
+    const size_t tiles_m = (M + QGEMM_TILE_M - 1) / QGEMM_TILE_M;
+    const size_t tiles_n = (N + QGEMM_TILE_N - 1) / QGEMM_TILE_N;
+
+    auto run = [&](size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t i0 = (t / tiles_n) * QGEMM_TILE_M, i1 = std::min(i0 + QGEMM_TILE_M, M);
+            const size_t j0 = (t % tiles_n) * QGEMM_TILE_N, j1 = std::min(j0 + QGEMM_TILE_N, N);
+
+            size_t i = i0;
+            for (; i + 2 <= i1; i += 2) {
+                size_t j = j0;
+                for (; j + 2 <= j1; j += 2) dot_s8_2x2(A + i * lda, lda, Bt + j * ldb, ldb, K, C + i * ldc + j, ldc);
+                if (j < j1) {
+                    C[i * ldc + j] = dot_s8(A + i * lda, Bt + j * ldb, K);
+                    C[(i + 1) * ldc + j] = dot_s8(A + (i + 1) * lda, Bt + j * ldb, K);
+                }
+            }
+            if (i < i1) {
+                for (size_t j = j0; j < j1; ++j) C[i * ldc + j] = dot_s8(A + i * lda, Bt + j * ldb, K);
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, tiles_m * tiles_n, 1, run);
+    else run(0, tiles_m * tiles_n);
+}
+
+#endif // QUANTIZE_HPP
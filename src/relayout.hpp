@@ -0,0 +1,126 @@
+#ifndef RELAYOUT_HPP
+#define RELAYOUT_HPP
+
+#include <layout.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+constexpr size_t RELAYOUT_TILE = 32;
+
+template<typename T>
+void transpose_2d(const T* src, size_t rows, size_t cols, size_t lds, T* dst, size_t ldd) {
+    /**
+     * @brief dst[j, i] = src[i, j] for a [rows x cols] block, in RELAYOUT_TILE square tiles
+     *
+     * Tiling keeps both the rows being read and the rows being written
+     * resident in L1, instead of one side missing on every element.
+    */
+    for (size_t i0 = 0; i0 < rows; i0 += RELAYOUT_TILE) {
+        const size_t i1 = std::min(i0 + RELAYOUT_TILE, rows);
+        for (size_t j0 = 0; j0 < cols; j0 += RELAYOUT_TILE) {
+            const size_t j1 = std::min(j0 + RELAYOUT_TILE, cols);
+
+            for (size_t i = i0; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) dst[j * ldd + i] = src[i * lds + j];
+            }
+        }
+    }
+}
+
+template<typename T>
+void relayout_image(const ActView<const T>& src, const ActView<T>& dst, size_t n) {
+    /**
+     * @brief Copy image n between two channel-blocked layouts (any b on either side)
+     *
+     * Channels and pixels are walked in RELAYOUT_TILE x RELAYOUT_TILE tiles,
+     * which is a cache-blocked transpose whenever the channel stride differs
+     * between the two sides (NCHW <-> NHWC / NCHWc), and a run of short
+     * contiguous copies when both are blocked.
+    */
+    const size_t C = src.C, HW = src.H * src.W;
+
+    if (src.b == 1 && dst.b == C) {
+        transpose_2d(src.chan(n, 0), C, HW, HW, dst.chan(n, 0), C);
+        return;
+    }
+    if (src.b == C && dst.b == 1) {
+        transpose_2d(src.chan(n, 0), HW, C, C, dst.chan(n, 0), HW);
+        return;
+    }
+
+    for (size_t c0 = 0; c0 < C; c0 += RELAYOUT_TILE) {
+        const size_t c1 = std::min(c0 + RELAYOUT_TILE, C);
+
+        for (size_t p0 = 0; p0 < HW; p0 += RELAYOUT_TILE) {
+            const size_t p1 = std::min(p0 + RELAYOUT_TILE, HW);
+
+            for (size_t c = c0; c < c1; ++c) {
+                const T* s = src.chan(n, c);
+                T* d = dst.chan(n, c);
+                for (size_t p = p0; p < p1; ++p) d[p * dst.b] = s[p * src.b];
+            }
+        }
+    }
+}
+
+template<typename T>
+std::array<size_t, 4> nchw_dims(NTensor<T>& t) {
+    /**
+     * @brief Logical [N, C, H, W] of a 4-D activation, whatever its layout
+    */
+    const size_t* s = t.shape();
+    switch (t.layout().kind) {
+    case Layout::NHWC:
+        if (t.ndim() != 4) break;
+        return {s[0], s[3], s[1], s[2]};
+    case Layout::NCHWc:
+        if (t.ndim() != 5) break;
+        return {s[0], t.layout().channels, s[2], s[3]};
+    default:
+        if (t.ndim() != 4) break;
+        return {s[0], s[1], s[2], s[3]};
+    }
+    throw std::runtime_error(std::string("Tensor rank does not match its ") + layout_name(t.layout().kind) + " layout");
+}
+
+template<typename T>
+ActView<T> act_view(NTensor<T>& t) {
+    auto [N, C, H, W] = nchw_dims(t);
+    return ActView<T>::of(t.data(), N, C, H, W, t.layout());
+}
+
+template<typename T>
+NTensor<T> to_layout(NTensor<T>& x, TensorLayout target, ThreadPool* pool = &ThreadPool::global()) {
+    /**
+     * @brief Copy of a 4-D activation in another layout (x itself if already there)
+     *
+     * @param (TensorLayout) target: NCHWc takes its block from target.block; its
+     *     channel count is filled in from x
+     *
+     * @return (NTensor<T>) tensor tagged with target
+    */
+    auto [N, C, H, W] = nchw_dims(x);
+    if (target.kind == Layout::NCHWc) target = TensorLayout::nchwc(C, target.block);
+    if (x.layout() == target) return x;
+
+    NTensor<T> y(target.physical_shape(N, C, H, W), (T)0, x.config());
+    y.set_layout(target);
+
+    ActView<const T> src = ActView<const T>::of(x.data(), N, C, H, W, x.layout());
+    ActView<T> dst = ActView<T>::of(y.data(), N, C, H, W, target);
+
+    auto body = [&](size_t lo, size_t hi) {
+        for (size_t n = lo; n < hi; ++n) relayout_image(src, dst, n);
+    };
+
+    if (pool) pool->parallel_for(0, N, 1, body);
+    else body(0, N);
+
+    return y;
+}
+
+#endif // RELAYOUT_HPP
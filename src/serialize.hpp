@@ -0,0 +1,236 @@
+#ifndef SERIALIZE_HPP
+#define SERIALIZE_HPP
+
+#include <half.hpp>
+#include <tensor.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Weights file: a flat list of named tensors, native byte order.
+ *
+ *   u32 magic "IMLW" | u32 version | u32 count
+ *   count x { u32 name_len | name | u32 dtype | u32 ndim | u64 shape[ndim] | data }
+ *
+ * save_weights / load_weights read and write files of one dtype as NTensors;
+ * save_blobs / load_blobs handle files that mix dtypes (quantized weights).
+ */
+constexpr uint32_t WEIGHTS_MAGIC = 0x574C4D49; // "IMLW"
+constexpr uint32_t WEIGHTS_VERSION = 1;
+
+enum DType : uint32_t { F32 = 0, F64 = 1, I32 = 2, I8 = 3, BF16 = 4, F16 = 5 };
+
+template<typename T> constexpr DType dtype_of();
+template<> constexpr DType dtype_of<float>() { return F32; }
+template<> constexpr DType dtype_of<double>() { return F64; }
+template<> constexpr DType dtype_of<int32_t>() { return I32; }
+template<> constexpr DType dtype_of<int8_t>() { return I8; }
+template<> constexpr DType dtype_of<bf16>() { return BF16; }
+template<> constexpr DType dtype_of<fp16>() { return F16; }
+
+inline size_t dtype_size(DType d) {
+    switch (d) {
+    case F32:  return 4;
+    case F64:  return 8;
+    case I32:  return 4;
+    case I8:   return 1;
+    case BF16: return 2;
+    case F16:  return 2;
+    }
+    throw std::runtime_error("Unknown dtype " + std::to_string((uint32_t)d));
+}
+
+namespace _weights_io {
+
+inline void write_raw(FILE* f, const void* p, size_t n, const std::string& path) {
+    if (n && std::fwrite(p, 1, n, f) != n) {
+        throw std::runtime_error("Failed writing weights file " + path);
+    }
+}
+
+inline void read_raw(FILE* f, void* p, size_t n, const std::string& path) {
+    if (n && std::fread(p, 1, n, f) != n) {
+        throw std::runtime_error("Truncated weights file " + path);
+    }
+}
+
+struct File {
+    FILE* f;
+    explicit File(const std::string& path, const char* mode) : f(std::fopen(path.c_str(), mode)) {
+        if (!f) throw std::runtime_error("Cannot open weights file " + path);
+    }
+    ~File() { std::fclose(f); }
+};
+
+inline void write_header(FILE* f, size_t count, const std::string& path) {
+    uint32_t header[3] = { WEIGHTS_MAGIC, WEIGHTS_VERSION, (uint32_t)count };
+    write_raw(f, header, sizeof(header), path);
+}
+
+inline uint32_t read_header(FILE* f, const std::string& path) {
+    uint32_t header[3];
+    read_raw(f, header, sizeof(header), path);
+
+    if (header[0] != WEIGHTS_MAGIC || header[1] != WEIGHTS_VERSION) {
+        throw std::runtime_error("Not an intel-ml weights file (or unsupported version): " + path);
+    }
+    return header[2];
+}
+
+inline void write_entry(FILE* f, const std::string& name, DType dtype, const size_t* shape, size_t ndim,
+                        const void* data, size_t bytes, const std::string& path) {
+    uint32_t meta[3] = { (uint32_t)name.size(), (uint32_t)dtype, (uint32_t)ndim };
+    write_raw(f, &meta[0], sizeof(uint32_t), path);
+    write_raw(f, name.data(), name.size(), path);
+    write_raw(f, &meta[1], 2 * sizeof(uint32_t), path);
+
+    for (size_t d = 0; d < ndim; ++d) {
+        uint64_t dim = shape[d];
+        write_raw(f, &dim, sizeof(dim), path);
+    }
+
+    write_raw(f, data, bytes, path);
+}
+
+// everything of an entry but its data, which follows in the file
+inline void read_entry_meta(FILE* f, std::string& name, DType& dtype, std::vector<size_t>& shape, const std::string& path) {
+    uint32_t name_len;
+    read_raw(f, &name_len, sizeof(name_len), path);
+
+    name.assign(name_len, '\0');
+    read_raw(f, name.data(), name_len, path);
+
+    uint32_t meta[2];
+    read_raw(f, meta, sizeof(meta), path);
+    dtype = (DType)meta[0];
+
+    shape.resize(meta[1]);
+    for (size_t& dim : shape) {
+        uint64_t d;
+        read_raw(f, &d, sizeof(d), path);
+        dim = (size_t)d;
+    }
+}
+
+} // namespace _weights_io
+
+template<typename T = float>
+void save_weights(const std::string& path, std::map<std::string, NTensor<T>>& weights) {
+    /**
+     * @brief Write named tensors to a weights file
+     *
+     * @param (std::string) path: output file
+     * @param (std::map<std::string, NTensor<T>>) weights: name -> tensor
+    */
+    _weights_io::File file(path, "wb");
+    _weights_io::write_header(file.f, weights.size(), path);
+
+    for (auto& [name, t] : weights) {
+        _weights_io::write_entry(file.f, name, dtype_of<T>(), t.shape(), t.ndim(), t.data(), t.size() * sizeof(T), path);
+    }
+}
+
+template<typename T = float>
+std::map<std::string, NTensor<T>> load_weights(const std::string& path, NTensorConfig cfg) {
+    /**
+     * @brief Read every tensor of a weights file
+     *
+     * @param (std::string) path: weights file written by save_weights
+     * @param (struct NTensorConfig) cfg: config given to each loaded tensor
+     *
+     * @return (std::map<std::string, NTensor<T>>) name -> tensor
+    */
+    _weights_io::File file(path, "rb");
+    const uint32_t count = _weights_io::read_header(file.f, path);
+
+    std::map<std::string, NTensor<T>> out;
+
+    for (uint32_t n = 0; n < count; ++n) {
+        std::string name;
+        DType dtype;
+        std::vector<size_t> shape;
+        _weights_io::read_entry_meta(file.f, name, dtype, shape, path);
+
+        if (dtype != dtype_of<T>()) {
+            throw std::runtime_error("Tensor '" + name + "' in " + path + " has a different dtype");
+        }
+
+        NTensor<T> t(shape, (T)0, cfg);
+        _weights_io::read_raw(file.f, t.data(), t.size() * sizeof(T), path);
+
+        out.emplace(std::move(name), std::move(t));
+    }
+
+    return out;
+}
+
+// one tensor of any dtype, for files that mix them (e.g. int8 weights with float scales)
+typedef struct TensorBlob {
+    DType dtype = F32;
+    std::vector<size_t> shape;
+    std::vector<uint8_t> bytes;
+
+    size_t size() const {
+        size_t n = 1;
+        for (size_t d : shape) n *= d;
+        return n;
+    }
+
+    template<typename T>
+    static TensorBlob of(const std::vector<size_t>& shape, const T* data) {
+        TensorBlob b;
+        b.dtype = dtype_of<T>();
+        b.shape = shape;
+        b.bytes.resize(b.size() * sizeof(T));
+        if (!b.bytes.empty()) std::memcpy(b.bytes.data(), data, b.bytes.size());
+        return b;
+    }
+
+    template<typename T>
+    NTensor<T> tensor(NTensorConfig cfg) const {
+        if (dtype != dtype_of<T>()) throw std::runtime_error("TensorBlob: dtype mismatch");
+        NTensor<T> t(shape, (T)0, cfg);
+        if (!bytes.empty()) std::memcpy(t.data(), bytes.data(), bytes.size());
+        return t;
+    }
+} TensorBlob;
+
+inline void save_blobs(const std::string& path, const std::map<std::string, TensorBlob>& blobs) {
+    /**
+     * @brief save_weights() for tensors of mixed dtypes; same file format
+    */
+    _weights_io::File file(path, "wb");
+    _weights_io::write_header(file.f, blobs.size(), path);
+
+    for (auto& [name, b] : blobs) {
+        _weights_io::write_entry(file.f, name, b.dtype, b.shape.data(), b.shape.size(), b.bytes.data(), b.bytes.size(), path);
+    }
+}
+
+inline std::map<std::string, TensorBlob> load_blobs(const std::string& path) {
+    /**
+     * @brief load_weights() keeping every tensor in its stored dtype
+    */
+    _weights_io::File file(path, "rb");
+    const uint32_t count = _weights_io::read_header(file.f, path);
+
+    std::map<std::string, TensorBlob> out;
+    for (uint32_t n = 0; n < count; ++n) {
+        std::string name;
+        TensorBlob b;
+        _weights_io::read_entry_meta(file.f, name, b.dtype, b.shape, path);
+
+        b.bytes.resize(b.size() * dtype_size(b.dtype));
+        _weights_io::read_raw(file.f, b.bytes.data(), b.bytes.size(), path);
+        out.emplace(std::move(name), std::move(b));
+    }
+    return out;
+}
+
+#endif // SERIALIZE_HPP
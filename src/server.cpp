@@ -0,0 +1,53 @@
+#include <iostream>
+#include <server.hpp>
+
+#include <cstdlib>
+#include <string>
+
+static void usage() {
+    _log::log_fatal(
+        "Usage: intel-ml-server <weights-file> (--unix PATH | --tcp PORT)\n"
+        "           [--threads N] [--window-us N] [--max-batch-rows N]"
+    );
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) usage();
+
+    ServerConfig cfg;
+    cfg.weights_path = argv[1];
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) usage();
+
+        const char* val = argv[++i];
+        if      (arg == "--unix")           cfg.unix_path = val;
+        else if (arg == "--tcp")            cfg.tcp_port = std::atoi(val);
+        else if (arg == "--threads")        cfg.threads = std::strtoull(val, nullptr, 10);
+        else if (arg == "--window-us")      cfg.batch.window_us = std::strtoull(val, nullptr, 10);
+        else if (arg == "--max-batch-rows") cfg.batch.max_batch_rows = std::strtoull(val, nullptr, 10);
+        else usage();
+    }
+
+    if (cfg.unix_path.empty() == (cfg.tcp_port < 0)) usage();
+
+    try {
+        InferenceServer server(cfg);
+
+        int fd;
+        if (!cfg.unix_path.empty()) {
+            fd = _socket::listen_unix(cfg.unix_path);
+            _log::log_message(_log::INFO, "Listening on unix:%s", cfg.unix_path.c_str());
+        } else {
+            fd = _socket::listen_tcp((uint16_t)cfg.tcp_port);
+            _log::log_message(_log::INFO, "Listening on 127.0.0.1:%d", cfg.tcp_port);
+        }
+
+        server.serve(fd);
+    } catch (const std::exception& e) {
+        _log::log_fatal("intel-ml-server: %s", e.what());
+    }
+
+    return 0;
+}
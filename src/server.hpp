@@ -0,0 +1,203 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <batcher.hpp>
+#include <log.hpp>
+#include <protocol.hpp>
+#include <serialize.hpp>
+#include <socket.hpp>
+#include <tensor_pool.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <future>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct ServerConfig {
+    std::string weights_path;
+    std::string unix_path;
+    int tcp_port = -1;
+    size_t threads = 0;
+    BatcherConfig batch;
+} ServerConfig;
+
+typedef struct LatencyTracker {
+    size_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+
+    void record(uint64_t us) {
+        count++;
+        total_us += us;
+        max_us = std::max(max_us, us);
+    }
+
+    double mean_us() const { return count ? (double)total_us / (double)count : 0.0; }
+} LatencyTracker;
+
+class InferenceServer {
+public:
+    explicit InferenceServer(const ServerConfig& cfg)
+        : cfg_(cfg),
+          pool_(cfg.threads),
+          batcher_(cfg.batch, pool_),
+          tensors_(NTensorConfig{SIZE_MAX})
+    {
+        /**
+         * @brief Load the weights file and index every 2D tensor as a MATMUL target
+         *
+         * @param (struct ServerConfig) cfg: weights file, listen address, batching knobs
+        */
+        weights_ = load_weights<float>(cfg.weights_path, NTensorConfig{SIZE_MAX});
+
+        for (auto& [name, t] : weights_) {
+            if (t.ndim() == 2) targets_.push_back({name, &t});
+        }
+
+        _log::log_message(_log::INFO, "Loaded %zu tensors (%zu matmul targets) from %s",
+            weights_.size(), targets_.size(), cfg.weights_path.c_str());
+    }
+
+    void serve(int listen_fd) {
+        for (;;) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                throw _socket::os_error("accept");
+            }
+
+            std::thread([this, fd] { handle_client(fd); }).detach();
+        }
+    }
+
+    void handle_client(int fd) {
+        /**
+         * @brief Serve requests on one connected socket until the peer closes it, then close fd
+         *
+         * @param (int) fd: connected stream socket, owned by the call
+        */
+        LatencyTracker latency;
+        RequestHeader req;
+
+        while (_socket::recv_all(fd, &req, sizeof(req))) {
+            bool ok = false;
+
+            try {
+                if (req.magic != PROTOCOL_MAGIC) {
+                    reply_status(fd, req, Status::BAD_REQUEST);
+                    break; // stream is out of sync, drop the connection
+                }
+
+                switch ((Op)req.op) {
+                case Op::LIST:   ok = handle_list(fd, req); break;
+                case Op::MATMUL: ok = handle_matmul(fd, req, latency); break;
+                default:         reply_status(fd, req, Status::BAD_REQUEST); break;
+                }
+            } catch (const std::exception& e) {
+                _log::log_message(_log::ERROR, "Request %llu failed: %s",
+                    (unsigned long long)req.id, e.what());
+                ok = reply_status(fd, req, Status::INTERNAL);
+            }
+
+            if (!ok) break;
+        }
+
+        if (latency.count) {
+            _log::log_message(_log::INFO, "Client closed: %zu requests, mean %.1f us, max %llu us",
+                latency.count, latency.mean_us(), (unsigned long long)latency.max_us);
+        }
+
+        ::close(fd);
+    }
+
+    BatcherStats batch_stats() const { return batcher_.stats(); }
+
+private:
+    struct Target {
+        std::string name;
+        NTensor<float>* tensor;
+    };
+
+    ServerConfig cfg_;
+    ThreadPool pool_;
+    MatmulBatcher<float> batcher_;
+    TensorPool<float> tensors_;
+
+    std::map<std::string, NTensor<float>> weights_;
+    std::vector<Target> targets_;
+
+    bool respond(int fd, ResponseHeader& res, const void* payload) {
+        res.magic = PROTOCOL_MAGIC;
+        return _socket::send_all(fd, &res, sizeof(res))
+            && _socket::send_all(fd, payload, res.payload_bytes);
+    }
+
+    bool reply_status(int fd, const RequestHeader& req, Status status) {
+        ResponseHeader res{};
+        res.id = req.id;
+        res.status = (uint32_t)status;
+        return respond(fd, res, nullptr);
+    }
+
+    bool handle_list(int fd, const RequestHeader& req) {
+        std::vector<char> payload;
+        for (const Target& t : targets_) {
+            uint32_t entry[3] = {
+                (uint32_t)t.name.size(),
+                (uint32_t)t.tensor->shape()[0],
+                (uint32_t)t.tensor->shape()[1]
+            };
+            payload.insert(payload.end(), (char*)&entry[0], (char*)&entry[1]);
+            payload.insert(payload.end(), t.name.begin(), t.name.end());
+            payload.insert(payload.end(), (char*)&entry[1], (char*)&entry[3]);
+        }
+
+        ResponseHeader res{};
+        res.id = req.id;
+        res.rows = (uint32_t)targets_.size();
+        res.payload_bytes = payload.size();
+        return respond(fd, res, payload.data());
+    }
+
+    bool handle_matmul(int fd, const RequestHeader& req, LatencyTracker& latency) {
+        size_t rows = req.rows, cols = req.cols;
+        if (rows == 0 || cols == 0 || rows * cols > MAX_REQUEST_ELEMENTS) {
+            reply_status(fd, req, Status::BAD_REQUEST);
+            return false; // can't resync past a payload we refuse to read
+        }
+
+        // the payload has to be drained even when the request is rejected
+        TensorPool<float>::Handle A = tensors_.acquire({rows, cols});
+        if (!_socket::recv_all(fd, A->data(), rows * cols * sizeof(float))) return false;
+
+        Clock::time_point received = Clock::now();
+
+        if (req.weight >= targets_.size()) return reply_status(fd, req, Status::UNKNOWN_WEIGHT);
+
+        NTensor<float>& B = *targets_[req.weight].tensor;
+        if (B.shape()[0] != cols) return reply_status(fd, req, Status::SHAPE_MISMATCH);
+
+        NTensor<float> C = [&] {
+            std::future<NTensor<float>> fut = batcher_.submit(*A, B);
+            return fut.get();
+        }();
+        A.reset();
+
+        ResponseHeader res{};
+        res.id = req.id;
+        res.rows = (uint32_t)rows;
+        res.cols = (uint32_t)B.shape()[1];
+        res.latency_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - received).count();
+        res.payload_bytes = C.size() * sizeof(float);
+
+        latency.record(res.latency_us);
+        return respond(fd, res, C.data());
+    }
+};
+
+#endif // SERVER_HPP
@@ -0,0 +1,475 @@
+#ifndef SHM_TENSOR_HPP
+#define SHM_TENSOR_HPP
+
+#include <tensor.hpp>
+#include <serialize.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * POSIX shared-memory tensors.
+ *
+ * One process creates a segment and fills it; any number of others attach to
+ * it by logical name and map the data read-only, so N workers share a single
+ * copy of the weights. Logical names are resolved through a registry segment.
+ * The tensor segment carries its own reference count, and the last
+ * detach unlinks both the segment and its registry entry. A process that dies
+ * without detaching leaks its reference (the segment outlives it until
+ * ShmRegistry::destroy / manual shm_unlink). Likewise a creator that dies
+ * before initialising the registry leaves a segment nobody can use: openers
+ * give up after SHM_OPEN_TIMEOUT instead of waiting for it forever.
+ */
+constexpr uint32_t SHM_TENSOR_MAGIC = 0x54534D49; // "IMST"
+constexpr size_t SHM_MAX_DIMS = 8;
+constexpr size_t SHM_NAME_LEN = 64;
+constexpr size_t SHM_REGISTRY_CAPACITY = 256;
+constexpr size_t SHM_DATA_ALIGN = 64;
+constexpr std::chrono::milliseconds SHM_OPEN_TIMEOUT{5000};
+
+namespace _shm {
+
+inline std::runtime_error os_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+inline void copy_name(char (&dst)[SHM_NAME_LEN], const std::string& src) {
+    if (src.size() >= SHM_NAME_LEN) {
+        throw std::runtime_error("Shared-memory name too long: " + src);
+    }
+    std::memset(dst, 0, SHM_NAME_LEN);
+    std::memcpy(dst, src.data(), src.size());
+}
+
+struct Mapping {
+    void* addr = MAP_FAILED;
+    size_t len = 0;
+
+    Mapping() = default;
+    Mapping(void* a, size_t l) : addr(a), len(l) {}
+    Mapping(Mapping&& o) noexcept : addr(o.addr), len(o.len) { o.addr = MAP_FAILED; }
+    Mapping& operator=(Mapping&& o) noexcept {
+        std::swap(addr, o.addr);
+        std::swap(len, o.len);
+        return *this;
+    }
+    ~Mapping() { if (addr != MAP_FAILED) ::munmap(addr, len); }
+};
+
+// yield until ready() holds; false once `timeout` has passed without it
+template<typename F>
+bool wait_for(F&& ready, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!ready()) {
+        if (std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+inline Mapping map(int fd, size_t len, int prot) {
+    void* p = ::mmap(nullptr, len, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) throw os_error("mmap");
+    return Mapping(p, len);
+}
+
+class Lock {
+public:
+    explicit Lock(pthread_mutex_t* m) : m_(m) {
+        int rc = pthread_mutex_lock(m_);
+        if (rc == EOWNERDEAD) {
+            // previous holder crashed mid-update; entries are written field by
+            // field behind `used`, so the table is still consistent
+            pthread_mutex_consistent(m_);
+        } else if (rc != 0) {
+            throw std::runtime_error("Failed to lock shared-memory registry");
+        }
+    }
+    ~Lock() { pthread_mutex_unlock(m_); }
+
+private:
+    pthread_mutex_t* m_;
+};
+
+} // namespace _shm
+
+class ShmRegistry {
+public:
+    static ShmRegistry open(const std::string& name = "/intel-ml-registry",
+                            std::chrono::milliseconds timeout = SHM_OPEN_TIMEOUT) {
+        /**
+         * @brief Open (creating on first use) the registry mapping logical tensor names to segments
+         *
+         * @param (std::string) name: POSIX shm name of the registry itself
+         * @param (std::chrono::milliseconds) timeout: how long to wait for another
+         *     process's half-created registry to become ready before giving up
+        */
+        auto abandoned = [&] {
+            return std::runtime_error("Shared-memory registry " + name + " was never initialised by its creator"
+                                      " (remove it with ShmRegistry::destroy)");
+        };
+
+        ShmRegistry reg;
+        reg.name_ = name;
+
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        bool creator = fd >= 0;
+
+        if (!creator) {
+            if (errno != EEXIST) throw _shm::os_error("shm_open " + name);
+            fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+            if (fd < 0) throw _shm::os_error("shm_open " + name);
+
+            // creator may not have sized the segment yet
+            struct stat st;
+            int rc = 0;
+            bool sized = _shm::wait_for([&] {
+                rc = ::fstat(fd, &st);
+                return rc != 0 || (size_t)st.st_size >= sizeof(Table);
+            }, timeout);
+
+            if (rc != 0) {
+                ::close(fd);
+                throw _shm::os_error("fstat " + name);
+            }
+            if (!sized) {
+                ::close(fd);
+                throw abandoned();
+            }
+        } else if (::ftruncate(fd, sizeof(Table)) < 0) {
+            ::close(fd);
+            throw _shm::os_error("ftruncate " + name);
+        }
+
+        reg.map_ = _shm::map(fd, sizeof(Table), PROT_READ | PROT_WRITE);
+        ::close(fd);
+
+        Table* t = reg.table();
+        if (creator) {
+            pthread_mutexattr_t attr;
+            pthread_mutexattr_init(&attr);
+            pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&t->mutex, &attr);
+            pthread_mutexattr_destroy(&attr);
+
+            t->ready.store(1, std::memory_order_release);
+        } else if (!_shm::wait_for([t] { return t->ready.load(std::memory_order_acquire) != 0; }, timeout)) {
+            throw abandoned();
+        }
+
+        return reg;
+    }
+
+    static void destroy(const std::string& name = "/intel-ml-registry") {
+        ::shm_unlink(name.c_str());
+    }
+
+    void publish(const std::string& name, const std::string& segment) {
+        _shm::Lock lock(&table()->mutex);
+
+        Entry* free_slot = nullptr;
+        for (Entry& e : table()->entries) {
+            if (e.used && name == e.name) {
+                throw std::runtime_error("Shared tensor '" + name + "' is already registered");
+            }
+            if (!e.used && !free_slot) free_slot = &e;
+        }
+
+        if (!free_slot) throw std::runtime_error("Shared-memory registry is full");
+
+        _shm::copy_name(free_slot->name, name);
+        _shm::copy_name(free_slot->segment, segment);
+        free_slot->used = 1;
+    }
+
+    std::optional<std::string> lookup(const std::string& name) {
+        _shm::Lock lock(&table()->mutex);
+
+        for (Entry& e : table()->entries) {
+            if (e.used && name == e.name) return std::string(e.segment);
+        }
+        return std::nullopt;
+    }
+
+    void remove(const std::string& name, const std::string& segment) {
+        _shm::Lock lock(&table()->mutex);
+
+        // match the segment too, a newer tensor may have reused the name
+        for (Entry& e : table()->entries) {
+            if (e.used && name == e.name && segment == e.segment) e.used = 0;
+        }
+    }
+
+    std::vector<std::string> list() {
+        _shm::Lock lock(&table()->mutex);
+
+        std::vector<std::string> out;
+        for (Entry& e : table()->entries) {
+            if (e.used) out.emplace_back(e.name);
+        }
+        return out;
+    }
+
+    const std::string& name() const { return name_; }
+
+private:
+    struct Entry {
+        uint32_t used;
+        char name[SHM_NAME_LEN];
+        char segment[SHM_NAME_LEN];
+    };
+
+    struct Table {
+        std::atomic<uint32_t> ready;
+        pthread_mutex_t mutex;
+        Entry entries[SHM_REGISTRY_CAPACITY];
+    };
+
+    std::string name_;
+    _shm::Mapping map_;
+
+    Table* table() { return static_cast<Table*>(map_.addr); }
+};
+
+template<typename T = float>
+class SharedTensor {
+public:
+    SharedTensor(SharedTensor&& o) noexcept { *this = std::move(o); }
+
+    SharedTensor& operator=(SharedTensor&& o) noexcept {
+        if (this == &o) return *this;
+        detach();
+
+        reg_ = o.reg_;
+        name_ = std::move(o.name_);
+        segment_ = std::move(o.segment_);
+        header_map_ = std::move(o.header_map_);
+        data_map_ = std::move(o.data_map_);
+        data_ = o.data_;
+        writable_ = o.writable_;
+        attached_ = o.attached_;
+
+        o.data_ = nullptr;
+        o.attached_ = false;
+        return *this;
+    }
+    SharedTensor(const SharedTensor&) = delete;
+    SharedTensor& operator=(const SharedTensor&) = delete;
+
+    ~SharedTensor() { detach(); }
+
+    static SharedTensor create(ShmRegistry& reg, const std::string& name, const std::vector<size_t>& shape) {
+        /**
+         * @brief Allocate a writable shared tensor and register it under `name`
+         *
+         * @param (ShmRegistry) reg: registry the name is published in
+         * @param (std::string) name: logical name other processes attach by
+         * @param (std::vector<size_t>) shape: {highest order of abstraction -> scalar}
+         *
+         * @return (SharedTensor) owner handle holding one reference
+        */
+        if (shape.empty() || shape.size() > SHM_MAX_DIMS) {
+            throw std::runtime_error("Shared tensors support 1.." + std::to_string(SHM_MAX_DIMS) + " dimensions");
+        }
+
+        static std::atomic<uint32_t> counter{0};
+        std::string segment = "/iml." + std::to_string(::getpid()) + "." + std::to_string(counter++);
+
+        size_t count = 1;
+        for (size_t d : shape) count *= d;
+        size_t bytes = data_offset() + count * sizeof(T);
+
+        int fd = ::shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) throw _shm::os_error("shm_open " + segment);
+
+        if (::ftruncate(fd, (off_t)bytes) < 0) {
+            ::close(fd);
+            ::shm_unlink(segment.c_str());
+            throw _shm::os_error("ftruncate " + segment);
+        }
+
+        SharedTensor out;
+        out.reg_ = &reg;
+        out.name_ = name;
+        out.segment_ = segment;
+        out.writable_ = true;
+
+        try {
+            out.header_map_ = _shm::map(fd, bytes, PROT_READ | PROT_WRITE);
+        } catch (...) {
+            ::close(fd);
+            ::shm_unlink(segment.c_str());
+            throw;
+        }
+        ::close(fd);
+
+        Header* h = out.header();
+        h->magic = SHM_TENSOR_MAGIC;
+        h->dtype = dtype_of<T>();
+        h->ndim = (uint32_t)shape.size();
+        for (size_t i = 0; i < shape.size(); ++i) h->shape[i] = shape[i];
+        h->size = count;
+        h->refcount.store(1, std::memory_order_release);
+
+        out.data_ = reinterpret_cast<T*>(static_cast<char*>(out.header_map_.addr) + data_offset());
+        out.attached_ = true;
+
+        try {
+            reg.publish(name, segment);
+        } catch (...) {
+            ::shm_unlink(segment.c_str());
+            out.attached_ = false;
+            throw;
+        }
+
+        return out;
+    }
+
+    static SharedTensor create_from(ShmRegistry& reg, const std::string& name, NTensor<T>& t) {
+        SharedTensor out = create(reg, name, std::vector<size_t>(t.shape(), t.shape() + t.ndim()));
+        std::copy(t.data(), t.data() + t.size(), out.mutable_data());
+        return out;
+    }
+
+    static SharedTensor attach(ShmRegistry& reg, const std::string& name) {
+        /**
+         * @brief Map an existing shared tensor read-only, without copying its data
+         *
+         * @param (ShmRegistry) reg: registry to resolve `name` in
+         * @param (std::string) name: logical name given at create()
+         *
+         * @return (SharedTensor) reader handle holding one reference
+        */
+        std::optional<std::string> segment = reg.lookup(name);
+        if (!segment) throw std::runtime_error("No shared tensor named '" + name + "'");
+
+        int fd = ::shm_open(segment->c_str(), O_RDWR, 0600);
+        if (fd < 0) throw _shm::os_error("shm_open " + *segment);
+
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || (size_t)st.st_size < data_offset()) {
+            ::close(fd);
+            throw std::runtime_error("Shared tensor segment " + *segment + " is truncated");
+        }
+
+        SharedTensor out;
+        out.reg_ = &reg;
+        out.name_ = name;
+        out.segment_ = *segment;
+
+        try {
+            // header page stays writable for the refcount, the payload is read-only
+            out.header_map_ = _shm::map(fd, data_offset(), PROT_READ | PROT_WRITE);
+            out.data_map_ = _shm::map(fd, (size_t)st.st_size, PROT_READ);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+
+        Header* h = out.header();
+        if (h->magic != SHM_TENSOR_MAGIC || h->dtype != dtype_of<T>()) {
+            throw std::runtime_error("Shared tensor '" + name + "' has a different dtype");
+        }
+
+        // only take a reference while the segment is still alive
+        uint32_t rc = h->refcount.load(std::memory_order_acquire);
+        do {
+            if (rc == 0) throw std::runtime_error("Shared tensor '" + name + "' is being destroyed");
+        } while (!h->refcount.compare_exchange_weak(rc, rc + 1, std::memory_order_acq_rel));
+
+        out.data_ = reinterpret_cast<T*>(static_cast<char*>(out.data_map_.addr) + data_offset());
+        out.attached_ = true;
+
+        return out;
+    }
+
+    void detach() {
+        /**
+         * @brief Drop this handle's reference; the last one unlinks the segment
+        */
+        if (!attached_) return;
+        attached_ = false;
+
+        if (header()->refcount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            reg_->remove(name_, segment_);
+            ::shm_unlink(segment_.c_str());
+        }
+
+        data_map_ = _shm::Mapping();
+        header_map_ = _shm::Mapping();
+        data_ = nullptr;
+    }
+
+    const T* data() const { return data_; }
+
+    T* mutable_data() {
+        if (!writable_) throw std::runtime_error("Shared tensor '" + name_ + "' is attached read-only");
+        return data_;
+    }
+
+    VTensor<const T> view() const {
+        if (ndim() != 2) throw std::runtime_error("Views are only supported for 2D shared tensors");
+
+        VTensor<const T> out;
+        out.data_ = data_;
+        out.shape_[0] = header()->shape[0];
+        out.shape_[1] = header()->shape[1];
+        out.stride_[0] = header()->shape[1];
+        out.stride_[1] = 1;
+        out.size_ = size();
+        out.ndim_ = 2;
+        return out;
+    }
+
+    std::vector<size_t> shape() const {
+        return std::vector<size_t>(header()->shape, header()->shape + header()->ndim);
+    }
+
+    size_t ndim() const { return header()->ndim; }
+    size_t size() const { return header()->size; }
+    uint32_t refcount() const { return header()->refcount.load(std::memory_order_acquire); }
+    const std::string& name() const { return name_; }
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t dtype;
+        uint32_t ndim;
+        std::atomic<uint32_t> refcount;
+        uint64_t size;
+        uint64_t shape[SHM_MAX_DIMS];
+    };
+
+    ShmRegistry* reg_ = nullptr;
+    std::string name_;
+    std::string segment_;
+    _shm::Mapping header_map_;
+    _shm::Mapping data_map_;
+    T* data_ = nullptr;
+    bool writable_ = false;
+    bool attached_ = false;
+
+    SharedTensor() = default;
+
+    static constexpr size_t data_offset() {
+        return (sizeof(Header) + SHM_DATA_ALIGN - 1) / SHM_DATA_ALIGN * SHM_DATA_ALIGN;
+    }
+
+    Header* header() const { return static_cast<Header*>(header_map_.addr); }
+};
+
+#endif // SHM_TENSOR_HPP
@@ -0,0 +1,141 @@
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace _socket {
+
+inline std::runtime_error os_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+inline bool send_all(int fd, const void* buf, size_t n) {
+    /**
+     * @brief Write exactly n bytes, retrying on short writes / EINTR
+     *
+     * @return (bool) false if the peer went away
+    */
+    const char* p = static_cast<const char*>(buf);
+    while (n > 0) {
+        ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+inline bool recv_all(int fd, void* buf, size_t n) {
+    /**
+     * @brief Read exactly n bytes straight into buf (no staging copy)
+     *
+     * @return (bool) false on EOF or error before n bytes arrived
+    */
+    char* p = static_cast<char*>(buf);
+    while (n > 0) {
+        ssize_t r = ::recv(fd, p, n, MSG_WAITALL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+inline int listen_unix(const std::string& path, int backlog = 64) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw os_error("socket(AF_UNIX)");
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        ::close(fd);
+        throw std::runtime_error("Unix socket path too long: " + path);
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    ::unlink(path.c_str());
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, backlog) < 0) {
+        ::close(fd);
+        throw os_error("bind/listen " + path);
+    }
+
+    return fd;
+}
+
+inline int listen_tcp(uint16_t port, const char* host = "127.0.0.1", int backlog = 64) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) throw os_error("socket(AF_INET)");
+
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        ::close(fd);
+        throw std::runtime_error(std::string("Bad IPv4 address: ") + host);
+    }
+
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, backlog) < 0) {
+        ::close(fd);
+        throw os_error("bind/listen tcp port " + std::to_string(port));
+    }
+
+    return fd;
+}
+
+inline int connect_unix(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw os_error("socket(AF_UNIX)");
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        throw os_error("connect " + path);
+    }
+
+    return fd;
+}
+
+inline int connect_tcp(const char* host, uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) throw os_error("socket(AF_INET)");
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (::inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        ::close(fd);
+        throw std::runtime_error(std::string("Bad IPv4 address: ") + host);
+    }
+
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        throw os_error("connect " + std::string(host) + ":" + std::to_string(port));
+    }
+
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    return fd;
+}
+
+} // namespace _socket
+
+#endif // SOCKET_HPP
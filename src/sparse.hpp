@@ -0,0 +1,394 @@
+#ifndef SPARSE_HPP
+#define SPARSE_HPP
+
+#include <activation.hpp>
+#include <gemm.hpp>
+#include <half.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Sparse weight formats for Y[M x N] = act(X[M x K] * W[K x N] + bias), with
+ * W in the Dense [in x out] orientation, and the kernels that consume them.
+ *
+ *   SparseCSR     any pattern. Per output column j, the (k, w) pairs of its
+ *                 non-zeros. X is packed once into GEMM_PANEL_N-row blocks
+ *                 stored k-major, so each non-zero is one vector FMA over the
+ *                 block's 16 rows and W is read once per row block.
+ *   SparseNM      N of every M consecutive k kept per column (2:4). Same
+ *                 kernel as CSR, but a column has exactly K * N / M values
+ *                 and one byte of position per value instead of a full index.
+ *   BlockSparse   W cut into block_k x GEMM_PANEL_N blocks, only non-zero
+ *                 blocks stored, each panel's blocks contiguous. The kernel
+ *                 is the packed GEMM micro-tile with K restricted to the
+ *                 kept blocks, so dense-speed FLOPs on the blocks that remain.
+ *
+ * Every format is built from a dense W whose pruned entries are exactly zero
+ * (see prune.hpp); from_dense() of an unpruned W is valid, just not sparse.
+ * CSR and N:M stream an index per value, so against gemm_packed they only pay
+ * off from roughly 80% sparsity; BlockSparse scales with the kept fraction
+ * (intel-ml-bench sparse).
+ */
+constexpr size_t SPARSE_TILE_N = 64;
+
+template<typename T = float>
+struct SparseCSR {
+    size_t K = 0, N = 0;
+    std::vector<uint32_t> col_ptr;  // N + 1 offsets into idx / val
+    std::vector<uint32_t> idx;      // k of each non-zero
+    std::vector<T> val;
+
+    size_t nnz() const { return val.size(); }
+
+    static SparseCSR from_dense(const T* W, size_t K, size_t N) {
+        /**
+         * @brief Compress W [K x N], dropping exact zeros
+        */
+        SparseCSR s;
+        s.K = K;
+        s.N = N;
+        s.col_ptr.assign(N + 1, 0);
+
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t k = 0; k < K; ++k) {
+                const T w = W[k * N + j];
+                if (w == (T)0) continue;
+                s.idx.push_back((uint32_t)k);
+                s.val.push_back(w);
+            }
+            s.col_ptr[j + 1] = (uint32_t)s.val.size();
+        }
+        return s;
+    }
+};
+
+template<typename T = float>
+struct SparseNM {
+    size_t K = 0, N = 0;
+    size_t n = 2, m = 4;
+    std::vector<uint8_t> pos;       // [N x K/m x n] position of each kept value inside its group
+    std::vector<T> val;             // [N x K/m x n]
+
+    size_t per_col() const { return K / m * n; }
+
+    static SparseNM from_dense(const T* W, size_t K, size_t N, size_t n = 2, size_t m = 4) {
+        /**
+         * @brief Compress W [K x N] whose every group of m consecutive k per column has at most n non-zeros
+        */
+        if (m == 0 || n == 0 || n > m || m > 255 || K % m != 0) {
+            throw std::runtime_error("SparseNM: K = " + std::to_string(K) + " does not split into " +
+                                     std::to_string(n) + ":" + std::to_string(m) + " groups");
+        }
+
+        SparseNM s;
+        s.K = K;
+        s.N = N;
+        s.n = n;
+        s.m = m;
+        s.pos.assign(N * s.per_col(), 0);
+        s.val.assign(N * s.per_col(), (T)0);
+
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t g = 0; g < K / m; ++g) {
+                size_t kept = 0;
+                const size_t at = j * s.per_col() + g * n;
+
+                for (size_t i = 0; i < m; ++i) {
+                    const T w = W[(g * m + i) * N + j];
+                    if (w == (T)0) continue;
+                    if (kept == n) {
+                        throw std::runtime_error("SparseNM: column " + std::to_string(j) + " has more than " +
+                                                 std::to_string(n) + " non-zeros in a group of " + std::to_string(m));
+                    }
+                    s.pos[at + kept] = (uint8_t)i;
+                    s.val[at + kept] = w;
+                    ++kept;
+                }
+                // unused slots keep value 0 at position 0
+            }
+        }
+        return s;
+    }
+};
+
+template<typename T = float>
+struct BlockSparse {
+    size_t K = 0, N = 0;
+    size_t block_k = 4;
+    std::vector<uint32_t> panel_ptr;    // panels() + 1 offsets into k0, in blocks
+    std::vector<uint32_t> k0;           // first k of each kept block
+    std::vector<T> data;                // per kept block [block_k x GEMM_PANEL_N], zero padded
+
+    size_t panels() const { return (N + GEMM_PANEL_N - 1) / GEMM_PANEL_N; }
+    size_t blocks() const { return k0.size(); }
+    const T* block(size_t b) const { return data.data() + b * block_k * GEMM_PANEL_N; }
+
+    static BlockSparse from_dense(const T* W, size_t K, size_t N, size_t block_k = 4) {
+        /**
+         * @brief Compress W [K x N], keeping every block_k x GEMM_PANEL_N block with a non-zero
+        */
+        if (block_k == 0) throw std::runtime_error("BlockSparse: block_k must be positive");
+
+        BlockSparse s;
+        s.K = K;
+        s.N = N;
+        s.block_k = block_k;
+        s.panel_ptr.assign(s.panels() + 1, 0);
+
+        for (size_t p = 0; p < s.panels(); ++p) {
+            const size_t j0 = p * GEMM_PANEL_N, jn = std::min(GEMM_PANEL_N, N - j0);
+
+            for (size_t k = 0; k < K; k += block_k) {
+                const size_t kn = std::min(block_k, K - k);
+                bool any = false;
+                for (size_t r = 0; r < kn && !any; ++r)
+                    for (size_t j = 0; j < jn && !any; ++j) any = W[(k + r) * N + j0 + j] != (T)0;
+                if (!any) continue;
+
+                s.k0.push_back((uint32_t)k);
+                const size_t at = s.data.size();
+                s.data.resize(at + block_k * GEMM_PANEL_N, (T)0);
+                for (size_t r = 0; r < kn; ++r)
+                    for (size_t j = 0; j < jn; ++j) s.data[at + r * GEMM_PANEL_N + j] = W[(k + r) * N + j0 + j];
+            }
+            s.panel_ptr[p + 1] = (uint32_t)s.k0.size();
+        }
+        return s;
+    }
+};
+
+namespace _sparse {
+
+// X in GEMM_PANEL_N-row blocks, [block][k][GEMM_PANEL_N] in accum_t<T>, zero padded:
+// column k of a block is one PanelVec
+template<typename T>
+void pack_rows(const T* X, size_t lda, size_t M, size_t K, std::vector<accum_t<T>>& xp, ThreadPool* pool) {
+    const size_t blocks = (M + GEMM_PANEL_N - 1) / GEMM_PANEL_N;
+    xp.assign(blocks * K * GEMM_PANEL_N, (accum_t<T>)0);
+
+    auto run = [&](size_t lo, size_t hi) {
+        for (size_t b = lo; b < hi; ++b) {
+            accum_t<T>* dst = xp.data() + b * K * GEMM_PANEL_N;
+            const size_t rows = std::min(GEMM_PANEL_N, M - b * GEMM_PANEL_N);
+
+            for (size_t r = 0; r < rows; ++r) {
+                const T* x = X + (b * GEMM_PANEL_N + r) * lda;
+                for (size_t k = 0; k < K; ++k) dst[k * GEMM_PANEL_N + r] = (accum_t<T>)x[k];
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, blocks, 1, run);
+    else run(0, blocks);
+}
+
+// tasks over (row block, SPARSE_TILE_N columns); column(j, xb, out) writes output column j for
+// the block's rows to out[GEMM_PANEL_N], the tile is then written out row by row with bias and
+// activation. Vectors go through memory rather than by value: PanelVec may be wider than the
+// enabled ISA, and passing it across a call would change the ABI (-Wpsabi)
+template<typename T, typename F>
+void for_columns(const T* X, size_t lda, size_t M, size_t K, size_t N, T* Y, size_t ldc,
+                 const T* bias, Activation act, ThreadPool* pool, F&& column) {
+    using Acc = accum_t<T>;
+
+    // per call, not thread_local: ThreadPool::wait() runs queued tasks on the waiting thread,
+    // so a nested sparse_matmul on this thread would repack a shared buffer under our tasks
+    std::vector<Acc> xp;
+    pack_rows(X, lda, M, K, xp, pool);
+
+    const size_t blocks = (M + GEMM_PANEL_N - 1) / GEMM_PANEL_N;
+    const size_t tiles_n = (N + SPARSE_TILE_N - 1) / SPARSE_TILE_N;
+    const Acc* packed = xp.data();
+
+    auto run = [&](size_t lo, size_t hi) {
+        Acc tile[SPARSE_TILE_N * GEMM_PANEL_N];     // [column][row]
+
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t b = t / tiles_n, rows = std::min(GEMM_PANEL_N, M - b * GEMM_PANEL_N);
+            const size_t j0 = (t % tiles_n) * SPARSE_TILE_N, j1 = std::min(j0 + SPARSE_TILE_N, N);
+            const Acc* xb = packed + b * K * GEMM_PANEL_N;
+
+            for (size_t j = j0; j < j1; ++j) column(j, xb, tile + (j - j0) * GEMM_PANEL_N);
+
+            for (size_t r = 0; r < rows; ++r) {
+                T* y = Y + (b * GEMM_PANEL_N + r) * ldc;
+                for (size_t j = j0; j < j1; ++j) {
+                    y[j] = (T)(tile[(j - j0) * GEMM_PANEL_N + r] + (bias ? (Acc)bias[j] : (Acc)0));
+                }
+                activate_inplace(y + j0, j1 - j0, act);
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, blocks * tiles_n, 1, run);
+    else run(0, blocks * tiles_n);
+}
+
+// block sparse counterpart of gemm_packed_micro: accumulators stay in registers across the kept blocks
+template<typename T, size_t MR>
+inline void block_micro(const T* A, size_t lda, const BlockSparse<T>& W, size_t b0, size_t b1, T* c_out) {
+    const size_t bk = W.block_k;
+
+    if constexpr (!std::is_arithmetic_v<T>) {
+        for (size_t r = 0; r < MR; ++r) {
+            accum_t<T> c[GEMM_PANEL_N] = {};
+            for (size_t b = b0; b < b1; ++b) {
+                const T* bp = W.block(b);
+                const size_t k0 = W.k0[b], kn = std::min(bk, W.K - k0);
+                for (size_t k = 0; k < kn; ++k) {
+                    const accum_t<T> a = (accum_t<T>)A[r * lda + k0 + k];
+                    for (size_t j = 0; j < GEMM_PANEL_N; ++j) c[j] += a * (accum_t<T>)bp[k * GEMM_PANEL_N + j];
+                }
+            }
+            for (size_t j = 0; j < GEMM_PANEL_N; ++j) c_out[r * GEMM_PANEL_N + j] = (T)c[j];
+        }
+    } else {
+        typedef typename PanelVec<T>::type V;
+        V c[MR];
+        for (size_t r = 0; r < MR; ++r) c[r] = V{};
+
+        for (size_t b = b0; b < b1; ++b) {
+            const T* bp = W.block(b);
+            const size_t k0 = W.k0[b], kn = std::min(bk, W.K - k0);
+
+            for (size_t k = 0; k < kn; ++k) {
+                V v;
+                std::memcpy(&v, bp + k * GEMM_PANEL_N, sizeof(v));
+                for (size_t r = 0; r < MR; ++r) c[r] += A[r * lda + k0 + k] * v;
+            }
+        }
+
+        for (size_t r = 0; r < MR; ++r) std::memcpy(c_out + r * GEMM_PANEL_N, &c[r], sizeof(V));
+    }
+}
+
+} // namespace _sparse
+
+template<typename T>
+void sparse_matmul(const T* X, size_t lda, size_t M, const SparseCSR<T>& W, T* Y, size_t ldc,
+                   const T* bias = nullptr, Activation act = Activation::IDENTITY, ThreadPool* pool = nullptr) {
+    /**
+     * @brief Y[M x N] = act(X[M x K] * W + bias) for a CSR-compressed W
+     *
+     * @param (const T*) X: [M x K] row-major, leading dimension lda
+     * @param (T*) Y: [M x N] output, leading dimension ldc
+     * @param (ThreadPool*) pool: run tiles on this pool, nullptr = calling thread
+    */
+    using Acc = accum_t<T>;
+    typedef typename PanelVec<Acc>::type V;
+
+    _sparse::for_columns(X, lda, M, W.K, W.N, Y, ldc, bias, act, pool, [&](size_t j, const Acc* xb, Acc* out) {
+        auto fma = [&](V& acc, uint32_t e) {
+            V v;
+            std::memcpy(&v, xb + (size_t)W.idx[e] * GEMM_PANEL_N, sizeof(V));
+            acc += (Acc)W.val[e] * v;
+        };
+
+        // four independent chains hide the FMA latency
+        V a0 = V{}, a1 = V{}, a2 = V{}, a3 = V{};
+        uint32_t e = W.col_ptr[j];
+        for (; e + 4 <= W.col_ptr[j + 1]; e += 4) {
+            fma(a0, e);
+            fma(a1, e + 1);
+            fma(a2, e + 2);
+            fma(a3, e + 3);
+        }
+        for (; e < W.col_ptr[j + 1]; ++e) fma(a0, e);
+
+        const V acc = (a0 + a1) + (a2 + a3);
+        std::memcpy(out, &acc, sizeof(V));
+    });
+}
+
+template<typename T>
+void sparse_matmul(const T* X, size_t lda, size_t M, const SparseNM<T>& W, T* Y, size_t ldc,
+                   const T* bias = nullptr, Activation act = Activation::IDENTITY, ThreadPool* pool = nullptr) {
+    /**
+     * @brief Y[M x N] = act(X[M x K] * W + bias) for an N:M-compressed W
+    */
+    using Acc = accum_t<T>;
+    typedef typename PanelVec<Acc>::type V;
+    const size_t groups = W.K / W.m, per = W.per_col();
+
+    _sparse::for_columns(X, lda, M, W.K, W.N, Y, ldc, bias, act, pool, [&](size_t j, const Acc* xb, Acc* out) {
+        const T* v = W.val.data() + j * per;
+        const uint8_t* p = W.pos.data() + j * per;
+
+        auto fma = [&](V& acc, size_t g, size_t i) {
+            V r;
+            std::memcpy(&r, xb + (g * W.m + p[g * W.n + i]) * GEMM_PANEL_N, sizeof(V));
+            acc += (Acc)v[g * W.n + i] * r;
+        };
+
+        // kept values of a column are consecutive, so alternate two chains over them
+        V a0 = V{}, a1 = V{};
+        if (W.n == 2) {
+            for (size_t g = 0; g < groups; ++g) {
+                fma(a0, g, 0);
+                fma(a1, g, 1);
+            }
+        } else {
+            for (size_t g = 0; g < groups; ++g)
+                for (size_t i = 0; i < W.n; ++i) fma(i % 2 ? a1 : a0, g, i);
+        }
+
+        const V acc = a0 + a1;
+        std::memcpy(out, &acc, sizeof(V));
+    });
+}
+
+template<typename T>
+void sparse_matmul(const T* X, size_t lda, size_t M, const BlockSparse<T>& W, T* Y, size_t ldc,
+                   const T* bias = nullptr, Activation act = Activation::IDENTITY, ThreadPool* pool = nullptr) {
+    /**
+     * @brief Y[M x N] = act(X[M x K] * W + bias) for a block-sparse W
+     *
+     * Tasks are GEMM_TILE_M rows by GEMM_TILE_N / GEMM_PANEL_N panels, as in gemm_packed().
+    */
+    const size_t panels_per_tile = GEMM_TILE_N / GEMM_PANEL_N;
+    const size_t tiles_m = (M + GEMM_TILE_M - 1) / GEMM_TILE_M;
+    const size_t tiles_n = (W.panels() + panels_per_tile - 1) / panels_per_tile;
+
+    auto run = [&](size_t lo, size_t hi) {
+        T tile[GEMM_MICRO_M * GEMM_PANEL_N];
+
+        for (size_t t = lo; t < hi; ++t) {
+            const size_t i0 = (t / tiles_n) * GEMM_TILE_M, i1 = std::min(i0 + GEMM_TILE_M, M);
+            const size_t p0 = (t % tiles_n) * panels_per_tile, p1 = std::min(p0 + panels_per_tile, W.panels());
+
+            for (size_t p = p0; p < p1; ++p) {
+                const size_t j0 = p * GEMM_PANEL_N, jn = std::min(GEMM_PANEL_N, W.N - j0);
+                const size_t b0 = W.panel_ptr[p], b1 = W.panel_ptr[p + 1];
+
+                for (size_t i = i0; i < i1; i += GEMM_MICRO_M) {
+                    const size_t mr = std::min(GEMM_MICRO_M, i1 - i);
+                    if (mr == GEMM_MICRO_M) {
+                        _sparse::block_micro<T, GEMM_MICRO_M>(X + i * lda, lda, W, b0, b1, tile);
+                    } else {
+                        for (size_t r = 0; r < mr; ++r)
+                            _sparse::block_micro<T, 1>(X + (i + r) * lda, lda, W, b0, b1, tile + r * GEMM_PANEL_N);
+                    }
+
+                    for (size_t r = 0; r < mr; ++r) {
+                        T* c = Y + (i + r) * ldc + j0;
+                        const T* v = tile + r * GEMM_PANEL_N;
+                        for (size_t j = 0; j < jn; ++j) c[j] = v[j] + (bias ? bias[j0 + j] : (T)0);
+                        activate_inplace(c, jn, act);
+                    }
+                }
+            }
+        }
+    };
+
+    if (pool) pool->parallel_for(0, tiles_m * tiles_n, 1, run);
+    else run(0, tiles_m * tiles_n);
+}
+
+#endif // SPARSE_HPP
@@ -2,10 +2,15 @@
 #define TENSOR_HPP
 
 #include <log.hpp>
+#include <cancel.hpp>
+#include <layout.hpp>
 
 #include <initializer_list>
-#include <vector>
+#include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
 
 typedef struct NTensorConfig {
 	size_t strassen_threshold;
@@ -15,8 +20,8 @@ template<typename T = float>
 class VTensor {
 public:
     T* data_;
-    const size_t* shape_;
-    const size_t* stride_;
+    size_t shape_[2];
+    size_t stride_[2];
     size_t size_;
     size_t ndim_;
 
@@ -116,9 +121,11 @@ public:
         out.data_ = data_.data() + a * stride_[0] + c * stride_[1];
         out.size_ = rows * cols;
 
-        // Allocate new stride array for the view
-        out.stride_ = new size_t[2]{ stride_[0], stride_[1] };
-        out.shape_  = new size_t[2]{ rows, cols };
+        // Views are 2D only, so shape/stride live inline and need no cleanup
+        out.stride_[0] = stride_[0];
+        out.stride_[1] = stride_[1];
+        out.shape_[0] = rows;
+        out.shape_[1] = cols;
         out.ndim_ = 2;
 
         return out;
@@ -185,21 +192,21 @@ public:
         }
     }
 
-    NTensor<T> matmul(NTensor<T> t) {
+    NTensor<T> matmul(NTensor<T> t, const CancellationToken& cancel = {}) {
         if (ndim_ == 2) {
             if (size_ < config_.strassen_threshold) {
-                return static_matmul(t);
+                return static_matmul(t, cancel);
             }
 
             _log::log_message(_log::DEBUG, "Strassen!");
             
-            return strassen_matmul(*this, t);
+            return strassen_matmul(*this, t, cancel);
         }
 
         // implement for n_ > 2
     }  
 
-    NTensor<T> static_matmul(NTensor<T> t) {    
+    NTensor<T> static_matmul(NTensor<T> t, const CancellationToken& cancel = {}) {    
         size_t rows = shape_[1];
         size_t cols = t.shape_[0];
         _log::log_message(_log::DEBUG, "%zu, %zu", rows, cols);
@@ -208,6 +215,8 @@ public:
 
 
         for (size_t row = 0; row < rows; row++) {
+            cancel.throw_if_cancelled();
+
             size_t col_off = cols * row;
             for (size_t col = 0; col < cols; col++) {
                 T val = 0;
@@ -227,10 +236,20 @@ public:
     }
 
 
-    NTensor<T> strassen_matmul(NTensor<T> A, NTensor<T> B) {
+    NTensor<T> strassen_matmul(NTensor<T> A, NTensor<T> B, const CancellationToken& cancel = {}) {
+        /**
+         * @brief Strassen's multiplication, recursing on quadrants
+         *
+         * @param (NTensor<T>) A, B: square operands
+         * @param (CancellationToken) cancel: polled at every recursion boundary;
+         *     once tripped, OperationCancelled unwinds the recursion and every
+         *     intermediate m1..m7 / buffer is freed on the way out
+        */
+        cancel.throw_if_cancelled();
+
         if (A.shape_[0] <= 4 && B.shape_[1] <= 4) {
             _log::log_message(_log::DEBUG, "Static within strassen!"); 
-            return A.static_matmul(B);
+            return A.static_matmul(B, cancel);
         }
 
         VTensor<T> a, b, c, d, e, f, g, h;
@@ -245,38 +264,38 @@ public:
         
         // m1 = strassen(a + d, e + h) 
         buf1.add(a, d);
-        buf2.sub(e, h);
-        NTensor<T> m1 = strassen_matmul(buf1, buf2);
+        buf2.add(e, h);
+        NTensor<T> m1 = strassen_matmul(buf1, buf2, cancel);
         
         // m2 = strassen(d, g - e)
-        buf2.eq(d);
+        buf1.eq(d);
         buf2.sub(g, e);
-        NTensor<T> m2 = strassen_matmul(buf1, buf2);
+        NTensor<T> m2 = strassen_matmul(buf1, buf2, cancel);
 
         // m3 = strassen(a + b, h)
         buf1.add(a, b);
         buf2.eq(h);
-        NTensor<T> m3 = strassen_matmul(buf1, buf2);
+        NTensor<T> m3 = strassen_matmul(buf1, buf2, cancel);
         
         // m4 = strassen(b - d, g + h)
         buf1.sub(b, d); 
         buf2.add(g, h);
-        NTensor<T> m4 = strassen_matmul(buf1, buf2);
+        NTensor<T> m4 = strassen_matmul(buf1, buf2, cancel);
         
         // m5 = strassen(a, f - h)
         buf1.eq(a);
         buf2.sub(f, h);
-        NTensor<T> m5 = strassen_matmul(buf1, buf2);
+        NTensor<T> m5 = strassen_matmul(buf1, buf2, cancel);
 
         // m6 = strassen(c + d, e)
         buf1.add(c, d);
         buf2.eq(e);
-        NTensor<T> m6 = strassen_matmul(buf1, buf2);
+        NTensor<T> m6 = strassen_matmul(buf1, buf2, cancel);
 
         // m7 = strassen(a - c, e + f)
         buf1.sub(a, c); 
         buf2.add(e, f);
-        NTensor<T> m7 = strassen_matmul(buf1, buf2);
+        NTensor<T> m7 = strassen_matmul(buf1, buf2, cancel);
         
         NTensor<T> c11 = m1.add(m2).sub(m3).add(m4);
         NTensor<T> c12 = m5.add(m3);
@@ -325,7 +344,7 @@ public:
     }
 
 
-    std::tuple<VTensor<T>, VTensor<T>, VTensor<T>, VTensor<T>> strassen_split(NTensor<T> t){
+    std::tuple<VTensor<T>, VTensor<T>, VTensor<T>, VTensor<T>> strassen_split(NTensor<T>& t){
         size_t rows = t.shape_[0];
         size_t columns = t.shape_[1];
 
@@ -396,8 +415,15 @@ public:
     T* data() { return data_.data(); };
     const size_t* shape() { return shape_.data(); };
     size_t ndim() { return ndim_; };
+    size_t size() { return size_; };
+    NTensorConfig config() { return config_; };
+
+    // how a 4-D activation's dims map to [N, C, H, W]; see layout.hpp
+    const TensorLayout& layout() { return layout_; };
+    void set_layout(const TensorLayout& layout) { layout_ = layout; };
 private:
     NTensorConfig config_;
+    TensorLayout layout_;
 
     std::vector<size_t> shape_;
     std::vector<size_t> stride_;
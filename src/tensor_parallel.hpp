@@ -0,0 +1,194 @@
+#ifndef TENSOR_PARALLEL_HPP
+#define TENSOR_PARALLEL_HPP
+
+#include <collectives.hpp>
+#include <gemm.hpp>
+
+#include <vector>
+
+/*
+ * Tensor-parallel Y = X * B with B sharded across the ranks of a Transport.
+ *
+ * ColumnParallelLinear: rank r holds B[:, cols_r] and produces Y[:, cols_r];
+ *     the full Y is rebuilt with an all-gather.
+ * RowParallelLinear:    rank r holds B[rows_r, :] and produces a partial Y
+ *     from X[:, rows_r]; partials are combined with a reduce-scatter (Y split
+ *     by rows) or an all-reduce (full Y everywhere).
+ *
+ * Chaining a ColumnParallelLinear with gather_output = false into a
+ * RowParallelLinear with a sharded input needs a single collective for the
+ * pair.
+ */
+enum class RowCombine { ALL_REDUCE, REDUCE_SCATTER };
+
+namespace _tensor_parallel {
+
+template<typename T>
+void local_gemm(const T* X, size_t ldx, const T* B, T* Y, size_t M, size_t K, size_t N, ThreadPool& pool) {
+    GemmArgs<T> g;
+    g.M = M; g.N = N; g.K = K;
+    g.A = X; g.lda = ldx;
+    g.B = B; g.ldb = N;
+    g.C = Y; g.ldc = N;
+    gemm_parallel(g, pool);
+}
+
+} // namespace _tensor_parallel
+
+template<typename T = float>
+class ColumnParallelLinear {
+public:
+    ColumnParallelLinear(NTensor<T>& B, Transport& tr, ThreadPool& pool = ThreadPool::global())
+        : ColumnParallelLinear(local_block(B, 1, tr.size(), 0, tr.rank()), B.shape()[1], tr, pool)
+    {}
+
+    ColumnParallelLinear(NTensor<T> shard, size_t N, Transport& tr, ThreadPool& pool = ThreadPool::global())
+        : shard_(std::move(shard)), N_(N), tr_(tr), pool_(pool)
+    {
+        /**
+         * @brief Column-sharded weight; this rank keeps B[:, block_range(N, W, rank)]
+         *
+         * @param (NTensor<T>) shard: [K x N_r] local columns of B
+         * @param (size_t) N: global output width
+         * @param (Transport) tr: job transport
+        */
+        auto [c0, c1] = block_range(N, tr.size(), tr.rank());
+        if (shard_.ndim() != 2 || shard_.shape()[1] != c1 - c0) {
+            throw std::runtime_error("ColumnParallelLinear: shard does not match block_range(N, W, rank)");
+        }
+    }
+
+    NTensor<T> forward(NTensor<T>& X, bool gather_output = true) {
+        /**
+         * @brief Y = X * B
+         *
+         * @param (NTensor<T>) X: [M x K], replicated on every rank
+         * @param (bool) gather_output: all-gather into [M x N], else return the local [M x N_r] columns
+        */
+        const size_t K = shard_.shape()[0], W = tr_.size();
+        if (X.ndim() != 2 || X.shape()[1] != K) {
+            throw std::runtime_error("ColumnParallelLinear: input must be [M x K]");
+        }
+
+        const size_t M = X.shape()[0], n_loc = shard_.shape()[1];
+
+        if (!gather_output) {
+            NTensor<T> Y({M, n_loc}, (T)0, X.config());
+            _tensor_parallel::local_gemm(X.data(), K, shard_.data(), Y.data(), M, K, n_loc, pool_);
+            return Y;
+        }
+
+        // shard-major staging: rank r's [M x N_r] block is one contiguous segment
+        std::vector<size_t> counts(W);
+        for (size_t r = 0; r < W; ++r) {
+            auto [c0, c1] = block_range(N_, W, r);
+            counts[r] = M * (c1 - c0);
+        }
+        std::vector<size_t> offs = _collectives::offsets(counts, W);
+
+        std::vector<T> staged(offs[W]);
+        _tensor_parallel::local_gemm(X.data(), K, shard_.data(), staged.data() + offs[tr_.rank()], M, K, n_loc, pool_);
+
+        all_gather_v(staged.data(), counts, tr_);
+
+        NTensor<T> Y({M, N_}, (T)0, X.config());
+        for (size_t r = 0; r < W; ++r) {
+            auto [c0, c1] = block_range(N_, W, r);
+            const T* src = staged.data() + offs[r];
+
+            for (size_t i = 0; i < M; ++i) {
+                std::copy(src + i * (c1 - c0), src + (i + 1) * (c1 - c0), Y.data() + i * N_ + c0);
+            }
+        }
+
+        return Y;
+    }
+
+    NTensor<T>& shard() { return shard_; }
+
+private:
+    NTensor<T> shard_;
+    size_t N_;
+    Transport& tr_;
+    ThreadPool& pool_;
+};
+
+template<typename T = float>
+class RowParallelLinear {
+public:
+    RowParallelLinear(NTensor<T>& B, Transport& tr, ThreadPool& pool = ThreadPool::global())
+        : RowParallelLinear(local_block(B, tr.size(), 1, tr.rank(), 0), B.shape()[0], tr, pool)
+    {}
+
+    RowParallelLinear(NTensor<T> shard, size_t K, Transport& tr, ThreadPool& pool = ThreadPool::global())
+        : shard_(std::move(shard)), K_(K), tr_(tr), pool_(pool)
+    {
+        /**
+         * @brief Row-sharded weight; this rank keeps B[block_range(K, W, rank), :]
+         *
+         * @param (NTensor<T>) shard: [K_r x N] local rows of B
+         * @param (size_t) K: global input width
+         * @param (Transport) tr: job transport
+        */
+        auto [k0, k1] = block_range(K, tr.size(), tr.rank());
+        if (shard_.ndim() != 2 || shard_.shape()[0] != k1 - k0) {
+            throw std::runtime_error("RowParallelLinear: shard does not match block_range(K, W, rank)");
+        }
+    }
+
+    NTensor<T> forward(NTensor<T>& X, bool input_is_sharded = false, RowCombine combine = RowCombine::ALL_REDUCE) {
+        /**
+         * @brief Y = X * B
+         *
+         * @param (NTensor<T>) X: [M x K] replicated, or [M x K_r] when input_is_sharded
+         *     (e.g. the un-gathered output of a ColumnParallelLinear)
+         * @param (RowCombine) combine: ALL_REDUCE -> [M x N] on every rank,
+         *     REDUCE_SCATTER -> this rank's rows block_range(M, W, rank) of Y
+        */
+        auto [k0, k1] = block_range(K_, tr_.size(), tr_.rank());
+        const size_t N = shard_.shape()[1], k_loc = k1 - k0;
+
+        if (X.ndim() != 2 || X.shape()[1] != (input_is_sharded ? k_loc : K_)) {
+            throw std::runtime_error("RowParallelLinear: input width does not match the shard");
+        }
+
+        const size_t M = X.shape()[0];
+
+        // a replicated input is read in place through its leading dimension
+        const T* x = input_is_sharded ? X.data() : X.data() + k0;
+        const size_t ldx = X.shape()[1];
+
+        NTensor<T> partial({M, N}, (T)0, X.config());
+        _tensor_parallel::local_gemm(x, ldx, shard_.data(), partial.data(), M, k_loc, N, pool_);
+
+        if (combine == RowCombine::ALL_REDUCE) {
+            all_reduce(partial, tr_);
+            return partial;
+        }
+
+        const size_t W = tr_.size();
+        std::vector<size_t> counts(W);
+        for (size_t r = 0; r < W; ++r) {
+            auto [r0, r1] = block_range(M, W, r);
+            counts[r] = (r1 - r0) * N;
+        }
+
+        reduce_scatter_v(partial.data(), counts, tr_);
+
+        auto [m0, m1] = block_range(M, W, tr_.rank());
+        NTensor<T> Y({m1 - m0, N}, (T)0, X.config());
+        std::copy(partial.data() + m0 * N, partial.data() + m1 * N, Y.data());
+
+        return Y;
+    }
+
+    NTensor<T>& shard() { return shard_; }
+
+private:
+    NTensor<T> shard_;
+    size_t K_;
+    Transport& tr_;
+    ThreadPool& pool_;
+};
+
+#endif // TENSOR_PARALLEL_HPP
@@ -0,0 +1,83 @@
+#ifndef TENSOR_POOL_HPP
+#define TENSOR_POOL_HPP
+
+#include <tensor.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+template<typename T = float>
+class TensorPool {
+public:
+    struct Release {
+        TensorPool* pool;
+        void operator()(NTensor<T>* t) const { pool->release(t); }
+    };
+
+    using Handle = std::unique_ptr<NTensor<T>, Release>;
+
+    explicit TensorPool(NTensorConfig cfg, size_t max_per_shape = 16)
+        : config_(cfg), max_per_shape_(max_per_shape)
+    {
+        /**
+         * @brief Free-list of tensors keyed by shape, so hot paths (e.g. socket
+         *        receive) can fill a ready-made buffer instead of allocating
+         *
+         * @param (struct NTensorConfig) cfg: config of every tensor the pool creates
+         * @param (size_t) max_per_shape: idle tensors kept per shape, extras are freed
+        */
+    }
+
+    TensorPool(const TensorPool&) = delete;
+    TensorPool& operator=(const TensorPool&) = delete;
+
+    ~TensorPool() {
+        for (auto& [shape, free] : free_)
+            for (NTensor<T>* t : free) delete t;
+    }
+
+    Handle acquire(const std::vector<size_t>& shape) {
+        /**
+         * @brief Take a tensor of the given shape; contents are whatever the last user left
+         *
+         * @return (Handle) tensor that goes back to the pool when the handle dies
+        */
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = free_.find(shape);
+            if (it != free_.end() && !it->second.empty()) {
+                NTensor<T>* t = it->second.back();
+                it->second.pop_back();
+                return Handle(t, Release{this});
+            }
+        }
+
+        return Handle(new NTensor<T>(shape, (T)0, config_), Release{this});
+    }
+
+private:
+    NTensorConfig config_;
+    size_t max_per_shape_;
+
+    std::mutex mutex_;
+    std::map<std::vector<size_t>, std::vector<NTensor<T>*>> free_;
+
+    void release(NTensor<T>* t) {
+        std::vector<size_t> shape(t->shape(), t->shape() + t->ndim());
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::vector<NTensor<T>*>& free = free_[shape];
+            if (free.size() < max_per_shape_) {
+                free.push_back(t);
+                return;
+            }
+        }
+
+        delete t;
+    }
+};
+
+#endif // TENSOR_POOL_HPP
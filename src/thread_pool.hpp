@@ -0,0 +1,290 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <log.hpp>
+#include <cancel.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+enum class Priority : size_t {
+    CRITICAL = 0, // latency-critical requests, always dequeued first
+    NORMAL   = 1,
+    BATCH    = 2  // throughput work, e.g. the tiles of a large GEMM
+};
+
+constexpr size_t PRIORITY_CLASSES = 3;
+
+typedef struct TaskOptions {
+    Priority priority = Priority::NORMAL;
+    Clock::time_point deadline = Clock::time_point::max();
+    CancellationToken cancel = {};
+} TaskOptions;
+
+typedef struct QueueStats {
+    size_t submitted = 0;
+    size_t completed = 0;
+    size_t deadline_misses = 0;
+    double total_wait_us = 0.0;
+    double max_wait_us = 0.0;
+
+    double mean_wait_us() const {
+        return completed ? total_wait_us / (double)completed : 0.0;
+    }
+} QueueStats;
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t n_threads = 0) {
+        /**
+         * @brief Spawn worker threads that drain the per-class task queues
+         *
+         * @param (size_t) n_threads: number of workers, 0 = hardware concurrency
+        */
+        if (n_threads == 0) {
+            n_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        workers_.reserve(n_threads);
+        for (size_t i = 0; i < n_threads; ++i) {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+
+        for (std::thread& w : workers_) w.join();
+    }
+
+    template<typename F>
+    auto submit(F&& f, TaskOptions opts = {}) -> std::future<std::invoke_result_t<F>> {
+        /**
+         * @brief Queue a callable under a priority class and deadline
+         *
+         * Workers always take the highest non-empty class; within a class the
+         * earliest deadline runs first, ties broken by submission order. A
+         * task whose token is cancelled by the time it is dequeued is dropped
+         * and its future carries OperationCancelled.
+         *
+         * @param (F) f: callable with no arguments
+         * @param (TaskOptions) opts: priority class and absolute deadline
+         *
+         * @return (std::future) result of f
+        */
+        using R = std::invoke_result_t<F>;
+
+        auto task = std::make_shared<std::packaged_task<R()>>(
+            [fn = std::forward<F>(f), cancel = opts.cancel]() mutable -> R {
+                cancel.throw_if_cancelled();
+                return fn();
+            }
+        );
+        std::future<R> fut = task->get_future();
+
+        enqueue([task] { (*task)(); }, opts);
+
+        return fut;
+    }
+
+    bool run_pending_task() {
+        /**
+         * @brief Run one queued task on the calling thread, if any
+         *
+         * @return (bool) false when every queue was empty
+        */
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!pop_task(task)) return false;
+        }
+
+        run_task(task);
+        return true;
+    }
+
+    template<typename R>
+    R wait(std::future<R>& fut) {
+        /**
+         * @brief Block on a future while helping drain the queues
+         *
+         * Lets tasks running on workers wait on sub-tasks without deadlocking
+         * the pool.
+        */
+        while (fut.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!run_pending_task()) {
+                fut.wait_for(std::chrono::microseconds(50));
+            }
+        }
+
+        return fut.get();
+    }
+
+    template<typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& body, TaskOptions opts = {}) {
+        /**
+         * @brief Split [begin, end) into chunks of `grain` and run body(lo, hi) on the pool
+         *
+         * The first exception thrown by any chunk is rethrown once all chunks
+         * have finished.
+        */
+        if (end <= begin) return;
+        grain = std::max<size_t>(grain, 1);
+
+        size_t n_chunks = (end - begin + grain - 1) / grain;
+        if (n_chunks == 1) {
+            body(begin, end);
+            return;
+        }
+
+        std::vector<std::future<void>> futs;
+        futs.reserve(n_chunks);
+
+        for (size_t lo = begin; lo < end; lo += grain) {
+            size_t hi = std::min(lo + grain, end);
+            futs.push_back(submit([&body, lo, hi] { body(lo, hi); }, opts));
+        }
+
+        std::exception_ptr err;
+        for (std::future<void>& f : futs) {
+            try {
+                wait(f);
+            } catch (...) {
+                if (!err) err = std::current_exception();
+            }
+        }
+
+        if (err) std::rethrow_exception(err);
+    }
+
+    QueueStats stats(Priority p) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_[(size_t)p];
+    }
+
+    void reset_stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (QueueStats& s : stats_) s = QueueStats{};
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t n = 0;
+        for (const std::vector<Task>& q : queues_) n += q.size();
+        return n;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    static ThreadPool& global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        Clock::time_point enqueued;
+        Clock::time_point deadline;
+        size_t seq;
+        Priority priority;
+    };
+
+    // max-heap comparator: "a runs after b"
+    static bool runs_after(const Task& a, const Task& b) {
+        if (a.deadline != b.deadline) return a.deadline > b.deadline;
+        return a.seq > b.seq;
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::thread> workers_;
+    std::vector<Task> queues_[PRIORITY_CLASSES];
+    QueueStats stats_[PRIORITY_CLASSES];
+    size_t seq_ = 0;
+    bool stop_ = false;
+
+    void enqueue(std::function<void()> fn, TaskOptions opts) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            std::vector<Task>& q = queues_[(size_t)opts.priority];
+            q.push_back(Task{std::move(fn), Clock::now(), opts.deadline, seq_++, opts.priority});
+            std::push_heap(q.begin(), q.end(), runs_after);
+
+            stats_[(size_t)opts.priority].submitted++;
+        }
+        cv_.notify_one();
+    }
+
+    // caller holds mutex_
+    bool pop_task(Task& out) {
+        for (std::vector<Task>& q : queues_) {
+            if (q.empty()) continue;
+
+            std::pop_heap(q.begin(), q.end(), runs_after);
+            out = std::move(q.back());
+            q.pop_back();
+
+            return true;
+        }
+        return false;
+    }
+
+    void run_task(Task& task) {
+        Clock::time_point start = Clock::now();
+        task.fn();
+        Clock::time_point done = Clock::now();
+
+        double wait_us = std::chrono::duration<double, std::micro>(start - task.enqueued).count();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        QueueStats& s = stats_[(size_t)task.priority];
+        s.completed++;
+        s.total_wait_us += wait_us;
+        s.max_wait_us = std::max(s.max_wait_us, wait_us);
+        if (done > task.deadline) s.deadline_misses++;
+    }
+
+    void worker_loop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] {
+                    if (stop_) return true;
+                    for (const std::vector<Task>& q : queues_)
+                        if (!q.empty()) return true;
+                    return false;
+                });
+
+                if (!pop_task(task)) {
+                    if (stop_) return;
+                    continue;
+                }
+            }
+
+            run_task(task);
+        }
+    }
+};
+
+#endif // THREAD_POOL_HPP
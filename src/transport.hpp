@@ -0,0 +1,467 @@
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include <log.hpp>
+#include <socket.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Point-to-point messaging between the processes of a distributed job.
+ *
+ * Messages between a (src, dst) pair arrive in the order they were sent and
+ * carry no framing: the receiver must know how many bytes to expect. send and
+ * recv block, and each is safe to call concurrently for different peers.
+ * isend queues the message on a per-peer lane, so issuing every send of a
+ * step up front and then doing the receives cannot deadlock.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual size_t rank() const = 0;
+    virtual size_t size() const = 0;
+    virtual void send(size_t peer, const void* buf, size_t bytes) = 0;
+    virtual void recv(size_t peer, void* buf, size_t bytes) = 0;
+
+    std::future<void> isend(size_t peer, const void* buf, size_t bytes) {
+        /**
+         * @brief Send without blocking the caller; buf must stay valid until the future is ready
+         *
+         * @param (size_t) peer: destination rank
+         * @param (const void*) buf, (size_t) bytes: message
+         *
+         * @return (std::future<void>) completes once the transport has taken the bytes
+        */
+        std::promise<void> done;
+        std::future<void> fut = done.get_future();
+
+        SendLane& lane = lane_for(peer);
+        {
+            std::lock_guard<std::mutex> lock(lane.mutex);
+            lane.queue.push_back(PendingSend{buf, bytes, std::move(done)});
+        }
+        lane.cv.notify_one();
+
+        return fut;
+    }
+
+    void barrier() {
+        /**
+         * @brief Block until every rank has entered the barrier (gather to rank 0, then release)
+        */
+        char token = 0;
+        if (rank() == 0) {
+            for (size_t p = 1; p < size(); ++p) recv(p, &token, 1);
+            for (size_t p = 1; p < size(); ++p) send(p, &token, 1);
+        } else {
+            send(0, &token, 1);
+            recv(0, &token, 1);
+        }
+    }
+
+protected:
+    struct PeerLocks {
+        std::mutex send;
+        std::mutex recv;
+    };
+
+    // Derived destructors call this first: the lanes call back into send().
+    void stop_send_lanes() {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+
+        for (std::unique_ptr<SendLane>& lane : lanes_) {
+            if (!lane) continue;
+            {
+                std::lock_guard<std::mutex> l(lane->mutex);
+                lane->stop = true;
+            }
+            lane->cv.notify_one();
+            lane->worker.join();
+        }
+        lanes_.clear();
+    }
+
+private:
+    struct PendingSend {
+        const void* buf = nullptr;
+        size_t bytes = 0;
+        std::promise<void> done;
+    };
+
+    struct SendLane {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<PendingSend> queue;
+        std::thread worker;
+        bool stop = false;
+    };
+
+    std::mutex lanes_mutex_;
+    std::vector<std::unique_ptr<SendLane>> lanes_;
+
+    SendLane& lane_for(size_t peer) {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+
+        if (lanes_.size() < size()) lanes_.resize(size());
+        std::unique_ptr<SendLane>& lane = lanes_[peer];
+
+        if (!lane) {
+            lane = std::make_unique<SendLane>();
+            SendLane* l = lane.get();
+            l->worker = std::thread([this, l, peer] { drain(*l, peer); });
+        }
+
+        return *lane;
+    }
+
+    void drain(SendLane& lane, size_t peer) {
+        for (;;) {
+            PendingSend msg;
+            {
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                lane.cv.wait(lock, [&] { return lane.stop || !lane.queue.empty(); });
+                if (lane.queue.empty()) return;
+
+                msg = std::move(lane.queue.front());
+                lane.queue.pop_front();
+            }
+
+            try {
+                send(peer, msg.buf, msg.bytes);
+                msg.done.set_value();
+            } catch (...) {
+                msg.done.set_exception(std::current_exception());
+            }
+        }
+    }
+};
+
+class ShmTransport : public Transport {
+public:
+    ShmTransport(const std::string& name, size_t rank, size_t world, size_t channel_bytes = 1 << 20,
+                 std::chrono::milliseconds attach_timeout = std::chrono::seconds(30))
+        : name_(name), rank_(rank), world_(world), capacity_(channel_bytes), locks_(world)
+    {
+        /**
+         * @brief Single-host transport over one POSIX shm segment of world x world SPSC rings
+         *
+         * Every rank constructs it with the same name / world / channel size;
+         * the constructor returns once all ranks have attached. Rank 0 creates
+         * the segment fresh, replacing any left behind by a crashed job, and
+         * the other ranks only attach once it is marked ready. The segment is
+         * unlinked by the last rank to destroy its transport.
+         *
+         * @param (std::string) name: POSIX shm name shared by the job, e.g. "/iml-job-42"
+         * @param (size_t) rank, world: this process's rank and the number of ranks
+         * @param (size_t) channel_bytes: ring capacity per ordered pair of ranks
+         * @param (std::chrono::milliseconds) attach_timeout: how long ranks > 0 wait for rank 0's segment
+        */
+        if (rank >= world) throw std::runtime_error("ShmTransport: rank out of range");
+
+        channel_stride_ = (sizeof(Channel) + capacity_ + 63) / 64 * 64;
+        bytes_ = header_bytes() + world_ * world_ * channel_stride_;
+
+        if (rank_ == 0) {
+            create();
+        } else {
+            Clock::time_point give_up = Clock::now() + attach_timeout;
+            while (!try_attach()) {
+                if (Clock::now() > give_up) {
+                    throw std::runtime_error("ShmTransport: rank 0 did not create " + name_ + " in time");
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        header()->attached.fetch_add(1, std::memory_order_acq_rel);
+
+        // no rank may leave (and unlink) before every rank has mapped the segment
+        barrier();
+    }
+
+    ~ShmTransport() override {
+        stop_send_lanes();
+
+        if (header()->attached.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ::shm_unlink(name_.c_str());
+        }
+        ::munmap(base_, bytes_);
+    }
+
+    static void destroy(const std::string& name) {
+        // clean up after a job that crashed without detaching
+        ::shm_unlink(name.c_str());
+    }
+
+    size_t rank() const override { return rank_; }
+    size_t size() const override { return world_; }
+
+    void send(size_t peer, const void* buf, size_t bytes) override {
+        std::lock_guard<std::mutex> lock(locks_[peer].send);
+
+        Channel* ch = channel(rank_, peer);
+        char* ring = ring_of(ch);
+        const char* src = static_cast<const char*>(buf);
+
+        uint64_t head = ch->head.load(std::memory_order_relaxed);
+
+        while (bytes > 0) {
+            uint64_t tail = ch->tail.load(std::memory_order_acquire);
+            size_t free = capacity_ - (size_t)(head - tail);
+
+            if (free == 0) {
+                backoff();
+                continue;
+            }
+
+            size_t pos = (size_t)(head % capacity_);
+            size_t n = std::min({bytes, free, capacity_ - pos});
+
+            std::memcpy(ring + pos, src, n);
+            head += n;
+            ch->head.store(head, std::memory_order_release);
+
+            src += n;
+            bytes -= n;
+        }
+    }
+
+    void recv(size_t peer, void* buf, size_t bytes) override {
+        std::lock_guard<std::mutex> lock(locks_[peer].recv);
+
+        Channel* ch = channel(peer, rank_);
+        char* ring = ring_of(ch);
+        char* dst = static_cast<char*>(buf);
+
+        uint64_t tail = ch->tail.load(std::memory_order_relaxed);
+
+        while (bytes > 0) {
+            uint64_t head = ch->head.load(std::memory_order_acquire);
+            size_t avail = (size_t)(head - tail);
+
+            if (avail == 0) {
+                backoff();
+                continue;
+            }
+
+            size_t pos = (size_t)(tail % capacity_);
+            size_t n = std::min({bytes, avail, capacity_ - pos});
+
+            std::memcpy(dst, ring + pos, n);
+            tail += n;
+            ch->tail.store(tail, std::memory_order_release);
+
+            dst += n;
+            bytes -= n;
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Header {
+        std::atomic<uint32_t> attached;
+        std::atomic<uint32_t> ready;    // set by rank 0 once the segment is sized and zeroed
+        int32_t creator;                // rank 0's pid, tells a live job's segment from a crashed one's
+    };
+
+    // one producer (src rank) and one consumer (dst rank) per channel
+    struct Channel {
+        alignas(64) std::atomic<uint64_t> head; // bytes written
+        alignas(64) std::atomic<uint64_t> tail; // bytes read
+    };
+
+    std::string name_;
+    size_t rank_, world_, capacity_;
+    size_t channel_stride_ = 0;
+    size_t bytes_ = 0;
+    char* base_ = nullptr;
+    std::vector<PeerLocks> locks_;
+
+    static constexpr size_t header_bytes() { return 64; }
+
+    Header* header() { return reinterpret_cast<Header*>(base_); }
+
+    void create() {
+        // a segment left by a crashed job still holds its ring counters: never reuse it
+        ::shm_unlink(name_.c_str());
+
+        int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) throw _socket::os_error("shm_open " + name_);
+
+        // a new object is zero-filled, so every head / tail starts at 0
+        if (::ftruncate(fd, (off_t)bytes_) < 0) {
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            throw _socket::os_error("ftruncate " + name_);
+        }
+
+        base_ = static_cast<char*>(::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        ::close(fd);
+        if (base_ == MAP_FAILED) {
+            ::shm_unlink(name_.c_str());
+            throw _socket::os_error("mmap " + name_);
+        }
+
+        header()->creator = (int32_t)::getpid();
+        header()->ready.store(1, std::memory_order_release);
+    }
+
+    bool try_attach() {
+        /**
+         * @brief Map rank 0's segment if it is linked, sized, ready and owned by a live process
+         *
+         * @return (bool) false to retry: not created yet, still being set up, or stale
+        */
+        int fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            if (errno == ENOENT) return false;
+            throw _socket::os_error("shm_open " + name_);
+        }
+
+        // nlink drops to 0 once rank 0 has unlinked a stale segment we opened
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || st.st_nlink == 0 || (size_t)st.st_size < bytes_) {
+            ::close(fd);
+            return false;
+        }
+
+        void* p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw _socket::os_error("mmap " + name_);
+
+        const Header* h = static_cast<const Header*>(p);
+        const bool live = h->ready.load(std::memory_order_acquire) == 1 && h->creator > 0 &&
+                          (::kill(h->creator, 0) == 0 || errno == EPERM);
+        if (!live) {
+            ::munmap(p, bytes_);
+            return false;
+        }
+
+        base_ = static_cast<char*>(p);
+        return true;
+    }
+
+    Channel* channel(size_t src, size_t dst) {
+        return reinterpret_cast<Channel*>(base_ + header_bytes() + (src * world_ + dst) * channel_stride_);
+    }
+
+    static char* ring_of(Channel* ch) { return reinterpret_cast<char*>(ch) + sizeof(Channel); }
+
+    static void backoff() {
+        // peers may share cores with us, so don't hog one spinning
+        std::this_thread::yield();
+    }
+};
+
+class TcpTransport : public Transport {
+public:
+    TcpTransport(size_t rank, const std::vector<std::pair<std::string, uint16_t>>& endpoints,
+                 std::chrono::milliseconds connect_timeout = std::chrono::seconds(30))
+        : rank_(rank), world_(endpoints.size()), fds_(endpoints.size(), -1), locks_(endpoints.size())
+    {
+        /**
+         * @brief Fully connected TCP mesh; rank i listens on endpoints[i]
+         *
+         * Lower ranks are dialed, higher ranks are accepted; each connection
+         * opens with the dialer's rank so accepts can arrive in any order.
+         *
+         * @param (size_t) rank: this process's rank
+         * @param (std::vector<std::pair<std::string, uint16_t>>) endpoints: IPv4 host/port per rank
+         * @param (std::chrono::milliseconds) connect_timeout: how long to retry dialing peers
+        */
+        if (rank >= world_) throw std::runtime_error("TcpTransport: rank out of range");
+
+        int listen_fd = _socket::listen_tcp(endpoints[rank].second, endpoints[rank].first.c_str());
+
+        Clock::time_point give_up = Clock::now() + connect_timeout;
+        for (size_t peer = 0; peer < rank; ++peer) {
+            for (;;) {
+                try {
+                    fds_[peer] = _socket::connect_tcp(endpoints[peer].first.c_str(), endpoints[peer].second);
+                    break;
+                } catch (const std::runtime_error&) {
+                    if (Clock::now() > give_up) {
+                        ::close(listen_fd);
+                        throw;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                }
+            }
+
+            uint32_t me = (uint32_t)rank;
+            _socket::send_all(fds_[peer], &me, sizeof(me));
+        }
+
+        for (size_t n = rank + 1; n < world_; ++n) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                ::close(listen_fd);
+                throw _socket::os_error("accept");
+            }
+
+            uint32_t peer;
+            if (!_socket::recv_all(fd, &peer, sizeof(peer)) || peer <= rank || peer >= world_) {
+                ::close(fd);
+                ::close(listen_fd);
+                throw std::runtime_error("TcpTransport: bad handshake");
+            }
+
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fds_[peer] = fd;
+        }
+
+        ::close(listen_fd);
+    }
+
+    ~TcpTransport() override {
+        stop_send_lanes();
+        for (int fd : fds_) if (fd >= 0) ::close(fd);
+    }
+
+    size_t rank() const override { return rank_; }
+    size_t size() const override { return world_; }
+
+    void send(size_t peer, const void* buf, size_t bytes) override {
+        std::lock_guard<std::mutex> lock(locks_[peer].send);
+        if (!_socket::send_all(fds_[peer], buf, bytes)) {
+            throw std::runtime_error("TcpTransport: lost connection to rank " + std::to_string(peer));
+        }
+    }
+
+    void recv(size_t peer, void* buf, size_t bytes) override {
+        std::lock_guard<std::mutex> lock(locks_[peer].recv);
+        if (!_socket::recv_all(fds_[peer], buf, bytes)) {
+            throw std::runtime_error("TcpTransport: lost connection to rank " + std::to_string(peer));
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    size_t rank_, world_;
+    std::vector<int> fds_;
+    std::vector<PeerLocks> locks_;
+};
+
+#endif // TRANSPORT_HPP
@@ -0,0 +1,40 @@
+#ifndef TEST_RANKS_HPP
+#define TEST_RANKS_HPP
+
+#include <transport.hpp>
+
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+/*
+ * Runs fn(transport) once per rank, each rank a thread with its own
+ * ShmTransport over a job segment unique to this process. The first
+ * exception thrown by any rank is rethrown after all ranks have finished.
+ */
+template<typename F>
+void run_ranks(size_t world, const std::string& job, F&& fn) {
+    const std::string name = "/iml-test-" + std::to_string(::getpid()) + "-" + job;
+
+    std::vector<std::exception_ptr> errors(world);
+    std::vector<std::thread> ranks;
+    for (size_t r = 0; r < world; ++r) {
+        ranks.emplace_back([&, r] {
+            try {
+                ShmTransport tr(name, r, world, 1 << 16);
+                fn(tr);
+            } catch (...) {
+                errors[r] = std::current_exception();
+            }
+        });
+    }
+
+    for (std::thread& t : ranks) t.join();
+    for (std::exception_ptr& e : errors)
+        if (e) std::rethrow_exception(e);
+}
+
+#endif // TEST_RANKS_HPP
@@ -0,0 +1,87 @@
+#ifndef TEST_HPP
+#define TEST_HPP
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <tensor.hpp>
+
+/*
+ * Minimal checks for the tests/ executables. Each test is a plain program:
+ * the CHECK macros report the failing expression and keep going, and main()
+ * returns test_result() so CTest sees a non-zero exit on any failure.
+ */
+namespace _test {
+
+inline int failures = 0;
+
+inline void fail(const char* file, int line, const char* what) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    ++failures;
+}
+
+} // namespace _test
+
+#define CHECK(cond) \
+    do { if (!(cond)) _test::fail(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_NEAR(a, b, tol) \
+    do { \
+        const double _a = (double)(a), _b = (double)(b); \
+        if (!(std::fabs(_a - _b) <= (double)(tol))) { \
+            std::fprintf(stderr, "    %g vs %g\n", _a, _b); \
+            _test::fail(__FILE__, __LINE__, #a " ~= " #b); \
+        } \
+    } while (0)
+
+#define CHECK_THROWS(expr, E) \
+    do { \
+        bool _thrown = false; \
+        try { (void)(expr); } catch (const E&) { _thrown = true; } \
+        if (!_thrown) _test::fail(__FILE__, __LINE__, #expr " throws " #E); \
+    } while (0)
+
+inline std::vector<float> random_floats(size_t n, unsigned seed, float lo = -1.0f, float hi = 1.0f) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(lo, hi);
+
+    std::vector<float> v(n);
+    for (float& x : v) x = dist(rng);
+    return v;
+}
+
+// tensor of the given shape filled from random_floats
+template<typename T = float>
+NTensor<T> random_tensor(std::vector<size_t> shape, unsigned seed, float lo = -1.0f, float hi = 1.0f) {
+    NTensor<T> t(shape, (T)0.0f, NTensorConfig{48});
+    std::vector<float> v = random_floats(t.size(), seed, lo, hi);
+    for (size_t i = 0; i < v.size(); ++i) t.data()[i] = (T)v[i];
+    return t;
+}
+
+// row-major C[M x N] = A[M x K] * B[K x N] in double
+inline std::vector<double> reference_matmul(const float* A, const float* B, size_t M, size_t K, size_t N) {
+    std::vector<double> C(M * N, 0.0);
+    for (size_t i = 0; i < M; ++i)
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < N; ++j) C[i * N + j] += (double)A[i * K + k] * (double)B[k * N + j];
+    return C;
+}
+
+// per-process scratch file name, so parallel ctest runs don't collide
+inline std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("intel-ml-" + std::to_string(::getpid()) + "-" + name)).string();
+}
+
+inline int test_result() {
+    if (_test::failures) std::fprintf(stderr, "%d check(s) failed\n", _test::failures);
+    return _test::failures ? 1 : 0;
+}
+
+#endif // TEST_HPP
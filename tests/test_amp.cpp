@@ -0,0 +1,82 @@
+#include <amp.hpp>
+
+#include <test.hpp>
+
+#include <limits>
+
+static void test_scaler() {
+    LossScaleConfig cfg;
+    cfg.growth_interval = 3;
+    DynamicLossScaler scaler(cfg);
+    CHECK_NEAR(scaler.scale(), 32768.0, 0.0);
+
+    CHECK(!scaler.update(false));
+    CHECK_NEAR(scaler.scale(), 16384.0, 0.0);
+    CHECK(scaler.skipped() == 1);
+
+    for (int i = 0; i < 3; ++i) CHECK(scaler.update(true));
+    CHECK_NEAR(scaler.scale(), 32768.0, 0.0);
+
+    cfg.init_scale = 1.0;
+    DynamicLossScaler floor(cfg);
+    floor.update(false);
+    CHECK_NEAR(floor.scale(), cfg.min_scale, 0.0);
+}
+
+static void test_grad_stats() {
+    std::vector<float> a = {3.0f, 4.0f}, b = {0.0f, 12.0f};
+    GradStats s = grad_stats<float>({a.data(), nullptr, b.data()}, {2, 5, 2}, 0.5, nullptr);
+    CHECK(s.finite);
+    CHECK_NEAR(s.norm(), 6.5, 1e-12);
+
+    b[0] = std::numeric_limits<float>::infinity();
+    CHECK(!grad_stats<float>({a.data(), b.data()}, {2, 2}, 1.0, nullptr).finite);
+}
+
+template<typename P>
+static void test_first_step() {
+    // the default scale must be representable as the backward seed, so step one is applied
+    NTensor<P> X({4, 8}, P(0.25f), NTensorConfig{48}), W({8, 2}, P(0.5f), NTensorConfig{48});
+
+    SGDConfig cfg;
+    cfg.lr = 0.1; cfg.momentum = 0.0;
+    SGD<P, float> opt(cfg, nullptr);
+    opt.add_param(W);
+    DynamicLossScaler scaler;
+
+    Tape<P> tape(nullptr);
+    Var<P> loss = mean(matmul(tape.input(X), tape.param(W)));
+    tape.backward(loss, (P)scaler.scale());
+
+    CHECK(amp_step(opt, tape, scaler, 0.0, nullptr));
+    CHECK(scaler.skipped() == 0);
+
+    // d mean(X * W) / dW = column sums of X / (4 * 2) = 0.125
+    CHECK_NEAR(opt.master(0)[0], 0.5 - 0.1 * 0.125, 1e-4);
+    CHECK_NEAR((float)W.data()[0], 0.5 - 0.1 * 0.125, 1e-2);
+}
+
+static void test_overflow_skips() {
+    NTensor<fp16> X({1, 1}, fp16(60000.0f), NTensorConfig{48}), W({1, 1}, fp16(1.0f), NTensorConfig{48});
+
+    SGD<fp16, float> opt(SGDConfig{}, nullptr);
+    opt.add_param(W);
+    DynamicLossScaler scaler;
+
+    Tape<fp16> tape(nullptr);
+    Var<fp16> loss = sum(matmul(tape.input(X), tape.param(W)));
+    tape.backward(loss, (fp16)scaler.scale());
+
+    CHECK(!amp_step(opt, tape, scaler, 0.0, nullptr));
+    CHECK(scaler.skipped() == 1 && opt.steps() == 0);
+    CHECK_NEAR((float)W.data()[0], 1.0f, 0.0);
+}
+
+int main() {
+    test_scaler();
+    test_grad_stats();
+    test_first_step<fp16>();
+    test_first_step<bf16>();
+    test_overflow_skips();
+    return test_result();
+}
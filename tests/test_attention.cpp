@@ -0,0 +1,103 @@
+#include <attention.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+// softmax(Q K^T / sqrt(D)) V in double, one (batch, head) at a time
+template<typename T>
+static std::vector<double> reference_attention(NTensor<T>& Q, NTensor<T>& K, NTensor<T>& V, bool causal) {
+    const size_t B = Q.shape()[0], H = Q.shape()[1], Nq = Q.shape()[2], D = Q.shape()[3];
+    const size_t Hkv = K.shape()[1], Nk = K.shape()[2], Dv = V.shape()[3];
+    std::vector<double> O(B * H * Nq * Dv, 0.0), s(Nk);
+
+    for (size_t bh = 0; bh < B * H; ++bh) {
+        const size_t kvh = (bh / H) * Hkv + (bh % H) / (H / Hkv);
+        for (size_t i = 0; i < Nq; ++i) {
+            const size_t last = causal ? Nk - Nq + i : Nk - 1;
+            double mx = -1e300, l = 0.0;
+            for (size_t j = 0; j <= last; ++j) {
+                s[j] = 0.0;
+                for (size_t d = 0; d < D; ++d) {
+                    s[j] += (double)(float)Q.data()[(bh * Nq + i) * D + d] * (double)(float)K.data()[(kvh * Nk + j) * D + d];
+                }
+                s[j] /= std::sqrt((double)D);
+                mx = std::max(mx, s[j]);
+            }
+            for (size_t j = 0; j <= last; ++j) l += (s[j] = std::exp(s[j] - mx));
+            for (size_t j = 0; j <= last; ++j) {
+                for (size_t d = 0; d < Dv; ++d) {
+                    O[(bh * Nq + i) * Dv + d] += s[j] / l * (double)(float)V.data()[(kvh * Nk + j) * Dv + d];
+                }
+            }
+        }
+    }
+    return O;
+}
+
+template<typename T>
+static void check_attention(size_t B, size_t H, size_t Hkv, size_t Nq, size_t Nk, size_t D, size_t Dv,
+                            bool causal, double tol) {
+    NTensor<T> Q = random_tensor<T>({B, H, Nq, D}, 1, -2.0f, 2.0f);
+    NTensor<T> K = random_tensor<T>({B, Hkv, Nk, D}, 2, -2.0f, 2.0f);
+    NTensor<T> V = random_tensor<T>({B, Hkv, Nk, Dv}, 3, -2.0f, 2.0f);
+    std::vector<double> ref = reference_attention(Q, K, V, causal);
+
+    ThreadPool pool(3);
+    AttentionParams p;
+    p.causal = causal;
+    NTensor<T> O = attention(Q, K, V, p, &pool);
+    CHECK(O.shape()[2] == Nq && O.shape()[3] == Dv);
+
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::fabs((double)(float)O.data()[i] - ref[i]));
+    CHECK_NEAR(err, 0.0, tol);
+}
+
+static void test_tile_chunks() {
+    // K/V fed as ragged runs (a paged cache) give the same block as one contiguous pass
+    const size_t Nk = 150, D = 16;
+    std::vector<float> q = random_floats(5 * D, 4), k = random_floats(Nk * D, 5), v = random_floats(Nk * D, 6);
+    std::vector<float> whole(5 * D), paged(5 * D);
+
+    AttentionTile<float> t(D, D);
+    t.begin(q.data(), D, 5, 0.25f, true, Nk - 5);
+    t.attend(k.data(), D, v.data(), D, Nk, 0);
+    t.store(whole.data(), D);
+
+    t.begin(q.data(), D, 5, 0.25f, true, Nk - 5);
+    for (size_t j0 = 0; j0 < Nk; j0 += 37) {
+        const size_t n = std::min<size_t>(37, Nk - j0);
+        t.attend(k.data() + j0 * D, D, v.data() + j0 * D, D, n, j0);
+    }
+    t.store(paged.data(), D);
+
+    double err = 0.0;
+    for (size_t i = 0; i < whole.size(); ++i) err = std::max(err, (double)std::fabs(whole[i] - paged[i]));
+    CHECK_NEAR(err, 0.0, 1e-5);
+}
+
+static void test_errors() {
+    NTensor<float> Q({1, 3, 4, 8}, 0.0f, NTensorConfig{48}), K({1, 2, 4, 8}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(attention(Q, K, K), std::runtime_error);
+
+    NTensor<float> K1({1, 1, 2, 8}, 0.0f, NTensorConfig{48});
+    AttentionParams causal;
+    causal.causal = true;
+    CHECK_THROWS(attention(Q, K1, K1, causal), std::runtime_error);
+
+    NTensor<float> Kd({1, 1, 4, 7}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(attention(Q, Kd, Kd), std::runtime_error);
+}
+
+int main() {
+    // query / key counts straddle ATTN_BLOCK_Q and ATTN_BLOCK_KV, head dims straddle a panel
+    check_attention<float>(2, 2, 2, ATTN_BLOCK_Q + 3, 2 * ATTN_BLOCK_KV + 5, 20, 17, false, 1e-5);
+    check_attention<float>(1, 4, 2, 10, 3 * ATTN_BLOCK_KV - 1, 16, 16, true, 1e-5);
+    check_attention<float>(1, 2, 1, 70, 70, 8, 8, true, 1e-5);
+    check_attention<float>(1, 2, 2, 5, 30, 24, 33, false, 1e-5);     // per-thread tiles grown again
+    check_attention<bf16>(1, 2, 2, 9, 40, 16, 16, false, 5e-2);
+    test_tile_chunks();
+    test_errors();
+    return test_result();
+}
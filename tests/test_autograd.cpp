@@ -0,0 +1,99 @@
+#include <autograd.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+struct Model {
+    NTensor<float> X = random_tensor({6, 5}, 1);
+    NTensor<float> W1 = random_tensor({5, 4}, 2);
+    NTensor<float> b1 = random_tensor({4}, 3);
+    NTensor<float> W2 = random_tensor({4, 3}, 4);
+    size_t labels[6] = {0, 2, 1, 1, 0, 2};
+
+    Var<float> loss(Tape<float>& tape, bool checkpointed) {
+        Var<float> x = tape.input(X);
+        Var<float> h = matmul(x, tape.param(W1)) + tape.param(b1);
+
+        auto head = [this](Tape<float>& t, Var<float> in) { return matmul(in - in * 0.5f, t.param(W2)); };
+        Var<float> logits = checkpointed ? tape.checkpoint(head, h) : head(tape, h);
+        return softmax_cross_entropy(logits, labels);
+    }
+
+    float value() {
+        Tape<float> tape(nullptr);
+        return loss(tape, false).item();
+    }
+};
+
+static void check_grad(Model& m, NTensor<float>& t, const float* grad) {
+    // central differences against the recorded gradient
+    const float eps = 1e-2f;
+    double err = 0.0;
+    for (size_t i = 0; i < t.size(); ++i) {
+        const float w = t.data()[i];
+        t.data()[i] = w + eps; const float up = m.value();
+        t.data()[i] = w - eps; const float down = m.value();
+        t.data()[i] = w;
+        err = std::max(err, std::fabs((up - down) / (2.0 * eps) - grad[i]));
+    }
+    CHECK_NEAR(err, 0.0, 2e-3);
+}
+
+static void test_gradients() {
+    Model m;
+    for (bool checkpointed : {false, true}) {
+        Tape<float> tape;
+        Var<float> loss = m.loss(tape, checkpointed);
+        CHECK_NEAR(loss.item(), m.value(), 1e-6);
+
+        tape.backward(loss);
+        CHECK(tape.grad(m.W1) && tape.grad(m.b1) && tape.grad(m.W2));
+        CHECK(tape.grad(m.X) == nullptr);
+
+        check_grad(m, m.W1, tape.grad(m.W1));
+        check_grad(m, m.b1, tape.grad(m.b1));
+        check_grad(m, m.W2, tape.grad(m.W2));
+
+        const size_t nodes = tape.nodes();
+        tape.reset();
+        CHECK(tape.nodes() == 0 && nodes > 0);
+    }
+}
+
+static void test_shared_buffer() {
+    // a param that is also fed in as data: grad() must still find the param leaf
+    NTensor<float> W = random_tensor({3, 3}, 5);
+
+    Tape<float> tape(nullptr);
+    Var<float> w = tape.param(W);
+    Var<float> loss = sum(matmul(tape.input(W), w));
+    CHECK(tape.param(W).node() == w.node());
+    tape.backward(loss);
+
+    // d/dW sum(A * W) with A held constant = column sums of A, broadcast over columns
+    float* g = tape.grad(W);
+    CHECK(g == w.grad());
+    for (size_t k = 0; k < 3; ++k) {
+        const float colsum = W.data()[0 * 3 + k] + W.data()[1 * 3 + k] + W.data()[2 * 3 + k];
+        for (size_t j = 0; j < 3; ++j) CHECK_NEAR(g[k * 3 + j], colsum, 1e-5);
+    }
+}
+
+static void test_errors() {
+    Tape<float> tape(nullptr);
+    NTensor<float> A({2, 3}, 1.0f, NTensorConfig{48}), B({2, 3}, 1.0f, NTensorConfig{48});
+    NTensor<float> C({2, 2, 2}, 1.0f, NTensorConfig{48});
+
+    Var<float> a = tape.param(A), b = tape.param(B);
+    CHECK_THROWS(matmul(a, b), std::runtime_error);
+    CHECK_THROWS(tape.param(C), std::runtime_error);
+    CHECK_THROWS(tape.backward(a), std::runtime_error);
+}
+
+int main() {
+    test_gradients();
+    test_shared_buffer();
+    test_errors();
+    return test_result();
+}
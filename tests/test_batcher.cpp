@@ -0,0 +1,56 @@
+#include <batcher.hpp>
+
+#include <test.hpp>
+
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+static void test_coalesced() {
+    ThreadPool pool(2);
+    BatcherConfig cfg;
+    cfg.window_us = 20000;              // wide enough that all requests land in one batch
+    MatmulBatcher<float> batcher(cfg, pool);
+
+    const size_t K = 8, N = 5;
+    NTensor<float> B({K, N}, 0.0f, NTensorConfig{48});
+    std::vector<float> b = random_floats(K * N, 1);
+    std::copy(b.begin(), b.end(), B.data());
+
+    std::vector<NTensor<float>> As;
+    for (size_t r = 1; r <= 4; ++r) {
+        As.emplace_back(std::vector<size_t>{r, K}, 0.0f, NTensorConfig{48});
+        std::vector<float> a = random_floats(r * K, (unsigned)(10 + r));
+        std::copy(a.begin(), a.end(), As.back().data());
+    }
+
+    std::vector<std::future<NTensor<float>>> futs;
+    for (NTensor<float>& A : As) futs.push_back(batcher.submit(A, B));
+
+    for (size_t i = 0; i < As.size(); ++i) {
+        NTensor<float> C = futs[i].get();
+        std::vector<double> ref = reference_matmul(As[i].data(), B.data(), As[i].shape()[0], K, N);
+
+        CHECK(C.shape()[0] == As[i].shape()[0] && C.shape()[1] == N);
+        double err = 0.0;
+        for (size_t j = 0; j < ref.size(); ++j) err = std::max(err, std::fabs(C.data()[j] - ref[j]));
+        CHECK_NEAR(err, 0.0, 1e-5);
+    }
+
+    BatcherStats s = batcher.stats();
+    CHECK(s.requests == 4);
+    CHECK(s.rows == 10);
+    CHECK(s.batches >= 1 && s.batches <= 4);
+}
+
+static void test_shape_mismatch() {
+    MatmulBatcher<float> batcher;
+    NTensor<float> A({2, 3}, 1.0f, NTensorConfig{48}), B({4, 2}, 1.0f, NTensorConfig{48});
+    CHECK_THROWS(batcher.submit(A, B), std::runtime_error);
+}
+
+int main() {
+    test_coalesced();
+    test_shape_mismatch();
+    return test_result();
+}
@@ -0,0 +1,70 @@
+#include <cancel.hpp>
+#include <gemm.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <test.hpp>
+
+#include <chrono>
+#include <thread>
+
+static void test_token() {
+    CancellationToken none;
+    CHECK(!none.cancelled());
+    none.cancel();                      // no shared state: stays live
+    CHECK(!none.cancelled());
+
+    CancellationToken tok = CancellationToken::make();
+    CancellationToken copy = tok;
+    copy.cancel();
+    CHECK(tok.cancelled());
+    CHECK(!tok.expired());
+    CHECK_THROWS(tok.throw_if_cancelled(), OperationCancelled);
+
+    CancellationToken budget = CancellationToken::with_budget(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK(budget.cancelled());
+    CHECK(budget.expired());
+}
+
+static void test_cancelled_ops() {
+    ThreadPool pool(2);
+    NTensor<float> A({64, 64}, 1.0f, NTensorConfig{48}), B({64, 64}, 1.0f, NTensorConfig{48});
+
+    CancellationToken tok = CancellationToken::make();
+    tok.cancel();
+    CHECK_THROWS(tiled_matmul(A, B, pool, {.cancel = tok}), OperationCancelled);
+    CHECK_THROWS(A.matmul(B, tok), OperationCancelled);
+    CHECK_THROWS(A.static_matmul(B, tok), OperationCancelled);
+}
+
+static void test_strassen_split() {
+    // strassen_split takes its tensor by reference: the quadrant views must point into live data
+    const size_t N = 16;
+    NTensor<int> A({N, N}, 0, NTensorConfig{8}), B({N, N}, 0, NTensorConfig{8});
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            A.index({i, j}) = (int)(i + 2 * j) % 7 - 3;
+            B.index({i, j}) = (int)(3 * i + j) % 5 - 2;
+        }
+    }
+
+    auto [a, b, c, d] = A.strassen_split(A);
+    CHECK(a.shape_[0] == N / 2 && a.shape_[1] == N / 2);
+    CHECK(d.data_ == A.data() + (N / 2) * N + N / 2);
+    CHECK(d.stride_[0] == N);
+
+    NTensor<int> fast = A.matmul(B);            // above the threshold: Strassen
+    NTensor<int> slow = A.static_matmul(B);
+
+    bool same = true;
+    for (size_t i = 0; i < N * N; ++i) same = same && fast.data()[i] == slow.data()[i];
+    CHECK(same);
+}
+
+int main() {
+    test_token();
+    test_cancelled_ops();
+    test_strassen_split();
+    return test_result();
+}
@@ -0,0 +1,71 @@
+#include <checkpoint.hpp>
+
+#include <test.hpp>
+
+static void test_plan() {
+    std::vector<LayerCost> costs(8);
+    for (size_t i = 0; i < costs.size(); ++i) {
+        costs[i].bytes = 1000;
+        costs[i].out_bytes = 100;
+        costs[i].seconds = 1e-3 * (double)(i + 1);
+    }
+
+    using Seq = CheckpointedSequence<float>;
+    CheckpointPlan all = Seq::plan(costs, 1 << 20);
+    CHECK(all.fits && all.recomputed == 0);
+    CHECK(all.full_bytes == 16000 && all.peak_bytes == all.full_bytes);
+
+    CheckpointPlan tight = Seq::plan(costs, 8000);
+    CHECK(tight.fits && tight.peak_bytes <= 8000 && tight.recomputed > 0);
+    CHECK(tight.full_bytes == 16000);
+
+    // the last layer is the most expensive per byte, so it is the first one kept
+    CHECK(tight.segment.back() == -1);
+
+    CheckpointPlan none = Seq::plan(costs, 100);
+    CHECK(!none.fits && none.peak_bytes > 100);
+}
+
+static void test_forward() {
+    const size_t B = 4, D = 8, L = 5;
+    std::vector<NTensor<float>> W;
+    for (size_t i = 0; i < L; ++i) {
+        W.emplace_back(std::vector<size_t>{D, D}, 0.0f, NTensorConfig{48});
+        std::vector<float> v = random_floats(D * D, 10 + i, -0.5f, 0.5f);
+        std::copy(v.begin(), v.end(), W.back().data());
+    }
+    std::vector<float> X = random_floats(B * D, 1);
+
+    CheckpointedSequence<float> seq;
+    for (size_t i = 0; i < L; ++i) {
+        seq.add([&W, i](Tape<float>& t, Var<float> v) { return matmul(v, t.param(W[i])) - v * 0.25f; });
+    }
+    CHECK(seq.size() == L);
+
+    // reference gradients with everything kept, then with the tightest plan
+    std::vector<std::vector<float>> ref;
+    for (size_t budget : {(size_t)1 << 30, (size_t)1}) {
+        Tape<float> tape(nullptr);
+        Var<float> loss = sum(seq.forward(tape, tape.input(X.data(), B, D), budget));
+        tape.backward(loss);
+
+        if (ref.empty()) {
+            CHECK(seq.current_plan().recomputed == 0);
+            for (size_t i = 0; i < L; ++i) ref.emplace_back(tape.grad(W[i]), tape.grad(W[i]) + D * D);
+            continue;
+        }
+
+        CHECK(seq.current_plan().recomputed > 0);
+        double err = 0.0;
+        for (size_t i = 0; i < L; ++i) {
+            for (size_t j = 0; j < D * D; ++j) err = std::max(err, (double)std::fabs(tape.grad(W[i])[j] - ref[i][j]));
+        }
+        CHECK_NEAR(err, 0.0, 1e-5);
+    }
+}
+
+int main() {
+    test_plan();
+    test_forward();
+    return test_result();
+}
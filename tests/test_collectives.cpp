@@ -0,0 +1,99 @@
+#include <collectives.hpp>
+
+#include <ranks.hpp>
+#include <test.hpp>
+
+#include <vector>
+
+// rank r contributes r * 1000 + i at position i
+static double value(size_t r, size_t i) { return (double)r * 1000.0 + (double)i; }
+
+static void test_all_reduce(size_t W, AllReduceAlgo algo) {
+    const size_t n = 103;
+
+    for (ReduceOp op : {ReduceOp::SUM, ReduceOp::AVG, ReduceOp::MAX, ReduceOp::MIN}) {
+        run_ranks(W, "all-reduce", [&](Transport& tr) {
+            std::vector<double> buf(n);
+            for (size_t i = 0; i < n; ++i) buf[i] = value(tr.rank(), i);
+
+            CollectiveOptions opts;
+            opts.op = op;
+            opts.algo = algo;
+            opts.chunk = 7;                     // many pipelined chunks, uneven tail
+            all_reduce(buf.data(), n, tr, opts);
+
+            bool ok = true;
+            for (size_t i = 0; i < n; ++i) {
+                double sum = 0.0;
+                for (size_t r = 0; r < W; ++r) sum += value(r, i);
+
+                double want = op == ReduceOp::SUM ? sum
+                            : op == ReduceOp::AVG ? sum / (double)W
+                            : op == ReduceOp::MAX ? value(W - 1, i) : value(0, i);
+                ok = ok && std::fabs(buf[i] - want) < 1e-9;
+            }
+            CHECK(ok);
+        });
+    }
+}
+
+static void test_scatter_gather_broadcast(size_t W) {
+    const size_t n = 50;
+
+    run_ranks(W, "scatter-gather", [&](Transport& tr) {
+        const size_t r = tr.rank();
+        std::vector<double> buf(n);
+        for (size_t i = 0; i < n; ++i) buf[i] = value(r, i);
+
+        CollectiveOptions opts;
+        opts.chunk = 4;
+        reduce_scatter(buf.data(), n, tr, opts);
+
+        auto [lo, hi] = block_range(n, W, r);
+        bool ok = true;
+        for (size_t i = lo; i < hi; ++i) {
+            double sum = 0.0;
+            for (size_t q = 0; q < W; ++q) sum += value(q, i);
+            ok = ok && buf[i] == sum;
+        }
+        CHECK(ok);
+
+        // every rank fills only its own block, all_gather completes the rest
+        std::vector<double> all(n, -1.0);
+        for (size_t i = lo; i < hi; ++i) all[i] = (double)i;
+        all_gather(all.data(), n, tr, opts);
+        ok = true;
+        for (size_t i = 0; i < n; ++i) ok = ok && all[i] == (double)i;
+        CHECK(ok);
+
+        std::vector<double> b(n, r == W - 1 ? 42.0 : 0.0);
+        broadcast(b.data(), n, W - 1, tr, opts);
+        CHECK(b.front() == 42.0 && b.back() == 42.0);
+    });
+}
+
+static void test_stream(size_t W) {
+    run_ranks(W, "stream", [&](Transport& tr) {
+        CollectiveStream stream(tr);
+        std::vector<float> a(33, 1.0f), b(17, (float)tr.rank());
+
+        std::future<void> fa = stream.all_reduce(a.data(), a.size());
+        std::future<void> fb = stream.broadcast(b.data(), b.size(), 0);
+        fa.get();
+        fb.get();
+        stream.synchronize();
+
+        CHECK(a[32] == (float)W);
+        CHECK(b[16] == 0.0f);
+    });
+}
+
+int main() {
+    for (size_t W : {1, 2, 3, 4}) {
+        test_all_reduce(W, AllReduceAlgo::RING);
+        test_all_reduce(W, AllReduceAlgo::TREE);
+        test_scatter_gather_broadcast(W);
+        test_stream(W);
+    }
+    return test_result();
+}
@@ -0,0 +1,107 @@
+#include <conv.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+// direct NCHW convolution in double, bias and ReLU applied
+static std::vector<double> reference_conv(const float* X, const float* W, const float* bias,
+                                          const ConvShape& s, const Conv2dParams& p, bool relu) {
+    const size_t cg = s.C / p.groups, kg = s.K / p.groups;
+    std::vector<double> Y(s.N * s.K * s.OH * s.OW, 0.0);
+
+    for (size_t n = 0; n < s.N; ++n)
+    for (size_t k = 0; k < s.K; ++k)
+    for (size_t oh = 0; oh < s.OH; ++oh)
+    for (size_t ow = 0; ow < s.OW; ++ow) {
+        double acc = bias ? bias[k] : 0.0;
+        for (size_t c = 0; c < cg; ++c)
+        for (size_t r = 0; r < s.R; ++r)
+        for (size_t q = 0; q < s.S; ++q) {
+            const long h = (long)(oh * p.stride_h + r * p.dilation_h) - (long)p.pad_h;
+            const long w = (long)(ow * p.stride_w + q * p.dilation_w) - (long)p.pad_w;
+            if (h < 0 || w < 0 || h >= (long)s.H || w >= (long)s.W) continue;
+
+            const size_t ch = (k / kg) * cg + c;
+            acc += (double)X[((n * s.C + ch) * s.H + h) * s.W + w] * W[((k * cg + c) * s.R + r) * s.S + q];
+        }
+        Y[((n * s.K + k) * s.OH + oh) * s.OW + ow] = relu ? std::max(acc, 0.0) : acc;
+    }
+    return Y;
+}
+
+static void check_conv(size_t N, size_t C, size_t H, size_t W, size_t K, size_t R, size_t S,
+                       const Conv2dParams& p, std::vector<ConvAlgo> algos, double tol) {
+    ThreadPool pool(2);
+    NTensor<float> X = random_tensor({N, C, H, W}, 1), F = random_tensor({K, C / p.groups, R, S}, 2);
+    std::vector<float> bias = random_floats(K, 3);
+
+    ConvShape s = ConvShape::of(N, C, H, W, K, R, S, p);
+    std::vector<double> ref = reference_conv(X.data(), F.data(), bias.data(), s, p, true);
+
+    for (ConvAlgo algo : algos) {
+        NTensor<float> Y = conv2d(X, F, bias.data(), p, algo, Activation::RELU, &pool);
+        CHECK(Y.shape()[0] == N && Y.shape()[1] == K && Y.shape()[2] == s.OH && Y.shape()[3] == s.OW);
+
+        double err = 0.0;
+        for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::fabs(Y.data()[i] - ref[i]));
+        if (err > tol) std::fprintf(stderr, "    %s\n", conv_algo_name(algo));
+        CHECK_NEAR(err, 0.0, tol);
+    }
+}
+
+static void test_algorithms() {
+    Conv2dParams same;
+    same.pad_h = same.pad_w = 1;
+    check_conv(2, 16, 11, 13, 16, 3, 3, same,
+               {ConvAlgo::AUTO, ConvAlgo::IMPLICIT_GEMM, ConvAlgo::WINOGRAD_2x3, ConvAlgo::WINOGRAD_4x3}, 1e-3);
+
+    Conv2dParams strided;
+    strided.stride_h = 2; strided.stride_w = 3;
+    strided.pad_h = 2; strided.pad_w = 1;
+    strided.dilation_h = 2;
+    check_conv(1, 5, 17, 14, 7, 3, 2, strided, {ConvAlgo::AUTO}, 1e-4);
+
+    Conv2dParams grouped;
+    grouped.groups = 2;
+    grouped.pad_h = grouped.pad_w = 1;
+    check_conv(2, 6, 9, 9, 4, 3, 3, grouped, {ConvAlgo::IMPLICIT_GEMM}, 1e-4);
+
+    // depthwise, with and without a channel multiplier
+    Conv2dParams dw;
+    dw.groups = 8;
+    dw.pad_h = dw.pad_w = 1;
+    check_conv(2, 8, 10, 12, 8, 3, 3, dw, {ConvAlgo::AUTO, ConvAlgo::IMPLICIT_GEMM}, 1e-4);
+    check_conv(1, 8, 7, 7, 16, 3, 3, dw, {ConvAlgo::DEPTHWISE}, 1e-4);
+}
+
+static void test_choice() {
+    Conv2dParams p;
+    p.pad_h = p.pad_w = 1;
+    CHECK(choose_conv_algo(ConvShape::of(1, 64, 32, 32, 64, 3, 3, p), p) == ConvAlgo::WINOGRAD_4x3);
+    CHECK(choose_conv_algo(ConvShape::of(1, 64, 4, 4, 64, 3, 3, p), p) == ConvAlgo::WINOGRAD_2x3);
+    CHECK(choose_conv_algo(ConvShape::of(1, 3, 32, 32, 64, 3, 3, p), p) == ConvAlgo::IMPLICIT_GEMM);
+
+    p.groups = 64;
+    CHECK(choose_conv_algo(ConvShape::of(1, 64, 32, 32, 64, 3, 3, p), p) == ConvAlgo::DEPTHWISE);
+}
+
+static void test_errors() {
+    NTensor<float> X({1, 4, 5, 5}, 1.0f, NTensorConfig{48}), F({2, 3, 3, 3}, 1.0f, NTensorConfig{48});
+    CHECK_THROWS(conv2d(X, F), std::runtime_error);
+
+    NTensor<float> big({2, 4, 7, 7}, 1.0f, NTensorConfig{48});
+    CHECK_THROWS(conv2d(X, big), std::runtime_error);
+
+    Conv2dParams strided;
+    strided.stride_h = 2;
+    NTensor<float> F3({2, 4, 3, 3}, 1.0f, NTensorConfig{48});
+    CHECK_THROWS(conv2d<float>(X, F3, nullptr, strided, ConvAlgo::WINOGRAD_2x3), std::runtime_error);
+}
+
+int main() {
+    test_algorithms();
+    test_choice();
+    test_errors();
+    return test_result();
+}
@@ -0,0 +1,94 @@
+#include <gemm.hpp>
+#include <half.hpp>
+#include <nn/dense.hpp>
+
+#include <test.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static void test_gemm_packed() {
+    ThreadPool pool(2);
+
+    for (bool trans_b : {false, true}) {
+        // ragged against the micro-kernel rows and the panel width
+        const size_t M = 31, K = 45, N = 37;
+        std::vector<float> A = random_floats(M * K, 1), B = random_floats(K * N, 2), bias = random_floats(N, 3);
+
+        std::vector<float> b(K * N);
+        for (size_t k = 0; k < K; ++k)
+            for (size_t j = 0; j < N; ++j) b[k * N + j] = trans_b ? B[j * K + k] : B[k * N + j];
+        std::vector<double> ref = reference_matmul(A.data(), b.data(), M, K, N);
+
+        PackedB<float> Bp = PackedB<float>::pack(B.data(), trans_b ? K : N, K, N, trans_b);
+        CHECK(Bp.panels() == 3);
+
+        for (ThreadPool* p : {(ThreadPool*)nullptr, &pool}) {
+            std::vector<float> C(M * N, -7.0f);
+            gemm_packed(A.data(), K, M, Bp, C.data(), N, bias.data(), Activation::RELU, p);
+
+            double err = 0.0;
+            for (size_t i = 0; i < M; ++i) {
+                for (size_t j = 0; j < N; ++j) {
+                    err = std::max(err, std::fabs(C[i * N + j] - std::max(ref[i * N + j] + bias[j], 0.0)));
+                }
+            }
+            CHECK_NEAR(err, 0.0, 1e-4);
+        }
+    }
+}
+
+static void test_dense() {
+    nn::Dense<float> layer(20, 9, Activation::TANH, NTensorConfig{48}, 5);
+    CHECK(layer.in() == 20 && layer.out() == 9);
+
+    NTensor<float> X({7, 20}, 0.0f, NTensorConfig{48});
+    std::vector<float> x = random_floats(X.size(), 6);
+    std::copy(x.begin(), x.end(), X.data());
+
+    NTensor<float> Y = layer.forward(X);
+    CHECK(Y.shape()[0] == 7 && Y.shape()[1] == 9);
+
+    // the fused batch path agrees with the per-unit reference
+    double err = 0.0;
+    for (size_t j = 0; j < 9; ++j) {
+        nn::Neuron<float> n = layer.neuron(j);
+        for (size_t i = 0; i < 7; ++i) err = std::max(err, (double)std::fabs(Y.data()[i * 9 + j] - n.forward(X.data() + i * 20)));
+    }
+    CHECK_NEAR(err, 0.0, 1e-5);
+
+    // edits to the weights only show up after repack()
+    layer.weight().data()[0] += 1.0f;
+    layer.repack();
+    NTensor<float> Y2 = layer.forward(X, nullptr);
+    CHECK_NEAR(Y2.data()[0], layer.neuron(0).forward(X.data()), 1e-5);
+
+    NTensor<float> bad({7, 21}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(layer.forward(bad), std::runtime_error);
+
+    std::map<std::string, NTensor<float>> weights;
+    CHECK_THROWS(nn::Dense<float>::from_weights(weights, "fc"), std::runtime_error);
+    weights.emplace("fc.weight", layer.weight());
+    weights.emplace("fc.bias", layer.bias());
+    nn::Dense<float> loaded = nn::Dense<float>::from_weights(weights, "fc", Activation::TANH);
+    NTensor<float> Y3 = loaded.forward(X);
+    CHECK_NEAR(Y3.data()[0], Y2.data()[0], 0.0);
+}
+
+static void test_dense_bf16() {
+    NTensor<bf16> W({8, 3}, bf16(0.5f), NTensorConfig{48}), b({3}, bf16(-1.0f), NTensorConfig{48});
+    nn::Dense<bf16> layer(W, b, Activation::RELU);
+
+    NTensor<bf16> X({2, 8}, bf16(1.0f), NTensorConfig{48});
+    NTensor<bf16> Y = layer.forward(X, nullptr);
+    CHECK_NEAR((float)Y.data()[0], 3.0f, 0.0);
+    CHECK_NEAR((float)Y.data()[5], 3.0f, 0.0);
+}
+
+int main() {
+    test_gemm_packed();
+    test_dense();
+    test_dense_bf16();
+    return test_result();
+}
@@ -0,0 +1,71 @@
+#include <distributed.hpp>
+#include <transport.hpp>
+
+#include <ranks.hpp>
+#include <test.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static void test_distributed_gemm(size_t world, size_t M, size_t K, size_t N, bool cannon) {
+    NTensor<float> A = random_tensor({M, K}, 1), B = random_tensor({K, N}, 2);
+    std::vector<double> ref = reference_matmul(A.data(), B.data(), M, K, N);
+
+    ThreadPool pool(1);
+    run_ranks(world, cannon ? "cannon" : "summa", [&](Transport& tr) {
+        ProcessGrid grid = make_grid(tr);
+        NTensor<float> a = local_block(A, grid.rows, grid.cols, grid.row(), grid.col());
+        NTensor<float> b = local_block(B, grid.rows, grid.cols, grid.row(), grid.col());
+
+        NTensor<float> c = cannon ? cannon_matmul(a, b, M, K, N, grid, tr, pool)
+                                  : summa_matmul(a, b, M, K, N, grid, tr, pool);
+        std::optional<NTensor<float>> C = gather_blocks(c, M, N, grid, tr);
+
+        if (C) {
+            double err = 0.0;
+            for (size_t i = 0; i < M * N; ++i) err = std::max(err, std::fabs(C->data()[i] - ref[i]));
+            CHECK_NEAR(err, 0.0, 1e-4);
+        }
+    });
+}
+
+static void test_stale_segment() {
+    // a crashed job's segment under the same name, full of old ring counters
+    const std::string name = "/iml-test-" + std::to_string(::getpid()) + "-stale";
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    CHECK(fd >= 0);
+    std::vector<char> junk(8 << 20);
+    for (size_t i = 0; i < junk.size(); ++i) junk[i] = (char)(i * 131 + 7);
+    CHECK(::write(fd, junk.data(), junk.size()) == (ssize_t)junk.size());
+    ::close(fd);
+
+    run_ranks(2, "stale", [&](Transport& tr) {
+        std::vector<int> msg(1000);
+        if (tr.rank() == 0) {
+            for (size_t i = 0; i < msg.size(); ++i) msg[i] = (int)i;
+            tr.send(1, msg.data(), msg.size() * sizeof(int));
+        } else {
+            tr.recv(0, msg.data(), msg.size() * sizeof(int));
+            bool ok = true;
+            for (size_t i = 0; i < msg.size(); ++i) ok = ok && msg[i] == (int)i;
+            CHECK(ok);
+        }
+    });
+
+    ShmTransport::destroy(name);
+}
+
+static void test_attach_timeout() {
+    const std::string name = "/iml-test-" + std::to_string(::getpid()) + "-absent";
+    CHECK_THROWS(ShmTransport(name, 1, 2, 1 << 12, std::chrono::milliseconds(20)), std::runtime_error);
+}
+
+int main() {
+    test_distributed_gemm(4, 37, 29, 41, false);
+    test_distributed_gemm(3, 20, 16, 9, false);
+    test_distributed_gemm(4, 24, 16, 32, true);
+    test_stale_segment();
+    test_attach_timeout();
+    return test_result();
+}
@@ -0,0 +1,76 @@
+#include <nn/embedding.hpp>
+#include <optim.hpp>
+
+#include <test.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static void test_forward() {
+    ThreadPool pool(2);
+    // enough ids * dim to go through the pool, with the prefetch window crossing task edges
+    const size_t V = 500, D = 64, n = 1200;
+    nn::Embedding<float> emb(V, D, NTensorConfig{48}, 3);
+    CHECK(emb.vocab() == V && emb.dim() == D);
+
+    std::vector<size_t> ids(n);
+    for (size_t i = 0; i < n; ++i) ids[i] = (i * 7919) % V;
+
+    NTensor<float> Y = emb.forward(ids.data(), n, &pool);
+    CHECK(Y.shape()[0] == n && Y.shape()[1] == D);
+
+    bool same = true;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < D; ++j) same = same && Y.data()[i * D + j] == emb.row(ids[i])[j];
+    CHECK(same);
+
+    ids[17] = V;
+    CHECK_THROWS(emb.forward(ids.data(), n, &pool), std::runtime_error);
+    CHECK_THROWS(emb.row(V), std::runtime_error);
+}
+
+static void test_backward() {
+    const size_t V = 10, D = 3;
+    nn::Embedding<float> emb(NTensor<float>({V, D}, 1.0f, NTensorConfig{48}));
+
+    const std::vector<size_t> ids = {4, 1, 4, 9, 4};
+    std::vector<float> grad(ids.size() * D);
+    for (size_t i = 0; i < grad.size(); ++i) grad[i] = (float)(i / D + 1);
+
+    SparseRows<float> g = emb.backward(ids.data(), ids.size(), grad.data(), nullptr);
+    CHECK((g.rows == std::vector<size_t>{1, 4, 9}));
+    CHECK(g.cols == D && g.values.size() == 3 * D);
+    CHECK_NEAR(g.values[0], 2.0, 0.0);                 // id 1: position 1
+    CHECK_NEAR(g.values[D], 1.0 + 3.0 + 5.0, 0.0);     // id 4: positions 0, 2, 4
+    CHECK_NEAR(g.values[2 * D + 2], 4.0, 0.0);         // id 9: position 3
+
+    // the optimizer only touches the looked-up rows
+    SGDConfig cfg;
+    cfg.lr = 0.1; cfg.momentum = 0.0;
+    SGD<float> opt(cfg, nullptr);
+    opt.add_param(emb.weight());
+    opt.step({nullptr}, {&g});
+
+    CHECK_NEAR(emb.row(4)[1], 1.0 - 0.1 * 9.0, 1e-6);
+    CHECK_NEAR(emb.row(0)[0], 1.0, 0.0);
+    CHECK_NEAR(emb.row(9)[0], 1.0 - 0.1 * 4.0, 1e-6);
+}
+
+static void test_from_weights() {
+    std::map<std::string, NTensor<float>> weights;
+    CHECK_THROWS(nn::Embedding<float>::from_weights(weights, "tok"), std::runtime_error);
+
+    weights.emplace("tok.weight", NTensor<float>({4, 2}, 0.5f, NTensorConfig{48}));
+    nn::Embedding<float> emb = nn::Embedding<float>::from_weights(weights, "tok");
+    CHECK(emb.vocab() == 4 && emb.row(3)[1] == 0.5f);
+
+    CHECK_THROWS(nn::Embedding<float>(NTensor<float>({4}, 0.0f, NTensorConfig{48})), std::runtime_error);
+}
+
+int main() {
+    test_forward();
+    test_backward();
+    test_from_weights();
+    return test_result();
+}
@@ -0,0 +1,152 @@
+#include <attention.hpp>
+#include <kv_cache.hpp>
+
+#include <test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+static KVCacheConfig small_config() {
+    KVCacheConfig cfg;
+    cfg.layers = 2;
+    cfg.kv_heads = 2;
+    cfg.head_dim = 8;
+    cfg.page_tokens = 4;
+    cfg.pages = 16;
+    return cfg;
+}
+
+// [kv_heads x n x head_dim] keys / values for positions pos .. pos + n, a fixed function of the position
+static std::vector<float> kv_rows(size_t heads, size_t pos, size_t n, size_t D, unsigned salt) {
+    std::vector<float> out(heads * n * D);
+    for (size_t h = 0; h < heads; ++h)
+        for (size_t t = 0; t < n; ++t)
+            for (size_t d = 0; d < D; ++d) out[(h * n + t) * D + d] = std::sin(0.1f * (float)((pos + t) * 31 + h * 7 + d + salt));
+    return out;
+}
+
+static void fill(KVCache<float>& cache, size_t id, size_t n) {
+    const KVCacheConfig& c = cache.config();
+    const size_t pos = cache.extend(id, n);
+    for (size_t l = 0; l < c.layers; ++l) {
+        std::vector<float> k = kv_rows(c.kv_heads, pos, n, c.head_dim, (unsigned)l);
+        std::vector<float> v = kv_rows(c.kv_heads, pos, n, c.head_dim, (unsigned)(l + 100));
+        cache.store(id, l, pos, k.data(), v.data(), n);
+    }
+}
+
+static double attend_error(KVCache<float>& cache, size_t id, size_t layer, size_t heads, size_t nq) {
+    // cached attention against attention() over the same keys laid out contiguously
+    const KVCacheConfig& c = cache.config();
+    const size_t len = cache.length(id), D = c.head_dim;
+
+    std::vector<float> k = kv_rows(c.kv_heads, 0, len, D, (unsigned)layer);
+    std::vector<float> v = kv_rows(c.kv_heads, 0, len, D, (unsigned)(layer + 100));
+    std::vector<float> q = random_floats(heads * nq * D, 7);
+    std::vector<float> got(q.size()), want(q.size());
+
+    AttentionParams p;
+    p.causal = true;
+    cache.attend(id, layer, q.data(), got.data(), heads, nq, p, nullptr);
+    attention(q.data(), k.data(), v.data(), want.data(), 1, heads, c.kv_heads, nq, len, D, D, p, nullptr);
+
+    double err = 0.0;
+    for (size_t i = 0; i < q.size(); ++i) err = std::max(err, (double)std::fabs(got[i] - want[i]));
+    return err;
+}
+
+static void test_attend() {
+    KVCache<float> cache(small_config(), NTensorConfig{48});
+    const size_t id = cache.create();
+
+    fill(cache, id, 6);                     // prefill, partial second page
+    for (int t = 0; t < 5; ++t) fill(cache, id, 1);
+    CHECK(cache.length(id) == 11 && cache.pages_used() == 3);
+
+    CHECK_NEAR(attend_error(cache, id, 1, 4, 1), 0.0, 1e-5);    // decoding, grouped heads
+    CHECK_NEAR(attend_error(cache, id, 0, 2, 3), 0.0, 1e-5);    // causal block of queries
+
+    size_t blocks = 0, rows = 0;
+    cache.for_each_block(id, 0, 1, [&](const float*, const float*, size_t ld, size_t m, size_t pos) {
+        CHECK(ld == 8 && pos == rows);
+        ++blocks;
+        rows += m;
+    });
+    CHECK(blocks == 3 && rows == 11);
+}
+
+static void test_fork() {
+    KVCache<float> cache(small_config(), NTensorConfig{48});
+    const size_t parent = cache.create();
+    fill(cache, parent, 6);
+
+    const size_t child = cache.fork(parent);
+    CHECK(cache.pages_used() == 2);         // shared, nothing copied
+
+    // the child's first write into the shared tail page copies it
+    fill(cache, child, 3);
+    CHECK(cache.pages_used() == 4);
+    CHECK(cache.length(parent) == 6 && cache.length(child) == 9);
+    CHECK_NEAR(attend_error(cache, parent, 1, 2, 1), 0.0, 1e-5);
+    CHECK_NEAR(attend_error(cache, child, 1, 2, 1), 0.0, 1e-5);
+
+    cache.release(parent);
+    CHECK(cache.pages_used() == 3);
+    cache.release(child);
+    CHECK(cache.pages_free() == 16);
+}
+
+static void test_errors() {
+    KVCache<float> cache(small_config(), NTensorConfig{48});
+    const size_t id = cache.create();
+
+    CHECK_THROWS(cache.length(id + 1), std::runtime_error);
+    CHECK_THROWS(cache.extend(id, 16 * 4 + 1), std::runtime_error);
+    CHECK(cache.pages_free() == 16);
+
+    fill(cache, id, 2);
+    std::vector<float> q(3 * 8), o(3 * 8);
+    CHECK_THROWS(cache.attend(id, 0, q.data(), o.data(), 3, 1), std::runtime_error);
+    CHECK_THROWS(cache.attend(id, 0, q.data(), o.data(), 2, 3), std::runtime_error);
+
+    std::vector<float> k(2 * 3 * 8);
+    CHECK_THROWS(cache.store(id, 0, 0, k.data(), k.data(), 3), std::runtime_error);
+}
+
+static void test_concurrent() {
+    // readers of one sequence while other threads create, grow and drop theirs
+    KVCacheConfig cfg = small_config();
+    cfg.pages = 64;
+    KVCache<float> cache(cfg, NTensorConfig{48});
+    const size_t id = cache.create();
+    fill(cache, id, 10);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 3; ++w) {
+        writers.emplace_back([&] {
+            while (!stop.load()) {
+                const size_t s = cache.create();
+                for (int i = 0; i < 5; ++i) fill(cache, s, 1);
+                cache.release(s);
+            }
+        });
+    }
+
+    double err = 0.0;
+    for (int i = 0; i < 200; ++i) err = std::max(err, attend_error(cache, id, 0, 2, 1));
+    stop.store(true);
+    for (auto& t : writers) t.join();
+
+    CHECK_NEAR(err, 0.0, 1e-5);
+    CHECK(cache.pages_used() == 3);
+}
+
+int main() {
+    test_attend();
+    test_fork();
+    test_errors();
+    test_concurrent();
+    return test_result();
+}
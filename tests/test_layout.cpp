@@ -0,0 +1,99 @@
+#include <conv.hpp>
+#include <layout.hpp>
+#include <relayout.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+static bool same(NTensor<float>& a, NTensor<float>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) if (a.data()[i] != b.data()[i]) return false;
+    return true;
+}
+
+static void test_round_trip() {
+    // 13 channels do not fill an NCHWc block; 40 pixels span two relayout tiles
+    const size_t N = 2, C = 13, H = 5, W = 8;
+    NTensor<float> X = random_tensor({N, C, H, W}, 1);
+
+    NTensor<float> a = to_layout(X, TensorLayout::nhwc(), nullptr);
+    CHECK(a.layout().kind == Layout::NHWC && a.shape()[3] == C);
+    CHECK(a.data()[((1 * H + 2) * W + 3) * C + 4] == X.data()[((1 * C + 4) * H + 2) * W + 3]);
+
+    ThreadPool pool(2);
+    NTensor<float> b = to_layout(a, TensorLayout::nchwc(0, 8), &pool);
+    CHECK(b.ndim() == 5 && b.shape()[1] == 2 && b.shape()[4] == 8);
+    CHECK(b.layout() == TensorLayout::nchwc(C, 8));
+
+    auto [n, c, h, w] = nchw_dims(b);
+    CHECK(n == N && c == C && h == H && w == W);
+
+    // ActView addresses the same logical element in every layout
+    ActView<float> vx = act_view(X), vb = act_view(b);
+    CHECK(vb.chan(1, 12)[(2 * W + 3) * vb.b] == vx.chan(1, 12)[2 * W + 3]);
+
+    // padding channels of the last block stay zero
+    bool zero = true;
+    for (size_t p = 0; p < H * W; ++p)
+        for (size_t k = C; k < 16; ++k) zero = zero && vb.chan(0, 8)[p * 8 + (k - 8)] == 0.0f;
+    CHECK(zero);
+
+    NTensor<float> back = to_layout(b, TensorLayout::nchw(), &pool);
+    CHECK(same(back, X));
+
+    NTensor<float> direct = to_layout(X, TensorLayout::nchwc(0, 8), nullptr);
+    CHECK(same(direct, b));
+}
+
+static void test_conv_layouts() {
+    // every algorithm keeps the input's layout and gives the NCHW result
+    const size_t N = 2, C = 16, H = 9, W = 10, K = 16;
+    NTensor<float> X = random_tensor({N, C, H, W}, 2), F = random_tensor({K, C, 3, 3}, 3);
+    NTensor<float> Fd = random_tensor({C, 1, 3, 3}, 4);
+    std::vector<float> bias = random_floats(K, 5);
+
+    Conv2dParams p;
+    p.pad_h = p.pad_w = 1;
+    Conv2dParams dw = p;
+    dw.groups = C;
+
+    ThreadPool pool(2);
+    for (TensorLayout l : {TensorLayout::nhwc(), TensorLayout::nchwc(0, 8)}) {
+        NTensor<float> Xl = to_layout(X, l, &pool);
+
+        for (ConvAlgo algo : {ConvAlgo::IMPLICIT_GEMM, ConvAlgo::WINOGRAD_2x3, ConvAlgo::DEPTHWISE}) {
+            const bool depthwise = algo == ConvAlgo::DEPTHWISE;
+            NTensor<float>& f = depthwise ? Fd : F;
+            const Conv2dParams& q = depthwise ? dw : p;
+
+            NTensor<float> ref = conv2d(X, f, bias.data(), q, algo, Activation::IDENTITY, &pool);
+            NTensor<float> Y = conv2d(Xl, f, bias.data(), q, algo, Activation::IDENTITY, &pool);
+            CHECK(Y.layout().kind == l.kind);
+
+            NTensor<float> Yn = to_layout(Y, TensorLayout::nchw(), &pool);
+            double err = 0.0;
+            for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, (double)std::fabs(Yn.data()[i] - ref.data()[i]));
+            CHECK_NEAR(err, 0.0, 1e-4);
+        }
+    }
+
+    CHECK(preferred_layout(ConvShape::of(1, 3, 32, 32, 64, 3, 3, p), p).kind == Layout::NHWC);
+    CHECK(preferred_layout(ConvShape::of(1, 64, 32, 32, 64, 3, 3, p), p).kind == Layout::NCHW);
+}
+
+static void test_errors() {
+    NTensor<float> X({2, 3, 4}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(nchw_dims(X), std::runtime_error);
+
+    X.set_layout(TensorLayout::nchwc(3, 4));
+    CHECK_THROWS(to_layout(X, TensorLayout::nchw(), nullptr), std::runtime_error);
+    CHECK_THROWS(TensorLayout::nchwc(3, 0), std::runtime_error);
+}
+
+int main() {
+    test_round_trip();
+    test_conv_layouts();
+    test_errors();
+    return test_result();
+}
@@ -0,0 +1,109 @@
+#include <half.hpp>
+#include <norm.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+// rows x cols with a large per-row offset, to catch overflow in exp and cancellation in the variance
+static std::vector<float> offset_rows(size_t rows, size_t cols, unsigned seed) {
+    std::vector<float> x = random_floats(rows * cols, seed, -3.0f, 3.0f);
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t i = 0; i < cols; ++i) x[r * cols + i] += (r % 2 ? 1000.0f : -50.0f);
+    return x;
+}
+
+static void test_softmax() {
+    const size_t rows = 9, cols = 37;
+    std::vector<float> x = offset_rows(rows, cols, 1), y(x.size()), ly(x.size());
+    ThreadPool pool(2);
+    softmax(x.data(), y.data(), rows, cols, &pool);
+    log_softmax(x.data(), ly.data(), rows, cols, nullptr);
+
+    double err = 0.0, lerr = 0.0;
+    for (size_t r = 0; r < rows; ++r) {
+        const float* xr = x.data() + r * cols;
+        double m = *std::max_element(xr, xr + cols), s = 0.0;
+        for (size_t i = 0; i < cols; ++i) s += std::exp(xr[i] - m);
+        for (size_t i = 0; i < cols; ++i) {
+            err = std::max(err, std::fabs(y[r * cols + i] - std::exp(xr[i] - m) / s));
+            lerr = std::max(lerr, std::fabs(ly[r * cols + i] - (xr[i] - m - std::log(s))));
+        }
+    }
+    CHECK_NEAR(err, 0.0, 1e-6);
+    CHECK_NEAR(lerr, 0.0, 1e-4);
+
+    // in place, through the tensor overload
+    NTensor<float> t({3, 4}, 2.0f, NTensorConfig{48});
+    NTensor<float> st = softmax(t);
+    CHECK_NEAR(st.data()[5], 0.25, 1e-7);
+    softmax(t.data(), t.data(), 3, 4, nullptr);
+    CHECK_NEAR(t.data()[11], 0.25, 1e-7);
+}
+
+static void test_norms() {
+    const size_t rows = 6, cols = 50;
+    std::vector<float> x = offset_rows(rows, cols, 2), y(x.size()), z(x.size());
+    std::vector<float> gamma = random_floats(cols, 3), beta = random_floats(cols, 4);
+
+    layernorm(x.data(), y.data(), rows, cols, gamma.data(), beta.data(), 1e-5, nullptr);
+    rmsnorm(x.data(), z.data(), rows, cols, gamma.data(), 1e-6, nullptr);
+
+    double lerr = 0.0, rerr = 0.0;
+    for (size_t r = 0; r < rows; ++r) {
+        const float* xr = x.data() + r * cols;
+        double mean = 0.0, var = 0.0, ms = 0.0;
+        for (size_t i = 0; i < cols; ++i) mean += xr[i] / (double)cols;
+        for (size_t i = 0; i < cols; ++i) var += (xr[i] - mean) * (xr[i] - mean) / (double)cols;
+        for (size_t i = 0; i < cols; ++i) ms += (double)xr[i] * xr[i] / (double)cols;
+
+        for (size_t i = 0; i < cols; ++i) {
+            lerr = std::max(lerr, std::fabs(y[r * cols + i] - ((xr[i] - mean) / std::sqrt(var + 1e-5) * gamma[i] + beta[i])));
+            rerr = std::max(rerr, std::fabs(z[r * cols + i] - xr[i] / std::sqrt(ms + 1e-6) * gamma[i]));
+        }
+    }
+    CHECK_NEAR(lerr, 0.0, 1e-3);
+    CHECK_NEAR(rerr, 0.0, 1e-5);
+
+    NTensor<float> t({2, 2, 4}, 0.0f, NTensorConfig{48});
+    for (size_t i = 0; i < t.size(); ++i) t.data()[i] = (float)(i % 4);
+    NTensor<float> n = layernorm(t);
+    CHECK(n.ndim() == 3);
+    CHECK_NEAR(n.data()[12], -1.5 / std::sqrt(1.25 + 1e-5), 1e-6);
+}
+
+template<typename T>
+static void test_cross_entropy(double tol) {
+    const size_t rows = 7, cols = 12;
+    std::vector<float> xf = offset_rows(rows, cols, 5);
+    std::vector<T> x(xf.begin(), xf.end()), g(x.size());
+    std::vector<size_t> labels = {0, 11, 3, 3, 7, 1, 5};
+
+    const double loss = softmax_cross_entropy(x.data(), labels.data(), rows, cols, g.data(), 0.0, nullptr);
+
+    double want = 0.0, gerr = 0.0;
+    for (size_t r = 0; r < rows; ++r) {
+        double m = -1e300, s = 0.0;
+        for (size_t i = 0; i < cols; ++i) m = std::max(m, (double)(float)x[r * cols + i]);
+        for (size_t i = 0; i < cols; ++i) s += std::exp((double)(float)x[r * cols + i] - m);
+        want += (m + std::log(s) - (double)(float)x[r * cols + labels[r]]) / (double)rows;
+
+        for (size_t i = 0; i < cols; ++i) {
+            const double p = std::exp((double)(float)x[r * cols + i] - m) / s - (i == labels[r] ? 1.0 : 0.0);
+            gerr = std::max(gerr, std::fabs((double)(float)g[r * cols + i] - p / (double)rows));
+        }
+    }
+    CHECK_NEAR(loss, want, tol);
+    CHECK_NEAR(gerr, 0.0, tol);
+
+    labels[2] = cols;
+    CHECK_THROWS(softmax_cross_entropy(x.data(), labels.data(), rows, cols), std::runtime_error);
+}
+
+int main() {
+    test_softmax();
+    test_norms();
+    test_cross_entropy<float>(1e-5);
+    test_cross_entropy<bf16>(2e-2);
+    return test_result();
+}
@@ -0,0 +1,126 @@
+#include <half.hpp>
+#include <optim.hpp>
+
+#include <test.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+// spans several OPTIM_CHUNK chunks with a ragged tail
+constexpr size_t N = 2 * OPTIM_CHUNK + 123;
+
+static void test_sgd() {
+    ThreadPool pool(3);
+    NTensor<float> W = random_tensor({N}, 1);
+    std::vector<double> w(W.data(), W.data() + N), v(N, 0.0);
+
+    SGDConfig cfg;
+    cfg.lr = 0.1; cfg.momentum = 0.9; cfg.weight_decay = 0.01; cfg.nesterov = true;
+    SGD<float> opt(cfg, &pool);
+    opt.add_param(W);
+
+    for (unsigned s = 0; s < 3; ++s) {
+        std::vector<float> g = random_floats(N, 10 + s);
+        opt.step({g.data()}, 0.5f);
+
+        for (size_t i = 0; i < N; ++i) {
+            double gi = g[i] * 0.5 + cfg.weight_decay * w[i];
+            v[i] = cfg.momentum * v[i] + gi;
+            w[i] -= cfg.lr * (gi + cfg.momentum * v[i]);
+        }
+    }
+
+    double err = 0.0;
+    for (size_t i = 0; i < N; ++i) err = std::max(err, std::fabs(W.data()[i] - w[i]));
+    CHECK_NEAR(err, 0.0, 1e-5);
+    CHECK(opt.steps() == 3 && opt.size() == 1);
+
+    std::vector<float> g(N);
+    CHECK_THROWS(opt.step({g.data(), g.data()}), std::runtime_error);
+}
+
+static void test_adam(bool decoupled) {
+    NTensor<float> W = random_tensor({N}, 2);
+    std::vector<double> w(W.data(), W.data() + N), m(N, 0.0), v(N, 0.0);
+
+    AdamConfig cfg;
+    cfg.lr = 1e-2; cfg.weight_decay = 0.1;
+    std::unique_ptr<Adam<float>> opt;
+    if (decoupled) opt = std::make_unique<AdamW<float>>(cfg, nullptr);
+    else opt = std::make_unique<Adam<float>>(cfg, nullptr);
+    opt->add_param(W);
+
+    for (unsigned s = 1; s <= 3; ++s) {
+        std::vector<float> g = random_floats(N, 20 + s);
+        opt->step({g.data()});
+
+        const double bc1 = 1.0 - std::pow(cfg.beta1, s), bc2 = 1.0 - std::pow(cfg.beta2, s);
+        for (size_t i = 0; i < N; ++i) {
+            double gi = g[i] + (decoupled ? 0.0 : cfg.weight_decay * w[i]);
+            m[i] = cfg.beta1 * m[i] + (1 - cfg.beta1) * gi;
+            v[i] = cfg.beta2 * v[i] + (1 - cfg.beta2) * gi * gi;
+            if (decoupled) w[i] *= 1 - cfg.lr * cfg.weight_decay;
+            w[i] -= cfg.lr * (m[i] / bc1) / (std::sqrt(v[i] / bc2) + cfg.eps);
+        }
+    }
+
+    double err = 0.0;
+    for (size_t i = 0; i < N; ++i) err = std::max(err, std::fabs(W.data()[i] - w[i]));
+    CHECK_NEAR(err, 0.0, 1e-5);
+    CHECK(opt->config().decoupled_weight_decay == decoupled);
+}
+
+static void test_sparse_rows() {
+    const size_t rows = 10, cols = 4;
+    NTensor<float> E({rows, cols}, 1.0f, NTensorConfig{48});
+
+    SGDConfig cfg;
+    cfg.lr = 0.5; cfg.momentum = 0.0;
+    SGD<float> opt(cfg, nullptr);
+    opt.add_param(E);
+
+    SparseRows<float> g;
+    g.cols = cols;
+    g.rows = {7, 2};
+    g.values.assign(2 * cols, 1.0f);
+    opt.step({nullptr}, {&g});
+
+    for (size_t r = 0; r < rows; ++r) {
+        const float want = (r == 2 || r == 7) ? 0.5f : 1.0f;
+        for (size_t c = 0; c < cols; ++c) CHECK_NEAR(E.data()[r * cols + c], want, 0.0);
+    }
+
+    g.rows = {11, 0};
+    CHECK_THROWS(opt.step({nullptr}, {&g}), std::runtime_error);
+
+    // a duplicated row is rejected before anything is stepped
+    const size_t before = opt.steps();
+    g.rows = {3, 3};
+    CHECK_THROWS(opt.step({nullptr}, {&g}), std::runtime_error);
+    CHECK(opt.steps() == before);
+    CHECK_NEAR(E.data()[3 * cols], 1.0, 0.0);
+}
+
+static void test_master_weights() {
+    // updates far below bf16 resolution still accumulate in the float master copy
+    NTensor<bf16> W({4}, bf16(1.0f), NTensorConfig{48});
+    SGDConfig cfg;
+    cfg.lr = 1e-4; cfg.momentum = 0.0;
+    SGD<bf16, float> opt(cfg, nullptr);
+    opt.add_param(W);
+
+    std::vector<bf16> g(4, bf16(1.0f));
+    for (int s = 0; s < 100; ++s) opt.step({g.data()});
+
+    CHECK_NEAR(opt.master(0)[0], 0.99, 1e-5);
+    CHECK((float)W.data()[0] < 1.0f);
+}
+
+int main() {
+    test_sgd();
+    test_adam(false);
+    test_adam(true);
+    test_sparse_rows();
+    test_master_weights();
+    return test_result();
+}
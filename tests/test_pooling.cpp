@@ -0,0 +1,151 @@
+#include <half.hpp>
+#include <pooling.hpp>
+#include <relayout.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+// direct NCHW pooling; windows only count the inputs they cover unless count_include_pad
+static std::vector<double> reference_pool(NTensor<float>& x, PoolMode mode, const Pool2dParams& p,
+                                          size_t OH, size_t OW) {
+    const size_t N = x.shape()[0], C = x.shape()[1], H = x.shape()[2], W = x.shape()[3];
+    std::vector<double> y(N * C * OH * OW);
+
+    for (size_t nc = 0; nc < N * C; ++nc)
+    for (size_t oh = 0; oh < OH; ++oh)
+    for (size_t ow = 0; ow < OW; ++ow) {
+        double acc = mode == PoolMode::MAX ? -1e300 : 0.0;
+        size_t count = 0;
+        for (size_t r = 0; r < p.kernel_h; ++r)
+        for (size_t q = 0; q < p.kernel_w; ++q) {
+            const long h = (long)(oh * p.stride_h + r) - (long)p.pad_h, w = (long)(ow * p.stride_w + q) - (long)p.pad_w;
+            if (h < 0 || w < 0 || h >= (long)H || w >= (long)W) continue;
+            const double v = x.data()[(nc * H + h) * W + w];
+            acc = mode == PoolMode::MAX ? std::max(acc, v) : acc + v;
+            ++count;
+        }
+        if (mode == PoolMode::AVG) acc /= (double)(p.count_include_pad ? p.kernel_h * p.kernel_w : count);
+        y[(nc * OH + oh) * OW + ow] = acc;
+    }
+    return y;
+}
+
+static void test_pool2d() {
+    ThreadPool pool(2);
+    NTensor<float> x = random_tensor({2, 5, 9, 11}, 1);
+
+    Pool2dParams p;
+    p.kernel_h = 3; p.kernel_w = 3;
+    p.stride_h = 2; p.stride_w = 1;
+    p.pad_h = 1; p.pad_w = 1;
+
+    for (bool include_pad : {false, true}) {
+        p.count_include_pad = include_pad;
+        for (PoolMode mode : {PoolMode::MAX, PoolMode::AVG}) {
+            std::vector<double> ref = reference_pool(x, mode, p, 5, 11);
+
+            // every layout gives the NCHW result and keeps its own layout
+            for (TensorLayout l : {TensorLayout::nchw(), TensorLayout::nhwc(), TensorLayout::nchwc(0, 4)}) {
+                NTensor<float> xl = to_layout(x, l, &pool);
+                NTensor<float> y = pool2d(xl, mode, p, &pool);
+                CHECK(y.layout().kind == l.kind);
+
+                NTensor<float> yn = to_layout(y, TensorLayout::nchw(), &pool);
+                double err = 0.0;
+                for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::fabs(yn.data()[i] - ref[i]));
+                CHECK_NEAR(err, 0.0, 1e-6);
+            }
+        }
+    }
+
+    NTensor<float> g = global_avg_pool(x, &pool);
+    double mean = 0.0;
+    for (size_t i = 0; i < 99; ++i) mean += x.data()[99 * 7 + i] / 99.0;
+    CHECK(g.shape()[2] == 1 && g.shape()[3] == 1);
+    CHECK_NEAR(g.data()[7], mean, 1e-6);
+}
+
+template<typename T>
+static void test_negative_half() {
+    // all-negative input: the max must not come back as the zero a missing numeric_limits would give
+    NTensor<T> x({1, 3, 4, 6}, T(-3.0f), NTensorConfig{48});
+    x.data()[5] = T(-1.5f);
+
+    Pool2dParams p;
+    p.pad_h = 1; p.pad_w = 1;
+    NTensor<T> y = max_pool2d(x, p, nullptr);
+    CHECK(y.shape()[2] == 3 && y.shape()[3] == 4);
+    CHECK_NEAR((float)y.data()[0], -3.0f, 0.0);
+    CHECK_NEAR((float)y.data()[3], -1.5f, 0.0);
+
+    bool negative = true;
+    for (size_t i = 0; i < y.size(); ++i) negative = negative && (float)y.data()[i] < 0.0f;
+    CHECK(negative);
+
+    NTensor<T> g = global_max_pool(x, nullptr);
+    CHECK_NEAR((float)g.data()[1], -3.0f, 0.0);
+
+    NTensor<T> a = avg_pool2d(x, Pool2dParams{}, nullptr);
+    CHECK_NEAR((float)a.data()[a.size() - 1], -3.0f, 0.0);
+}
+
+static void test_1d() {
+    NTensor<float> x({1, 2, 7}, 0.0f, NTensorConfig{48});
+    for (size_t i = 0; i < x.size(); ++i) x.data()[i] = (float)i;
+
+    Pool2dParams p;
+    p.kernel_w = 3;
+    NTensor<float> y = max_pool2d(x, p, nullptr);
+    CHECK(y.ndim() == 3 && y.shape()[2] == 2);
+    CHECK_NEAR(y.data()[0], 2.0, 0.0);
+    CHECK_NEAR(y.data()[3], 12.0, 0.0);
+}
+
+static void test_upsample() {
+    NTensor<float> x({1, 1, 2, 2}, 0.0f, NTensorConfig{48});
+    x.data()[0] = 0.0f; x.data()[1] = 1.0f; x.data()[2] = 2.0f; x.data()[3] = 3.0f;
+
+    NTensor<float> n = upsample(x, 4, 4, UpsampleMode::NEAREST, false, nullptr);
+    CHECK_NEAR(n.data()[1], 0.0, 0.0);
+    CHECK_NEAR(n.data()[2], 1.0, 0.0);
+    CHECK_NEAR(n.data()[15], 3.0, 0.0);
+
+    NTensor<float> c = upsample(x, 3, 3, UpsampleMode::BILINEAR, true, nullptr);
+    CHECK_NEAR(c.data()[4], 1.5, 1e-6);
+    CHECK_NEAR(c.data()[8], 3.0, 1e-6);
+
+    // half-pixel convention: the single output row blends both source rows equally ({1, 2}),
+    // and output column 1 of 4 sits a quarter of the way from source column 0 to 1
+    NTensor<float> b = upsample(x, 1, 4, UpsampleMode::BILINEAR, false, nullptr);
+    CHECK_NEAR(b.data()[1], 1.25, 1e-6);
+
+    ThreadPool pool(2);
+    NTensor<float> xl = to_layout(x, TensorLayout::nhwc(), &pool);
+    NTensor<float> cl = upsample(xl, 3, 3, UpsampleMode::BILINEAR, true, &pool);
+    NTensor<float> cn = to_layout(cl, TensorLayout::nchw(), &pool);
+    CHECK_NEAR(cn.data()[4], c.data()[4], 0.0);
+}
+
+static void test_errors() {
+    NTensor<float> x({1, 1, 3, 3}, 0.0f, NTensorConfig{48});
+    Pool2dParams big;
+    big.kernel_h = big.kernel_w = 5;
+    CHECK_THROWS(max_pool2d(x, big, nullptr), std::runtime_error);
+
+    Pool2dParams pad;
+    pad.pad_h = 2;
+    CHECK_THROWS(avg_pool2d(x, pad, nullptr), std::runtime_error);
+
+    CHECK_THROWS(upsample(x, 0, 2), std::runtime_error);
+}
+
+int main() {
+    test_pool2d();
+    test_negative_half<bf16>();
+    test_negative_half<fp16>();
+    test_1d();
+    test_upsample();
+    test_errors();
+    return test_result();
+}
@@ -0,0 +1,153 @@
+#include <calibrate.hpp>
+#include <nn/quantized_dense.hpp>
+#include <quantize.hpp>
+
+#include <test.hpp>
+
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static void test_quantize() {
+    CHECK_NEAR(int8_scale(0.0f), 1.0, 0.0);
+    CHECK_NEAR(int8_scale(254.0f), 2.0, 0.0);
+
+    const float scale = int8_scale(1.0f);
+    std::vector<float> x = random_floats(1000, 1);
+    x[0] = 5.0f; x[1] = -5.0f;                  // clamped, never -128
+    std::vector<int8_t> q(x.size());
+    std::vector<float> back(x.size());
+    quantize_int8(x.data(), q.data(), x.size(), scale);
+    dequantize_int8(q.data(), back.data(), x.size(), scale);
+
+    CHECK(q[0] == 127 && q[1] == -127);
+    double err = 0.0;
+    for (size_t i = 2; i < x.size(); ++i) err = std::max(err, (double)std::fabs(back[i] - x[i]));
+    CHECK(err <= scale / 2 + 1e-7);
+}
+
+static void test_gemm_s8() {
+    // odd sizes hit the 2 x 2 kernel's row and column tails and the tile edges
+    const size_t M = 37, N = 71, K = 53;
+    std::vector<int8_t> A(M * K), Bt(N * K);
+    for (size_t i = 0; i < A.size(); ++i) A[i] = (int8_t)((int)(i * 37 % 255) - 127);
+    for (size_t i = 0; i < Bt.size(); ++i) Bt[i] = (int8_t)((int)(i * 91 % 255) - 127);
+
+    ThreadPool pool(2);
+    for (ThreadPool* p : {(ThreadPool*)nullptr, &pool}) {
+        std::vector<int32_t> C(M * N, -1);
+        gemm_s8(A.data(), K, M, Bt.data(), K, N, K, C.data(), N, p);
+
+        bool same = true;
+        for (size_t i = 0; i < M; ++i)
+            for (size_t j = 0; j < N; ++j) same = same && C[i * N + j] == dot_s8(A.data() + i * K, Bt.data() + j * K, K);
+        CHECK(same);
+    }
+}
+
+static void test_observer() {
+    // a bulk of small values and a few outliers: PERCENTILE / ENTROPY clip below the max
+    NTensor<float> x({4000, 2}, 0.0f, NTensorConfig{48});
+    std::vector<float> v = random_floats(x.size(), 2);
+    std::copy(v.begin(), v.end(), x.data());
+    x.data()[10] = 40.0f;
+    x.data()[11] = -30.0f;
+
+    RangeObserver obs;
+    obs.observe(x);
+    obs.observe_histogram(x, 2048);
+    CHECK_NEAR(obs.amax(), 40.0, 0.0);
+    CHECK_NEAR(obs.channel_max()[0], 40.0, 0.0);
+    CHECK_NEAR(obs.channel_min()[1], -30.0, 0.0);
+
+    CalibConfig cfg;
+    cfg.method = CalibMethod::MINMAX;
+    CHECK_NEAR(obs.threshold(cfg), 40.0, 0.0);
+
+    cfg.method = CalibMethod::PERCENTILE;
+    cfg.percentile = 99.0;
+    CHECK(obs.threshold(cfg) < 1.1f && obs.threshold(cfg) > 0.9f);
+
+    cfg.method = CalibMethod::ENTROPY;
+    const float t = obs.threshold(cfg);
+    CHECK(t > 0.5f && t < 40.0f);
+
+    NTensor<float> other({3, 5}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(obs.observe(other), std::runtime_error);
+}
+
+static void test_round_trip() {
+    // calibrate a float model, write it int8, and run the int8 layers against the float ones
+    std::map<std::string, NTensor<float>> w;
+    NTensor<float> w1({16, 12}, 0.0f, NTensorConfig{48}), w2({12, 5}, 0.0f, NTensorConfig{48});
+    std::vector<float> a = random_floats(w1.size(), 3), b = random_floats(w2.size(), 4);
+    std::copy(a.begin(), a.end(), w1.data());
+    std::copy(b.begin(), b.end(), w2.data());
+    w.emplace("fc1.weight", w1);
+    w.emplace("fc1.bias", NTensor<float>({12}, 0.1f, NTensorConfig{48}));
+    w.emplace("fc2.weight", w2);
+
+    std::vector<nn::LayerSpec> specs = {{nn::LayerKind::DENSE, "fc1", Activation::RELU}, {nn::LayerKind::DENSE, "fc2"}};
+    nn::Sequential<float> model = nn::Sequential<float>::load(specs, w, NTensorConfig{48});
+
+    std::vector<NTensor<float>> samples;
+    for (unsigned s = 0; s < 3; ++s) {
+        samples.emplace_back(std::vector<size_t>{32, 16}, 0.0f, NTensorConfig{48});
+        std::vector<float> x = random_floats(32 * 16, 10 + s);
+        std::copy(x.begin(), x.end(), samples.back().data());
+    }
+
+    CalibConfig cfg;
+    cfg.method = CalibMethod::MINMAX;
+    std::vector<LayerCalibration> calib = calibrate(model, samples, cfg, nullptr);
+    CHECK(calib.size() == 2 && calib[0].name == "fc1");
+    CHECK(calib[0].input_amax <= 1.0f && calib[0].channel_min.size() == 16);
+
+    const std::string path = temp_path("quantized.bin");
+    save_quantized(path, model, calib, cfg);
+    std::map<std::string, TensorBlob> blobs = load_blobs(path);
+    std::remove(path.c_str());
+
+    nn::QuantizedDense q1 = nn::QuantizedDense::from_blobs(blobs, "fc1");
+    nn::QuantizedDense q2 = nn::QuantizedDense::from_blobs(blobs, "fc2");
+    CHECK(q1.in() == 16 && q1.out() == 12 && q2.out() == 5);
+    CHECK_NEAR(q1.input_scale(), calib[0].input_scale, 0.0);
+
+    NTensor<float> want = model.forward(samples[1], nullptr);
+    NTensor<float> h = q1.forward(samples[1], nullptr);
+    NTensor<float> got = q2.forward(h, nullptr);
+
+    double err = 0.0, mag = 0.0;
+    for (size_t i = 0; i < want.size(); ++i) {
+        err = std::max(err, (double)std::fabs(got.data()[i] - want.data()[i]));
+        mag = std::max(mag, (double)std::fabs(want.data()[i]));
+    }
+    CHECK(err < 0.03 * mag);
+
+    CHECK_THROWS(nn::QuantizedDense::from_blobs(blobs, "fc3"), std::runtime_error);
+
+    // truncated or hand-edited entries throw instead of reading past the data
+    std::map<std::string, TensorBlob> bad = blobs;
+    bad.at("fc1.weight").bytes.resize(10);
+    CHECK_THROWS(nn::QuantizedDense::from_blobs(bad, "fc1"), std::runtime_error);
+
+    bad = blobs;
+    bad.at("fc1.input_scale") = TensorBlob::of<float>({0}, nullptr);
+    CHECK_THROWS(nn::QuantizedDense::from_blobs(bad, "fc1"), std::runtime_error);
+
+    bad = blobs;
+    const int32_t act = 99;
+    bad["fc1.activation"] = TensorBlob::of<int32_t>({1}, &act);
+    CHECK_THROWS(nn::QuantizedDense::from_blobs(bad, "fc1"), std::runtime_error);
+    samples.clear();
+    CHECK_THROWS(calibrate(model, samples), std::runtime_error);
+}
+
+int main() {
+    test_quantize();
+    test_gemm_s8();
+    test_observer();
+    test_round_trip();
+    return test_result();
+}
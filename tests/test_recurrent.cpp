@@ -0,0 +1,107 @@
+#include <half.hpp>
+#include <nn/recurrent.hpp>
+
+#include <test.hpp>
+
+#include <stdexcept>
+
+static double sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+
+// PyTorch-convention LSTM / GRU in double, time-major [steps x batch x in]
+template<typename T, typename Cell>
+static std::vector<double> reference(nn::Recurrent<T, Cell>& layer, const std::vector<double>& X,
+                                     size_t steps, size_t batch) {
+    const size_t I = layer.in(), H = layer.hidden(), GH = layer.gates_width();
+    auto w = [](NTensor<T>& t, size_t i) { return (double)(accum_t<T>)t.data()[i]; };
+
+    std::vector<double> Y(steps * batch * H), h(batch * H, 0.0), c(batch * H, 0.0), gx(GH), gh(GH);
+    for (size_t t = 0; t < steps; ++t) {
+        for (size_t b = 0; b < batch; ++b) {
+            for (size_t j = 0; j < GH; ++j) {
+                gx[j] = w(layer.bias_ih(), j);
+                gh[j] = w(layer.bias_hh(), j);
+                for (size_t i = 0; i < I; ++i) gx[j] += X[(t * batch + b) * I + i] * w(layer.weight_ih(), i * GH + j);
+                for (size_t i = 0; i < H; ++i) gh[j] += h[b * H + i] * w(layer.weight_hh(), i * GH + j);
+            }
+
+            std::vector<double> hn(H);
+            for (size_t j = 0; j < H; ++j) {
+                if constexpr (Cell::gates == 4) {
+                    const double ig = sigmoid(gx[j] + gh[j]), fg = sigmoid(gx[H + j] + gh[H + j]);
+                    const double gg = std::tanh(gx[2 * H + j] + gh[2 * H + j]), og = sigmoid(gx[3 * H + j] + gh[3 * H + j]);
+                    c[b * H + j] = fg * c[b * H + j] + ig * gg;
+                    hn[j] = og * std::tanh(c[b * H + j]);
+                } else {
+                    const double r = sigmoid(gx[j] + gh[j]), z = sigmoid(gx[H + j] + gh[H + j]);
+                    const double n = std::tanh(gx[2 * H + j] + r * gh[2 * H + j]);
+                    hn[j] = n + z * (h[b * H + j] - n);
+                }
+            }
+            for (size_t j = 0; j < H; ++j) Y[(t * batch + b) * H + j] = hn[j];
+        }
+        std::copy(Y.begin() + t * batch * H, Y.begin() + (t + 1) * batch * H, h.begin());
+    }
+    return Y;
+}
+
+template<typename T, typename Cell>
+static void check_layer(double tol) {
+    // hidden size not a multiple of the vector width, so the gate pass has a tail
+    const size_t steps = 6, batch = 3, I = 10, H = 21;
+    nn::Recurrent<T, Cell> layer(I, H, NTensorConfig{48}, 7);
+    CHECK(layer.gates_width() == Cell::gates * H);
+
+    std::vector<float> xf = random_floats(steps * batch * I, 1);
+    NTensor<T> X({steps, batch, I}, (T)0.0f, NTensorConfig{48});
+    std::vector<double> xd(xf.size());
+    for (size_t i = 0; i < xf.size(); ++i) {
+        X.data()[i] = (T)xf[i];
+        xd[i] = (double)(accum_t<T>)X.data()[i];
+    }
+
+    ThreadPool pool(2);
+    NTensor<T> Y = layer.forward(X, nullptr, &pool);
+    std::vector<double> ref = reference(layer, xd, steps, batch);
+
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::fabs((double)(accum_t<T>)Y.data()[i] - ref[i]));
+    CHECK_NEAR(err, 0.0, tol);
+
+    // two calls threaded through the state give the same sequence as one
+    nn::RecurrentState<T> state;
+    std::vector<T> y(steps * batch * H);
+    layer.forward(X.data(), 4, batch, y.data(), &state, nullptr);
+    layer.forward(X.data() + 4 * batch * I, 2, batch, y.data() + 4 * batch * H, &state, nullptr);
+
+    bool same = true;
+    for (size_t i = 0; i < y.size(); ++i) same = same && (double)(accum_t<T>)y[i] == (double)(accum_t<T>)Y.data()[i];
+    CHECK(same);
+    CHECK(state.h.size() == batch * H && state.c.size() == (Cell::has_cell ? batch * H : 0));
+}
+
+static void test_errors() {
+    nn::LSTM<float> lstm(4, 5, NTensorConfig{48});
+    NTensor<float> X({2, 3, 5}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(lstm.forward(X), std::runtime_error);
+
+    nn::RecurrentState<float> state;
+    state.h.assign(7, 0.0f);
+    NTensor<float> ok({2, 3, 4}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(lstm.forward(ok, &state), std::runtime_error);
+
+    NTensor<float> w({4, 10}, 0.0f, NTensorConfig{48}), b({10}, 0.0f, NTensorConfig{48});
+    CHECK_THROWS(nn::LSTM<float>(w, w, b, b), std::runtime_error);
+
+    std::map<std::string, NTensor<float>> weights;
+    weights.emplace("rnn.weight_ih", lstm.weight_ih());
+    CHECK_THROWS(nn::LSTM<float>::from_weights(weights, "rnn"), std::runtime_error);
+}
+
+int main() {
+    check_layer<float, nn::LSTMCell>(1e-5);
+    check_layer<float, nn::GRUCell>(1e-5);
+    check_layer<double, nn::LSTMCell>(1e-12);
+    check_layer<bf16, nn::GRUCell>(3e-2);
+    test_errors();
+    return test_result();
+}
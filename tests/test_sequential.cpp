@@ -0,0 +1,100 @@
+#include <nn/sequential.hpp>
+#include <relayout.hpp>
+
+#include <test.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <string>
+
+static std::map<std::string, NTensor<float>> model_weights() {
+    std::map<std::string, NTensor<float>> w;
+    w.emplace("conv.weight", random_tensor({6, 3, 3, 3}, 1));
+    w.emplace("conv.bias", random_tensor({6}, 2));
+    w.emplace("bn.running_mean", random_tensor({6}, 3));
+    w.emplace("bn.running_var", random_tensor({6}, 4, 0.5f, 2.0f));
+    w.emplace("bn.weight", random_tensor({6}, 5));
+    w.emplace("bn.bias", random_tensor({6}, 6));
+    w.emplace("fc1.weight", random_tensor({6 * 5 * 5, 8}, 7, -0.1f, 0.1f));
+    w.emplace("fc1.bias", random_tensor({8}, 8));
+    w.emplace("scale.weight", random_tensor({8}, 9));
+    w.emplace("shift.bias", random_tensor({8}, 10));
+    w.emplace("fc2.weight", random_tensor({8, 4}, 11));
+    w.emplace("fc3.weight", random_tensor({4, 3}, 12));
+    w.emplace("fc3.bias", random_tensor({3}, 13));
+    return w;
+}
+
+static std::vector<nn::LayerSpec> model_specs() {
+    Conv2dParams same;
+    same.pad_h = same.pad_w = 1;
+
+    using nn::LayerKind;
+    return {
+        {LayerKind::CONV2D, "conv", Activation::IDENTITY, same},
+        {LayerKind::BATCHNORM, "bn"},
+        {LayerKind::ACTIVATION, "act", Activation::RELU},
+        {LayerKind::DENSE, "fc1"},
+        {LayerKind::SCALE, "scale"},
+        {LayerKind::BIAS, "shift"},
+        {LayerKind::ACTIVATION, "act", Activation::TANH},
+        {LayerKind::DENSE, "fc2"},
+        {LayerKind::DENSE, "fc3"},
+    };
+}
+
+static double max_diff(NTensor<float>& a, NTensor<float>& b) {
+    double err = a.size() == b.size() ? 0.0 : 1e30;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) err = std::max(err, (double)std::fabs(a.data()[i] - b.data()[i]));
+    return err;
+}
+
+static void test_simplify() {
+    std::map<std::string, NTensor<float>> weights = model_weights();
+    nn::Sequential<float> plain = nn::Sequential<float>::load(model_specs(), weights, NTensorConfig{48}, false);
+    nn::Sequential<float> fast = nn::Sequential<float>::load(model_specs(), weights, NTensorConfig{48});
+    CHECK(plain.size() == 9);
+
+    // conv+bn+relu, fc1+scale+shift+tanh, fc2+fc3
+    CHECK(fast.size() == 3);
+    const std::string d = fast.describe();
+    CHECK(d.find("conv2d conv+bn 3x3 3->6 relu") != std::string::npos);
+    CHECK(d.find("dense fc1+scale+shift 150x8 tanh") != std::string::npos);
+    CHECK(d.find("dense fc2+fc3 8x3 identity") != std::string::npos);
+
+    ThreadPool pool(2);
+    NTensor<float> X = random_tensor({2, 3, 5, 5}, 14);
+    NTensor<float> want = plain.forward(X, &pool);
+    NTensor<float> got = fast.forward(X, &pool);
+    CHECK(got.ndim() == 2 && got.shape()[0] == 2 && got.shape()[1] == 3);
+    CHECK_NEAR(max_diff(got, want), 0.0, 1e-4);
+
+    // the same model on an NHWC input
+    NTensor<float> Xh = to_layout(X, TensorLayout::nhwc(), &pool);
+    NTensor<float> goth = fast.forward(Xh, &pool);
+    CHECK_NEAR(max_diff(goth, want), 0.0, 1e-4);
+
+    size_t seen = 0;
+    fast.forward(X, nullptr, [&](size_t i, NTensor<float>& in) {
+        CHECK(i == seen++);
+        if (i == 1) CHECK(in.ndim() == 2 && in.shape()[1] == 150);
+    });
+    CHECK(seen == 3);
+}
+
+static void test_errors() {
+    std::map<std::string, NTensor<float>> weights = model_weights();
+    weights.erase("bn.running_var");
+    CHECK_THROWS(nn::Sequential<float>::load(model_specs(), weights, NTensorConfig{48}), std::runtime_error);
+
+    weights = model_weights();
+    weights.erase("fc1.bias");
+    weights.emplace("fc1.bias", NTensor<float>({7}, 0.0f, NTensorConfig{48}));
+    CHECK_THROWS(nn::Sequential<float>::load(model_specs(), weights, NTensorConfig{48}), std::runtime_error);
+}
+
+int main() {
+    test_simplify();
+    test_errors();
+    return test_result();
+}
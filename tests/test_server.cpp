@@ -0,0 +1,205 @@
+#include <protocol.hpp>
+#include <serialize.hpp>
+#include <server.hpp>
+#include <socket.hpp>
+#include <tensor_pool.hpp>
+
+#include <test.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+static void test_weights_round_trip() {
+    const std::string path = temp_path("weights.bin");
+
+    std::map<std::string, NTensor<float>> w;
+    w.emplace("a", NTensor<float>({2, 3}, 1.5f, NTensorConfig{48}));
+    w.emplace("b", NTensor<float>({4}, -2.0f, NTensorConfig{48}));
+    w.at("a").data()[4] = 7.0f;
+    save_weights(path, w);
+
+    std::map<std::string, NTensor<float>> r = load_weights<float>(path, NTensorConfig{48});
+    CHECK(r.size() == 2);
+    CHECK(r.at("a").ndim() == 2 && r.at("a").shape()[1] == 3);
+    CHECK(r.at("a").data()[4] == 7.0f);
+    CHECK(r.at("b").data()[3] == -2.0f);
+    CHECK_THROWS(load_weights<double>(path, NTensorConfig{48}), std::runtime_error);
+
+    // mixed dtypes through blobs, same file format
+    const int8_t q[4] = {-127, 0, 5, 127};
+    std::map<std::string, TensorBlob> blobs;
+    blobs["q"] = TensorBlob::of<int8_t>({4}, q);
+    blobs["s"] = TensorBlob::of<float>({1}, &w.at("a").data()[4]);
+    save_blobs(path, blobs);
+
+    std::map<std::string, TensorBlob> rb = load_blobs(path);
+    CHECK(rb.at("q").dtype == I8 && rb.at("q").bytes.size() == 4);
+    CHECK((int8_t)rb.at("q").bytes[0] == -127);
+    CHECK(rb.at("s").tensor<float>(NTensorConfig{48}).data()[0] == 7.0f);
+    CHECK_THROWS(rb.at("q").tensor<float>(NTensorConfig{48}), std::runtime_error);
+
+    std::remove(path.c_str());
+    CHECK_THROWS(load_blobs(path), std::runtime_error);
+}
+
+static void test_tensor_pool() {
+    TensorPool<float> pool(NTensorConfig{48}, 1);
+
+    NTensor<float>* first;
+    {
+        auto h = pool.acquire({2, 2});
+        first = h.get();
+        h->data()[0] = 3.0f;
+    }
+
+    auto again = pool.acquire({2, 2});
+    CHECK(again.get() == first);            // recycled, not reallocated
+    CHECK(again->data()[0] == 3.0f);
+
+    auto other = pool.acquire({2, 2});
+    CHECK(other.get() != first);
+}
+
+static void test_socket_io() {
+    int fds[2];
+    CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    RequestHeader req{};
+    req.magic = PROTOCOL_MAGIC;
+    std::vector<float> payload = random_floats(1 << 16, 1);
+
+    std::thread writer([&] {
+        CHECK(_socket::send_all(fds[0], &req, sizeof(req)));
+        CHECK(_socket::send_all(fds[0], payload.data(), payload.size() * sizeof(float)));
+        ::close(fds[0]);
+    });
+
+    RequestHeader got{};
+    std::vector<float> back(payload.size());
+    CHECK(_socket::recv_all(fds[1], &got, sizeof(got)));
+    CHECK(_socket::recv_all(fds[1], back.data(), back.size() * sizeof(float)));
+    writer.join();
+
+    CHECK(got.magic == PROTOCOL_MAGIC);
+    CHECK(back == payload);
+
+    char extra;
+    CHECK(!_socket::recv_all(fds[1], &extra, 1));   // EOF
+    ::close(fds[1]);
+}
+
+// one request / response exchange as a client; returns the response header and fills out
+static ResponseHeader call(int fd, Op op, uint32_t weight, uint32_t rows, uint32_t cols,
+                           const float* a, std::vector<char>& out) {
+    RequestHeader req{};
+    req.magic = PROTOCOL_MAGIC;
+    req.op = (uint32_t)op;
+    req.id = 1000 + weight;
+    req.weight = weight;
+    req.rows = rows;
+    req.cols = cols;
+    CHECK(_socket::send_all(fd, &req, sizeof(req)));
+    if (a) CHECK(_socket::send_all(fd, a, (size_t)rows * cols * sizeof(float)));
+
+    ResponseHeader res{};
+    CHECK(_socket::recv_all(fd, &res, sizeof(res)));
+    out.resize(res.payload_bytes);
+    CHECK(_socket::recv_all(fd, out.data(), out.size()));
+    CHECK(res.magic == PROTOCOL_MAGIC && res.id == req.id);
+    return res;
+}
+
+static void test_inference_server() {
+    const std::string path = temp_path("server-weights.bin");
+    std::map<std::string, NTensor<float>> w;
+    w.emplace("bias", NTensor<float>({8}, 0.0f, NTensorConfig{48}));   // not 2D: not a target
+    w.emplace("fc1", random_tensor({8, 5}, 1));
+    w.emplace("fc2", random_tensor({5, 3}, 2));
+    save_weights(path, w);
+
+    ServerConfig cfg;
+    cfg.weights_path = path;
+    cfg.threads = 2;
+    cfg.batch.window_us = 20000;         // long enough that concurrent clients share a batch
+    InferenceServer server(cfg);
+    std::remove(path.c_str());
+
+    // LIST: targets in name order with their shapes
+    int fds[2];
+    CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::thread conn([&] { server.handle_client(fds[1]); });
+
+    std::vector<char> out;
+    ResponseHeader res = call(fds[0], Op::LIST, 0, 0, 0, nullptr, out);
+    CHECK(res.status == (uint32_t)Status::OK && res.rows == 2);
+    uint32_t len, dims[2];
+    std::memcpy(&len, out.data(), 4);
+    std::memcpy(dims, out.data() + 4 + len, 8);
+    CHECK(std::string(out.data() + 4, len) == "fc1" && dims[0] == 8 && dims[1] == 5);
+
+    // error statuses keep the connection usable
+    std::vector<float> a = random_floats(2 * 8, 3);
+    res = call(fds[0], Op::MATMUL, 7, 2, 8, a.data(), out);
+    CHECK(res.status == (uint32_t)Status::UNKNOWN_WEIGHT);
+    res = call(fds[0], Op::MATMUL, 1, 2, 8, a.data(), out);       // fc2 is [5 x 3]
+    CHECK(res.status == (uint32_t)Status::SHAPE_MISMATCH);
+
+    res = call(fds[0], Op::MATMUL, 0, 2, 8, a.data(), out);
+    CHECK(res.status == (uint32_t)Status::OK && res.rows == 2 && res.cols == 5);
+    std::vector<double> ref = reference_matmul(a.data(), w.at("fc1").data(), 2, 8, 5);
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); ++i) err = std::max(err, std::fabs(((float*)out.data())[i] - ref[i]));
+    CHECK_NEAR(err, 0.0, 1e-5);
+
+    // an empty MATMUL is refused and the server drops the connection
+    res = call(fds[0], Op::MATMUL, 0, 0, 8, nullptr, out);
+    CHECK(res.status == (uint32_t)Status::BAD_REQUEST);
+    conn.join();
+    ::close(fds[0]);
+
+    // concurrent clients against one weight are coalesced by the batcher
+    const size_t clients = 4;
+    std::vector<std::thread> threads;
+    std::vector<int> client_fds(clients);
+    std::vector<double> errs(clients, 1.0);
+    for (size_t c = 0; c < clients; ++c) {
+        CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        client_fds[c] = fds[0];
+        threads.emplace_back([&, fd = fds[1]] { server.handle_client(fd); });
+    }
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            std::vector<float> x = random_floats((c + 1) * 5, 10 + (unsigned)c);
+            std::vector<char> y;
+            ResponseHeader r = call(client_fds[c], Op::MATMUL, 1, (uint32_t)(c + 1), 5, x.data(), y);
+
+            std::vector<double> want = reference_matmul(x.data(), w.at("fc2").data(), c + 1, 5, 3);
+            double e = r.status == (uint32_t)Status::OK && y.size() == want.size() * sizeof(float) ? 0.0 : 1.0;
+            for (size_t i = 0; e == 0.0 && i < want.size(); ++i) e = std::max(e, std::fabs(((float*)y.data())[i] - want[i]));
+            errs[c] = e;
+            ::close(client_fds[c]);
+        });
+    }
+    for (std::thread& t : threads) t.join();
+
+    for (double e : errs) CHECK_NEAR(e, 0.0, 1e-5);
+    BatcherStats stats = server.batch_stats();
+    CHECK(stats.requests == 1 + clients);
+    CHECK(stats.batches < stats.requests);
+}
+
+int main() {
+    test_weights_round_trip();
+    test_tensor_pool();
+    test_socket_io();
+    test_inference_server();
+    return test_result();
+}
@@ -0,0 +1,71 @@
+#include <shm_tensor.hpp>
+
+#include <test.hpp>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static std::string unique(const std::string& what) {
+    return "/iml-test-" + std::to_string(::getpid()) + "-" + what;
+}
+
+static void test_share() {
+    const std::string name = unique("registry");
+    ShmRegistry reg = ShmRegistry::open(name);
+
+    NTensor<float> W({2, 3}, 0.0f, NTensorConfig{48});
+    for (size_t i = 0; i < W.size(); ++i) W.data()[i] = (float)i;
+
+    {
+        SharedTensor<float> owner = SharedTensor<float>::create_from(reg, "w", W);
+        CHECK(reg.lookup("w").has_value());
+        CHECK_THROWS(SharedTensor<float>::create(reg, "w", {1}), std::runtime_error);
+
+        SharedTensor<float> reader = SharedTensor<float>::attach(reg, "w");
+        CHECK(reader.refcount() == 2);
+        CHECK((reader.shape() == std::vector<size_t>{2, 3}));
+        CHECK(reader.data()[5] == 5.0f);
+        CHECK_THROWS(reader.mutable_data(), std::runtime_error);
+        CHECK(reader.view().index(1, 2) == 5.0f);
+
+        CHECK_THROWS(SharedTensor<double>::attach(reg, "w"), std::runtime_error);
+    }
+
+    // last detach removes the registry entry
+    CHECK(!reg.lookup("w").has_value());
+    CHECK_THROWS(SharedTensor<float>::attach(reg, "w"), std::runtime_error);
+
+    ShmRegistry::destroy(name);
+}
+
+static void test_abandoned_registry() {
+    // a creator that died before ftruncate: the segment exists but is empty
+    const std::string name = unique("abandoned");
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    CHECK(fd >= 0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    CHECK_THROWS(ShmRegistry::open(name, std::chrono::milliseconds(50)), std::runtime_error);
+    CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(2));
+
+    // ...or died after sizing it but before marking it ready
+    CHECK(::ftruncate(fd, 1 << 20) == 0);
+    CHECK_THROWS(ShmRegistry::open(name, std::chrono::milliseconds(50)), std::runtime_error);
+    ::close(fd);
+
+    ShmRegistry::destroy(name);
+    ShmRegistry fresh = ShmRegistry::open(name);
+    CHECK(fresh.list().empty());
+    ShmRegistry::destroy(name);
+}
+
+int main() {
+    test_share();
+    test_abandoned_registry();
+    return test_result();
+}
@@ -0,0 +1,117 @@
+#include <prune.hpp>
+#include <sparse.hpp>
+#include <tensor.hpp>
+#include <thread_pool.hpp>
+
+#include <test.hpp>
+
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+// max |Y - (X * W + bias)| against the dense reference of the pruned W
+static double sparse_error(const std::vector<float>& Y, NTensor<float>& X, NTensor<float>& W,
+                           const std::vector<float>& bias) {
+    const size_t M = X.shape()[0], K = X.shape()[1], N = W.shape()[1];
+    std::vector<double> ref = reference_matmul(X.data(), W.data(), M, K, N);
+
+    double err = 0.0;
+    for (size_t i = 0; i < M; ++i)
+        for (size_t j = 0; j < N; ++j) err = std::max(err, std::fabs(Y[i * N + j] - (ref[i * N + j] + bias[j])));
+    return err;
+}
+
+static void test_formats() {
+    // odd M and N: partial row blocks, column tiles and edge panels
+    const size_t M = 37, K = 64, N = 75;
+    NTensor<float> X = random_tensor({M, K}, 1);
+    std::vector<float> bias = random_floats(N, 2);
+    ThreadPool pool(2);
+
+    NTensor<float> Wc = random_tensor({K, N}, 3), Wn = random_tensor({K, N}, 3), Wb = random_tensor({K, N}, 3);
+    SparseCSR<float> csr = prune_csr(Wc, 0.8);
+    SparseNM<float> nm = prune_nm(Wn);
+    BlockSparse<float> blocks = prune_blocks(Wb, 0.5);
+    CHECK(csr.nnz() == K * N - (size_t)(0.8 * K * N));
+    CHECK(nm.per_col() == K / 2);
+
+    for (ThreadPool* p : {(ThreadPool*)nullptr, &pool}) {
+        std::vector<float> Y(M * N, -1.0f);
+        sparse_matmul(X.data(), K, M, csr, Y.data(), N, bias.data(), Activation::IDENTITY, p);
+        CHECK_NEAR(sparse_error(Y, X, Wc, bias), 0.0, 1e-4);
+
+        sparse_matmul(X.data(), K, M, nm, Y.data(), N, bias.data(), Activation::IDENTITY, p);
+        CHECK_NEAR(sparse_error(Y, X, Wn, bias), 0.0, 1e-4);
+
+        sparse_matmul(X.data(), K, M, blocks, Y.data(), N, bias.data(), Activation::IDENTITY, p);
+        CHECK_NEAR(sparse_error(Y, X, Wb, bias), 0.0, 1e-4);
+    }
+
+    NTensor<float> W = random_tensor({K, N}, 4);
+    CHECK_THROWS(SparseNM<float>::from_dense(W.data(), K, N), std::runtime_error);     // dense, not 2:4
+}
+
+static void test_nested() {
+    // pool tasks that themselves run sparse_matmul on the pool: wait() drains the queue on the
+    // waiting thread, so each call must own its packed input
+    const size_t M = 40, K = 32, N = 48;
+    NTensor<float> W = random_tensor({K, N}, 5);
+    SparseCSR<float> csr = prune_csr(W, 0.5);
+    std::vector<float> bias(N, 0.0f);
+
+    ThreadPool pool(2);
+    std::vector<NTensor<float>> xs;
+    std::vector<std::vector<float>> ys(8, std::vector<float>(M * N));
+    for (unsigned s = 0; s < ys.size(); ++s) xs.push_back(random_tensor(M, K, 10 + s));
+
+    std::vector<std::future<void>> futs;
+    for (size_t s = 0; s < ys.size(); ++s) {
+        futs.push_back(pool.submit([&, s] {
+            sparse_matmul(xs[s].data(), K, M, csr, ys[s].data(), N, (const float*)nullptr, Activation::IDENTITY, &pool);
+        }));
+    }
+    for (auto& f : futs) f.get();
+
+    for (size_t s = 0; s < ys.size(); ++s) CHECK_NEAR(sparse_error(ys[s], xs[s], W, bias), 0.0, 1e-4);
+}
+
+static void test_prune() {
+    NTensor<float> W = random_tensor({8, 8}, 6);
+    W.data()[5] = 1e-6f;
+    PruneConfig cfg;
+    cfg.sparsity = 1.0 / 64;
+    CHECK_NEAR(prune(W, cfg), 1.0 / 64, 0.0);
+    CHECK(W.data()[5] == 0.0f);
+
+    NTensor<float> Wn = random_tensor({8, 8}, 7);
+    cfg.mode = PruneMode::N_M;
+    CHECK_NEAR(prune(Wn, cfg), 0.5, 0.0);
+    for (size_t j = 0; j < 8; ++j) {
+        for (size_t g = 0; g < 8; g += 4) {
+            size_t kept = 0;
+            for (size_t i = 0; i < 4; ++i) kept += Wn.data()[(g + i) * 8 + j] != 0.0f;
+            CHECK(kept == 2);
+        }
+    }
+
+    // N % GEMM_PANEL_N != 0: edge blocks are narrower, sparsity still counts weights
+    NTensor<float> Wb = random_tensor({64, 40}, 8);
+    cfg.mode = PruneMode::BLOCK;
+    cfg.sparsity = 0.6;
+    const double got = prune(Wb, cfg);
+    CHECK(got >= 0.6 && got < 0.6 + 4.0 * GEMM_PANEL_N / (64.0 * 40.0));
+
+    cfg.sparsity = 1.5;
+    CHECK_THROWS(prune(Wb, cfg), std::runtime_error);
+    cfg.mode = PruneMode::N_M;
+    NTensor<float> odd = random_tensor({6, 4}, 9);
+    CHECK_THROWS(prune(odd, cfg), std::runtime_error);
+    CHECK(std::string(prune_mode_name(PruneMode::BLOCK)) == "block");
+}
+
+int main() {
+    test_formats();
+    test_nested();
+    test_prune();
+    return test_result();
+}
@@ -0,0 +1,53 @@
+#include <tensor_parallel.hpp>
+
+#include <ranks.hpp>
+#include <test.hpp>
+
+#include <stdexcept>
+
+static double max_err(const float* got, const double* want, size_t n) {
+    double err = 0.0;
+    for (size_t i = 0; i < n; ++i) err = std::max(err, std::fabs(got[i] - want[i]));
+    return err;
+}
+
+static void test_linear(size_t W) {
+    const size_t M = 9, K = 13, N = 11;
+    NTensor<float> X = random_tensor({M, K}, 1), B1 = random_tensor({K, N}, 2), B2 = random_tensor({N, K}, 3);
+
+    std::vector<double> Y1 = reference_matmul(X.data(), B1.data(), M, K, N);
+    std::vector<float> y1f(Y1.begin(), Y1.end());
+    std::vector<double> Y2 = reference_matmul(y1f.data(), B2.data(), M, N, K);
+
+    ThreadPool pool(1);
+    run_ranks(W, "tp", [&](Transport& tr) {
+        ColumnParallelLinear<float> col(B1, tr, pool);
+        RowParallelLinear<float> row(B2, tr, pool);
+
+        NTensor<float> Y = col.forward(X);
+        CHECK_NEAR(max_err(Y.data(), Y1.data(), M * N), 0.0, 1e-4);
+
+        // column -> row pair with one collective
+        NTensor<float> part = col.forward(X, false);
+        NTensor<float> Z = row.forward(part, true);
+        CHECK_NEAR(max_err(Z.data(), Y2.data(), M * K), 0.0, 1e-3);
+
+        // replicated input, output rows scattered
+        NTensor<float> Zs = row.forward(Y, false, RowCombine::REDUCE_SCATTER);
+        auto [m0, m1] = block_range(M, W, tr.rank());
+        CHECK(Zs.shape()[0] == m1 - m0);
+        CHECK_NEAR(max_err(Zs.data(), Y2.data() + m0 * K, (m1 - m0) * K), 0.0, 1e-3);
+
+        // bad inputs raise instead of reading past the shape
+        NTensor<float> vec({K}, 0.0f, NTensorConfig{48});
+        NTensor<float> wide({M, K + 1}, 0.0f, NTensorConfig{48});
+        CHECK_THROWS(col.forward(vec), std::runtime_error);
+        CHECK_THROWS(col.forward(wide), std::runtime_error);
+        CHECK_THROWS(row.forward(vec), std::runtime_error);
+    });
+}
+
+int main() {
+    for (size_t W : {1, 2, 3}) test_linear(W);
+    return test_result();
+}
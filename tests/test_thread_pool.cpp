@@ -0,0 +1,97 @@
+#include <gemm.hpp>
+#include <thread_pool.hpp>
+
+#include <test.hpp>
+
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+static void test_priority_order() {
+    // one worker held busy, so everything queued behind it is ordered by the pool
+    ThreadPool pool(1);
+    std::promise<void> gate;
+    std::shared_future<void> open = gate.get_future().share();
+    auto blocker = pool.submit([open] { open.wait(); });
+
+    std::mutex m;
+    std::vector<int> order;
+    auto record = [&](int id) { return [&, id] { std::lock_guard<std::mutex> lock(m); order.push_back(id); }; };
+
+    const Clock::time_point now = Clock::now();
+    std::vector<std::future<void>> futs;
+    futs.push_back(pool.submit(record(3), {.priority = Priority::BATCH}));
+    futs.push_back(pool.submit(record(2), {.priority = Priority::NORMAL, .deadline = now + std::chrono::seconds(2)}));
+    futs.push_back(pool.submit(record(1), {.priority = Priority::NORMAL, .deadline = now + std::chrono::seconds(1)}));
+    futs.push_back(pool.submit(record(0), {.priority = Priority::CRITICAL}));
+
+    gate.set_value();
+    blocker.get();
+    for (auto& f : futs) f.get();
+
+    CHECK((order == std::vector<int>{0, 1, 2, 3}));
+    CHECK(pool.stats(Priority::NORMAL).submitted == 3);    // the blocker and two tasks
+}
+
+static void test_parallel_for() {
+    ThreadPool pool(3);
+    std::vector<int> hits(1000, 0);
+    pool.parallel_for(0, hits.size(), 7, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) hits[i]++;
+    });
+
+    bool once = true;
+    for (int h : hits) once = once && h == 1;
+    CHECK(once);
+
+    CHECK_THROWS(pool.parallel_for(0, 100, 10, [](size_t lo, size_t) {
+        if (lo == 50) throw std::runtime_error("chunk");
+    }), std::runtime_error);
+}
+
+static void test_gemm_parallel() {
+    ThreadPool pool(2);
+
+    for (bool trans_a : {false, true}) {
+        for (bool trans_b : {false, true}) {
+            const size_t M = 70, K = 300, N = 260;
+            std::vector<float> A = random_floats(M * K, 1), B = random_floats(K * N, 2);
+
+            // logical operands for the reference
+            std::vector<float> a(M * K), b(K * N);
+            for (size_t i = 0; i < M; ++i)
+                for (size_t k = 0; k < K; ++k) a[i * K + k] = trans_a ? A[k * M + i] : A[i * K + k];
+            for (size_t k = 0; k < K; ++k)
+                for (size_t j = 0; j < N; ++j) b[k * N + j] = trans_b ? B[j * K + k] : B[k * N + j];
+            std::vector<double> ref = reference_matmul(a.data(), b.data(), M, K, N);
+
+            std::vector<float> C(M * N, 1.0f);
+            GemmArgs<float> g;
+            g.trans_a = trans_a; g.trans_b = trans_b;
+            g.M = M; g.N = N; g.K = K;
+            g.A = A.data(); g.lda = trans_a ? M : K;
+            g.B = B.data(); g.ldb = trans_b ? K : N;
+            g.beta = 0.5f;
+            g.C = C.data(); g.ldc = N;
+            gemm_parallel(g, pool, {.priority = Priority::BATCH});
+
+            double err = 0.0;
+            for (size_t i = 0; i < M * N; ++i) err = std::max(err, std::fabs(C[i] - (ref[i] + 0.5)));
+            CHECK_NEAR(err, 0.0, 1e-3);
+        }
+    }
+
+    NTensor<float> A({3, 4}, 1.0f, NTensorConfig{48}), B({4, 5}, 2.0f, NTensorConfig{48});
+    NTensor<float> C = tiled_matmul(A, B, pool);
+    CHECK(C.shape()[0] == 3 && C.shape()[1] == 5);
+    CHECK_NEAR(C.data()[7], 8.0, 0.0);
+    CHECK_THROWS(tiled_matmul(B, B, pool), std::runtime_error);
+}
+
+int main() {
+    test_priority_order();
+    test_parallel_for();
+    test_gemm_parallel();
+    return test_result();
+}
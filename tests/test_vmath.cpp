@@ -0,0 +1,95 @@
+#include <vmath.hpp>
+
+#include <test.hpp>
+
+#include <cmath>
+#include <limits>
+
+typedef void (*ArrayFn)(const float*, float*, size_t);
+
+// worst error of f against the double reference over x, relative where |ref| > 1 and absolute below
+static double max_error(ArrayFn f, double (*ref)(double), const std::vector<float>& x) {
+    std::vector<float> y(x.size());
+    f(x.data(), y.data(), x.size());
+
+    double err = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double r = ref((double)x[i]);
+        err = std::max(err, std::fabs((double)y[i] - r) / std::max(1.0, std::fabs(r)));
+    }
+    return err;
+}
+
+static double sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+static double silu(double x) { return x * sigmoid(x); }
+static double gelu(double x) { return 0.5 * x * (1.0 + std::erf(x / std::sqrt(2.0))); }
+static double exp_ref(double x) { return std::exp(x); }
+static double log_ref(double x) { return std::log(x); }
+static double tanh_ref(double x) { return std::tanh(x); }
+static double erf_ref(double x) { return std::erf(x); }
+
+template<MathAccuracy A>
+static void test_accuracy(double tol) {
+    // an odd count, so the partial tail vector is exercised too
+    std::vector<float> wide = random_floats(10001, 1, -20.0f, 20.0f);
+    std::vector<float> pos = random_floats(10001, 2, 1e-6f, 1e4f);
+    std::vector<float> big = random_floats(10001, 3, -87.0f, 88.0f);
+
+    CHECK_NEAR(max_error(vexp<A>, exp_ref, big), 0.0, tol);
+    CHECK_NEAR(max_error(vlog<A>, log_ref, pos), 0.0, tol);
+    CHECK_NEAR(max_error(vtanh<A>, tanh_ref, wide), 0.0, tol);
+    CHECK_NEAR(max_error(vsigmoid<A>, sigmoid, wide), 0.0, tol);
+    CHECK_NEAR(max_error(vsilu<A>, silu, wide), 0.0, tol);
+    CHECK_NEAR(max_error(verf<A>, erf_ref, wide), 0.0, tol);
+    CHECK_NEAR(max_error(vgelu<A>, gelu, wide), 0.0, tol);
+}
+
+static void test_special_values() {
+    const float inf = std::numeric_limits<float>::infinity(), nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> x = {inf, -inf, nan, -200.0f, 200.0f, 0.0f, -1.0f};
+    std::vector<float> y(x.size());
+
+    vexp(x.data(), y.data(), x.size());
+    CHECK(y[0] == inf && y[1] == 0.0f && std::isnan(y[2]));
+    CHECK(y[3] == 0.0f && y[4] == inf && y[5] == 1.0f);
+
+    vlog(x.data(), y.data(), x.size());
+    CHECK(y[0] == inf && std::isnan(y[1]) && std::isnan(y[2]));
+    CHECK(y[5] == -inf && std::isnan(y[6]));
+
+    vtanh<MathAccuracy::FAST>(x.data(), y.data(), x.size());
+    CHECK(y[0] == 1.0f && y[1] == -1.0f && std::isnan(y[2]));
+
+    // in place
+    vsigmoid(x.data(), x.data(), x.size());
+    CHECK(x[0] == 1.0f && x[1] == 0.0f && x[5] == 0.5f);
+}
+
+static void test_reductions() {
+    // lengths around the vector width exercise the padded tail
+    for (size_t n : {(size_t)1, VMATH_LANES - 1, VMATH_LANES, 3 * VMATH_LANES + 5}) {
+        std::vector<float> x = random_floats(n, (unsigned)n, -4.0f, 3.0f);
+        x[n / 2] = -5.0f;
+
+        double mx = -INFINITY, amax = 0.0;
+        for (float v : x) mx = std::max(mx, (double)v), amax = std::max(amax, std::fabs((double)v));
+        CHECK_NEAR(vreduce_max(x.data(), n), mx, 0.0);
+        CHECK_NEAR(vreduce_absmax(x.data(), n), amax, 0.0);
+
+        double sum = 0.0;
+        for (float v : x) sum += std::exp((double)v - mx);
+        std::vector<float> y(n);
+        CHECK_NEAR(vexp_sum(x.data(), y.data(), n, (float)mx), sum, 1e-5 * sum);
+        CHECK_NEAR(y[n / 2], std::exp(-5.0 - mx), 1e-6);
+        CHECK_NEAR(vexp_sum(x.data(), nullptr, n, (float)mx), sum, 1e-5 * sum);
+    }
+    CHECK(vreduce_max(nullptr, 0) == -INFINITY && vreduce_absmax(nullptr, 0) == 0.0f);
+}
+
+int main() {
+    test_accuracy<MathAccuracy::PRECISE>(1e-6);
+    test_accuracy<MathAccuracy::FAST>(1e-5);
+    test_special_values();
+    test_reductions();
+    return test_result();
+}